@@ -49,6 +49,20 @@ namespace MachEmu
 		NoInterrupt,			/**< No interrupt has occurred. */
 	};
 
+	/** Memory page access
+
+		The access rights the cpu has to a 256 byte page of memory
+		exposed via IController::Memory.
+
+		@see	IController::Memory.
+	*/
+	enum class PageAccess
+	{
+		ReadWrite,				/**< Reads and writes access the page directly. */
+		ReadOnly,				/**< Reads access the page directly, writes are routed through IController::Write. */
+		Trap					/**< Reads and writes are routed through IController::Read and IController::Write. */
+	};
+
 	/** MachuEmu error codes
 	
 		@todo		Convert to ErrorCode to std::error_code
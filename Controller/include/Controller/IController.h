@@ -25,10 +25,60 @@ SOFTWARE.
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include "Base/Base.h"
 
 namespace MachEmu
 {
+	/** Interrupt scheduler
+
+		A timer queue owned by the machine which an io controller can use to
+		schedule its interrupts instead of having them polled.
+
+		@see	IController::Schedule
+
+		@since	version 1.7.0
+	*/
+	struct IScheduler
+	{
+		/** Schedule an interrupt at a cycle count
+
+			@param	cycles		The total number of cpu cycles at which the interrupt is due.
+			@param	isr			The interrupt to service, ISR::NoInterrupt to have the machine
+								call IController::ServiceInterrupts instead.
+
+			@remark				The method must only be called from the emulation thread (from within
+								the methods of the io controller), interrupts which are overdue are
+								serviced when the cpu next stops executing.
+		*/
+		virtual void ScheduleCycles(uint64_t cycles, ISR isr) = 0;
+
+		/** Schedule an interrupt at a time
+
+			@param	time		The time in nanoseconds of the machine clock at which the interrupt is due.
+			@param	isr			The interrupt to service, ISR::NoInterrupt to have the machine
+								call IController::ServiceInterrupts instead.
+
+			@remark				The time is converted to a cycle count using the cpuFrequency option when
+								the interrupt is scheduled.
+
+			@see				ScheduleCycles
+		*/
+		virtual void ScheduleTime(uint64_t time, ISR isr) = 0;
+
+		/** Raise an interrupt
+
+			Have the machine call IController::ServiceInterrupts at the next service of interrupts
+			(every isrFreq clock resolutions).
+
+			@remark				This method is thread safe, it allows a device running on its
+								own thread to raise an interrupt asynchronously.
+		*/
+		virtual void Raise() = 0;
+
+		virtual ~IScheduler() = default;
+	};
+
 	/** Device interface
 
 		An interface to a device that can interact with the cpu.
@@ -99,6 +149,103 @@ namespace MachEmu
 		*/
 		virtual ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) = 0;
 
+		/** Direct memory access
+
+			Exposes the 64K backing store of a memory controller so the cpu can read
+			and write it directly instead of calling Read and Write for every access.
+
+			@param	pageAccess	The access rights for each 256 byte page of the backing store,
+								indexed by the high 8 bits of the address. All pages are set to
+								PageAccess::ReadWrite before this method is called, pages which
+								require Read and/or Write to be called (memory mapped io for example)
+								should be set to PageAccess::ReadOnly or PageAccess::Trap.
+
+			@return				A pointer to the start of the 64K backing store, or nullptr (default)
+								when the controller does not support direct memory access, in which
+								case all accesses are routed through Read and Write.
+
+			@remark				The method is only called on the memory controller when the machine
+								starts running. The returned pointer must remain valid and the page
+								access rights must not change for the duration of the run.
+
+			@since	version 1.7.0
+		*/
+		virtual uint8_t* Memory([[maybe_unused]] std::array<PageAccess, 256>& pageAccess) { return nullptr; }
+
+		/** Rom digest
+
+			A precomputed MD5 digest of the rom, allows a memory controller which already knows
+			its rom digest to spare the machine from reading and hashing the rom.
+
+			@return				The MD5 digest of the rom blocks concatenated in the order given by the
+								rom option, or an empty digest (default) to have the machine compute it.
+
+			@remark				The method is only called on the memory controller when the machine starts
+								running and the rom digest has not been cached. The cached digest is discarded
+								when the memory controller or the rom option changes.
+
+			@since	version 1.7.0
+		*/
+		virtual std::array<uint8_t, 16> RomMd5() const { return {}; }
+
+		/** Next interrupt deadline
+
+			The time at which ServiceInterrupts may next return an interrupt, allows the machine to skip
+			the cycles the cpu would spend halted or spinning in a loop waiting for an interrupt (or polling
+			an io port) instead of executing them.
+
+			@param	currTime	The time in nanoseconds of the machine clock.
+			@param	cycles		The total number of cpu cycles that have elapsed.
+
+			@return				The machine clock time in nanoseconds before which ServiceInterrupts won't return
+								an interrupt and the values read from the io ports won't change,
+								std::numeric_limits<uint64_t>::max() when no interrupt is scheduled, or 0 (default)
+								when the deadline is unknown, in which case no cycles are skipped.
+
+			@remark				The method is only called on the io controller when the cpu is idle. The machine
+								skips to the first call to ServiceInterrupts at or after the deadline, when no
+								interrupt is scheduled it skips to the next call to ServiceInterrupts.
+
+			@since	version 1.7.0
+		*/
+		virtual uint64_t NextInterrupt([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) const { return 0; }
+
+		/** Interrupt scheduling
+
+			Opt in to having the machine only service interrupts when they are due.
+
+			@param	scheduler	The machine interrupt scheduler, it remains valid until the machine is destroyed.
+
+			@return				True when the io controller schedules its interrupts with the scheduler, in which case
+								ServiceInterrupts is only called when a scheduled ISR::NoInterrupt is due or an interrupt
+								was raised, false (default) to have ServiceInterrupts called every isrFreq clock resolutions.
+
+			@remark				The method is only called on the io controller when the machine starts running, any
+								interrupts scheduled from a previous run are discarded beforehand. NextInterrupt is not
+								called on an io controller which schedules its interrupts, an idle cpu skips to the next
+								scheduled interrupt or service of interrupts (whichever comes first).
+
+			@since	version 1.7.0
+		*/
+		virtual bool Schedule([[maybe_unused]] IScheduler* scheduler) { return false; }
+
+		/** Clone the controller
+
+			Create an independent copy of this controller, used by IMachine::Clone.
+
+			@return				A controller with the same state as this one (a memory controller must
+								expose a copy of its memory via Memory), or nullptr (default) when the
+								controller can't be cloned.
+
+			@remark				An io controller which schedules its interrupts is passed the scheduler of the
+								cloned machine via Schedule. Once the call returns, the interrupts in that
+								scheduler are replaced by the interrupts still pending on the machine being
+								cloned.
+
+			@since	version 1.7.0
+		*/
+		virtual std::shared_ptr<IController> Clone() const { return nullptr; }
+
 		/** Destroys the controller
 		
 			Release all resources used by this controller instance.
@@ -24,13 +24,17 @@ SOFTWARE.
 #define _8080_H
 
 #include <array>
-#include <bitset>
+#include <bit>
 #include <cstdint>
+#include <exception>
 #include <memory>
 #include <functional>
 #include <string_view>
+#include <vector>
 
 #include "Base/Base.h"
+#include "Cpu/8080Opcodes.h"
+#include "Cpu/CodeBuffer.h"
 #include "Cpu/ICpu.h"
 #include "SystemBus/SystemBus.h"
 
@@ -41,7 +45,7 @@ namespace MachEmu
 	class Intel8080 final : public ICpu
 	{
 	private:
-		using Register = std::bitset<8>;
+		using Register = uint8_t;
 		static constexpr uint8_t maxRegisters_ = 8;
 		//cppcheck-suppress unusedStructMember
 		static constexpr const char registerName_[maxRegisters_] = {'B', 'C', 'D', 'E', 'H', 'L', 'M', 'A'};
@@ -79,10 +83,10 @@ namespace MachEmu
 		Register h_;
 		//cppcheck-suppress unusedStructMember
 		Register l_;
-		//Helper funtions to prime the address and data buses
-		//for read write operations.
-		void ReadFromAddress(Signal readLocation, uint16_t addr);
-		void WriteToAddress(Signal writeLocation, uint16_t addr, uint8_t value);
+		//Read and write memory directly when the page is mapped, otherwise call
+		//the memory controller.
+		inline uint8_t ReadMemory(uint16_t addr);
+		inline void WriteMemory(uint16_t addr, uint8_t value);
 
 		/**
 			The program counter is a 16 bit register which is accessible to the programmer and whose contents indicate the
@@ -104,13 +108,57 @@ namespace MachEmu
 			8080 to reflect the results of data operations
 
 			S Z 0 AC 0 P 1 C
+
+			The flags are evaluated lazily, the arithmetic and logical instructions only record
+			their result and carry, the remaining flags are materialised via Status() when read.
 		*/
+		//The status flags when they are not being evaluated lazily (POP PSW, Load, Reset),
+		//the carry bit is always clear, see carry_.
 		Register status_ = 0b00000010;
+		//The result of the last arithmetic or logical instruction, the sign, zero and
+		//parity flags are derived from it.
+		Register result_{};
+		//Bit 4 of auxCarry_ ^ result_ is the auxiliary carry flag, for additions
+		//this is the lhs ^ rhs of the last arithmetic instruction.
+		Register auxCarry_{};
+		//The carry flag, unlike the other flags it is always up to date.
+		bool carry_{};
+		//true when the sign, zero, parity and auxiliary carry flags are derived
+		//from result_ and auxCarry_, false when they are held in status_.
+		bool lazyFlags_{};
+
+		//The sign, zero and parity flags for each possible result.
+		static constexpr std::array<uint8_t, 256> szpFlags_ = []
+		{
+			std::array<uint8_t, 256> flags{};
+
+			for (int i = 0; i < 256; i++)
+			{
+				flags[i] = (i & 0x80) | (i == 0 ? 0x40 : 0x00) | ((std::popcount(static_cast<uint8_t>(i)) & 0x01) == 0 ? 0x04 : 0x00);
+			}
+
+			return flags;
+		}();
 
 		//interrupt flip-flip - 1 enabled, 0 disabled
 		//cppcheck-suppress unusedStructMember
 		bool iff_{};
 
+		//The cpu has executed a HLT and idles until an interrupt is acknowledged.
+		bool halted_{};
+		//The cpu is spinning in a loop which only an interrupt can exit, see DetectSpin.
+		bool spinning_{};
+		//A taken jump at most this many bytes backwards is checked for a spin loop.
+		static constexpr uint16_t spinLoopBytes_ = 16;
+		//The target of the last short backwards jump taken, 0x10000 when there is none, along with
+		//the registers, flags and writes at that time.
+		uint32_t spinTarget_ = 0x10000;
+		uint64_t spinRegisters_{};
+		uint16_t spinSp_{};
+		uint64_t spinWrites_{};
+		//The number of memory and io writes, a loop which writes isn't idle.
+		uint64_t writes_{};
+
 		//The opcode for the instruction to be executed.
 		//cppcheck-suppress unusedStructMember
 		uint8_t opcode_{};
@@ -121,11 +169,117 @@ namespace MachEmu
 		std::shared_ptr<DataBus<uint8_t>> dataBus_;
 		std::shared_ptr<ControlBus<8>> controlBus_;
 
-		static uint8_t Value(const Register& r) { return static_cast<uint8_t>(r.to_ulong()); }
-		static uint16_t Uint16(const Register& hi, const Register& low) { return (Value(hi) << 8) | Value(low); }
-		static bool Parity(const Register& r) { return (r.count() & 1) == 0; }
-		static bool Sign(const Register& r) { return r.test(7); }
-		static bool Zero(const Register& r) { return r.none(); }
+		//The memory mapped into the cpu address space via SetMemory,
+		//nullptr when all memory accesses are routed via the system bus.
+		uint8_t* memory_{};
+		//The access rights for each 256 byte page of memory_.
+		std::array<PageAccess, 256> pageAccess_{};
+		//The 256 byte pages of memory written to since the last call to DirtyPages.
+		std::array<bool, 256> dirtyPages_{};
+
+		//A predecoded instruction, the operand is the immediate data or address (little endian)
+		//and the cycles are those taken when a conditional call or return is not taken.
+		struct DecodedOp
+		{
+			uint8_t opcode;
+			uint8_t cycles;
+			uint16_t operand;
+		};
+
+		//A straight line run of instructions ending in a branch, io, halt or interrupt enable
+		//instruction, valid is cleared when a page holding any of its code is written to.
+		struct DecodedBlock
+		{
+			bool valid{};
+			//The sum of the cycles of each instruction.
+			int64_t cycles{};
+			std::vector<DecodedOp> ops;
+			//The number of times the block has been executed from the cache (jit dispatcher only).
+			uint32_t executions{};
+			//The host code which executes the first compiledOps instructions, nullptr when not compiled.
+			int64_t (*code)(Intel8080*){};
+			size_t compiledOps{};
+		};
+
+		//The opcode tables shared with the Recompiler, see 8080Opcodes.h.
+		static constexpr size_t maxBlockOps_ = Opcodes8080::maxBlockOps;
+		static constexpr const auto& opLength_ = Opcodes8080::length;
+		static constexpr const auto& opCycles_ = Opcodes8080::cycles;
+		static constexpr const auto& endsBlock_ = Opcodes8080::endsBlock;
+
+		//The predecoded blocks indexed by start address, only allocated for the cached dispatcher.
+		std::vector<std::unique_ptr<DecodedBlock>> blocks_;
+		//The start address of every block holding code in each 256 byte page.
+		std::array<std::vector<uint16_t>, 256> pageBlocks_{};
+		//true when a page holds predecoded code, checked on every memory write.
+		std::array<bool, 256> codePages_{};
+
+		//The number of times a block is executed from the cache before it is compiled.
+		static constexpr uint32_t hotBlock_ = 16;
+		//The size of the host code buffer, all blocks are flushed when it is full.
+		static constexpr size_t codeBufferSize_ = 4 * 1024 * 1024;
+		//The host code of the compiled blocks, only allocated for the jit dispatcher.
+		std::unique_ptr<CodeBuffer> codeBuffer_;
+		//The block being executed by host code, an exception thrown by an instruction invalidates
+		//it so the host code returns to the dispatcher where the exception is rethrown. Recompiled
+		//blocks return as soon as it is invalidated.
+		DecodedBlock* jitBlock_{};
+		std::exception_ptr jitException_;
+
+		//Decode the block starting at pc, returns false when the code at pc can't be cached.
+		bool DecodeBlock(uint16_t pc, DecodedBlock& block);
+		//Translate the block starting at pc to host code, the register loads and moves, nop
+		//and jmp instructions are translated inline, the remainder call the instruction handlers.
+		void CompileBlock(uint16_t pc, DecodedBlock& block);
+		//The instruction handler called by the host code for each opcode.
+		template <uint8_t opcode>
+		static uint8_t JitOp(Intel8080* cpu, uint16_t operand);
+		//A block translated to C++ ahead of time by the Recompiler, it is only executed when the
+		//memory at pc holds the code it was translated from.
+		struct RecompiledBlock
+		{
+			uint16_t pc;
+			std::vector<uint8_t> code;
+			//The number of instructions executed by run.
+			size_t ops;
+			int64_t (*run)(Intel8080*);
+		};
+
+		//The blocks of every image listed in the recompiledImages build option, sorted by pc.
+		static const std::vector<RecompiledBlock>& RecompiledBlocks();
+		//Execute the first compiledOps instructions of block via a recompiled block
+		//translated from the same code, if there is one.
+		void LinkRecompiledBlock(uint16_t pc, DecodedBlock& block);
+		//Execute a single instruction of a recompiled block, the opcode is a constant
+		//so the switch in ExecuteOpcode folds away.
+		template <uint8_t opcode>
+		[[gnu::always_inline]] inline uint8_t RecompiledOp(uint16_t operand);
+		//Invalidate every block holding code in the given page.
+		void InvalidateBlocks(uint8_t page);
+		//Invalidate every predecoded block.
+		void FlushBlocks();
+
+		static uint16_t Uint16(Register hi, Register low) { return (hi << 8) | low; }
+
+		//Called for each taken jump from the jump instruction at pc to addr. A short loop is spinning
+		//when two consecutive iterations start with the same registers and flags and the loop doesn't
+		//write to memory or io, it ends the dispatch so the machine can skip to the next interrupt.
+		inline void DetectSpin(uint16_t pc, uint16_t addr);
+		//Forget the last jump seen by DetectSpin.
+		void ClearSpin();
+
+		//Materialise the status flags.
+		uint8_t Status() const
+		{
+			if (lazyFlags_ == true)
+			{
+				return szpFlags_[result_] | ((auxCarry_ ^ result_) & 0x10) | 0x02 | carry_;
+			}
+
+			return status_ | carry_;
+		}
+
+		bool Flag(Condition flag) const { return flag == Condition::CarryFlag ? carry_ : ((Status() >> flag) & 0x01) != 0; }
 
 		//Should be implicitly inline
 		inline uint8_t Inr(Register& r);
@@ -133,6 +287,7 @@ namespace MachEmu
 		inline uint8_t Dcr(Register& r);
 		inline uint8_t Dcr(uint16_t addr);
 		inline uint8_t Mvi(Register& reg);
+		inline uint8_t Mvi(Register& reg, uint8_t data);
 		inline uint8_t Mvi();
 		inline uint8_t Daa();
 		inline uint8_t Rlc();
@@ -141,6 +296,8 @@ namespace MachEmu
 		inline uint8_t Rar();
 		inline uint8_t Lxi(Register& regHi, Register& regLow);
 		inline uint8_t Lxi();
+		inline uint8_t Lxi(Register& regHi, Register& regLow, uint16_t data);
+		inline uint8_t Lxi(uint16_t data);
 		inline uint8_t Shld();
 		inline uint8_t Stax(const Register& hi, const Register& low);
 		inline uint8_t Inx(Register& hi, Register& low);
@@ -158,7 +315,7 @@ namespace MachEmu
 		inline uint8_t Cmc();
 		inline uint8_t Mov(Register& lhs, const Register& rhs);
 		inline uint8_t Mov(Register& lhs);
-		inline uint8_t Mov(uint8_t value);
+		inline uint8_t Mov(uint16_t addr, Register value);
 		inline uint8_t Nop();
 		inline uint8_t Hlt();
 		inline Register Add(const Register& lhs, const Register& rhs, uint8_t carry, bool setCarryFlag, [[maybe_unused]] std::string_view instructionName);
@@ -185,9 +342,18 @@ namespace MachEmu
 		inline uint8_t NotImplemented();
 		inline uint8_t RetOnFlag(bool status, std::string_view instructionName);
 		inline uint8_t Pop(Register& hi, Register& low);
+		inline uint8_t Pop();
 		inline uint8_t JmpOnFlag(bool status, std::string_view instructionName);
+		inline uint8_t JmpOnFlag(bool status, uint16_t addr, std::string_view instructionName);
 		inline uint8_t CallOnFlag(bool status, std::string_view instructionName);
+		//Count a taken branch from the instruction at from to the address to, only when coverage is true.
+		inline void CoverEdge(uint16_t from, uint16_t to);
+		//Push a frame for the function at addr entered by the call or rst which has just pushed its return address, only when profiling_ is true.
+		inline void EnterFrame(uint16_t addr);
+		//Pop the frames returned from by the ret about to pop its return address, only when profiling_ is true.
+		inline void LeaveFrame();
 		inline uint8_t Push(const Register& hi, const Register& low);
+		inline uint8_t Push();
 		inline uint8_t Adi(const Register& r);
 		inline uint8_t Rst();
 		inline uint8_t Rst(uint8_t restart);
@@ -200,19 +366,93 @@ namespace MachEmu
 		inline uint8_t Sphl();
 		inline uint8_t Ei();
 		uint8_t Fetch();
-		std::function<void(const SystemBus<uint16_t, uint8_t, 8>&&)> process_;
+		//Always inlined, it is the body of the switch and cached dispatcher loops.
+		template <bool predecoded>
+		[[gnu::always_inline]] inline uint8_t ExecuteOpcode(uint16_t operand = 0);
+		//Execute instructions until the cycle budget has been consumed,
+		//returns the number of cycles taken.
+		template <Dispatcher dispatcher>
+		int64_t Dispatch(int64_t cycleBudget);
+		//The cached, jit and aot dispatchers, the cached dispatcher writes a trace record for each instruction when traced is true.
+		template <Dispatcher dispatcher, bool traced = false>
+		int64_t DispatchBlocks(int64_t cycleBudget);
+		//The Dispatch specialisation selected at construction.
+		int64_t (Intel8080::*dispatch_)(int64_t){};
+		//The dispatcher selected at construction while dispatch_ is its traced counterpart.
+		int64_t (Intel8080::*untracedDispatch_)(int64_t){};
+		//The switch dispatcher with a trace record written for each instruction.
+		int64_t DispatchTraced(int64_t cycleBudget);
+		//ExecuteOpcode wrapped in a trace record.
+		template <bool predecoded>
+		inline uint8_t ExecuteTracedOpcode(uint16_t operand = 0);
+		//Start a trace record of the instruction in opcode_ at pc_ from the registers before it executes.
+		inline TraceRecord& TraceBegin(uint8_t flags);
+		//Complete the trace record with the memory written by the instruction and publish it.
+		inline void TraceEnd(TraceRecord& record);
+		//The destination of the trace records, nullptr when tracing is disabled.
+		TraceBuffer* trace_{};
+		//The machine cycles at the start of the instruction being traced.
+		int64_t traceTicks_{};
+		//The value of writes_ at the start of the instruction being traced.
+		uint64_t traceWrites_{};
+		//The cycle budget of the current Dispatch, instructions which require the
+		//attention of the machine (io, halt) clear it to end the dispatch early.
+		//cppcheck-suppress unusedStructMember
+		int64_t cycleBudget_{};
+		//The controllers called for the memory and io accesses, see SetControllers.
+		IController* memoryController_{};
+		const std::array<IController*, 256>* ioPorts_{};
+		//Only updated when perfCounters is true.
+		CpuCounters counters_{};
+		//The taken branch edge counters, indexed by (from >> 1) ^ to, only allocated when coverage is true.
+		std::array<uint8_t, coverage == true ? coverageEdges : 0> coverage_{};
+		//A function which has been entered, sp is the address of its return address.
+		struct Frame
+		{
+			uint16_t addr;
+			uint16_t sp;
+		};
+		//The deepest call stack tracked, the calls made deeper than this aren't seen by CallStack.
+		static constexpr size_t maxFrames_ = 256;
+		//The functions entered while profiling_ is true, outermost first, the frames which returned
+		//without a ret (their return address has been popped or the stack moved) are found via sp_.
+		std::array<Frame, maxFrames_> frames_{};
+		size_t frameCount_{};
+		bool profiling_{};
+		//The registers (as written by Save) along with the interrupt enable and halt state captured by Snapshot.
+		std::vector<uint8_t> snapshot_;
+		bool snapshotIff_{};
+		bool snapshotHalted_{};
+		//Restore the registers written by Save (without the uuid).
+		void LoadRegisters(std::span<const uint8_t> registers);
 
 	public:
 		/* I8080 overrides */
 		uint8_t Execute() final;
+		int64_t ExecuteFor(int64_t cycleBudget) final;
 		std::unique_ptr<uint8_t[]> GetState(int* size) const final;
 		void Load(const std::string&& json) final;
 		std::string Save() const final;
+		void Save(std::vector<uint8_t>& state) const final;
+		void Load(std::span<const uint8_t> state) final;
 		void Reset(uint16_t programCounter) final;
+		void SetMemory(uint8_t* memory, const std::array<PageAccess, 256>& pageAccess) final;
+		void SetControllers(IController* memoryController, const std::array<IController*, 256>* ioPorts) final;
+		void CopyState(const ICpu& cpu) final;
+		const CpuCounters& Counters() const final;
+		std::array<bool, 256> DirtyPages() final;
+		void Snapshot() final;
+		void Restore(const std::array<bool, 256>& restoredPages) final;
+		std::span<uint8_t> Coverage() final;
+		void SetTrace(TraceBuffer* trace) final;
+		void SetProfiling(bool profiling) final;
+		void CallStack(std::vector<uint16_t>& stack) const final;
+		bool Idle() const final;
+		bool InterruptsEnabled() const final;
 		/* End I8080 overrides */
 
 		Intel8080() = default;
-		Intel8080 (const SystemBus<uint16_t, uint8_t, 8>& systemBus, std::function<void(const SystemBus<uint16_t, uint8_t, 8>&&)> process);
+		Intel8080 (const SystemBus<uint16_t, uint8_t, 8>& systemBus, Dispatcher dispatcher = Dispatcher::Switch);
 		~Intel8080() = default;
 	};
 } // namespace MachEmu
@@ -0,0 +1,417 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _8080_OPCODES_H
+#define _8080_OPCODES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//The properties of each 8080 opcode used to decode basic blocks, shared by the
+//cached dispatchers and the Recompiler so they agree on the boundaries of a block.
+namespace MachEmu::Opcodes8080
+{
+	//The maximum number of instructions in a predecoded block.
+	inline constexpr size_t maxBlockOps = 64;
+	//The length in bytes of each instruction.
+	inline constexpr std::array<uint8_t, 256> length = []
+	{
+		std::array<uint8_t, 256> length{};
+		length.fill(1);
+
+		for (auto op : { 0x01, 0x11, 0x21, 0x31, 0x22, 0x2A, 0x32, 0x3A,
+			0xC2, 0xC3, 0xC4, 0xCA, 0xCC, 0xCD, 0xD2, 0xD4, 0xDA, 0xDC,
+			0xE2, 0xE4, 0xEA, 0xEC, 0xF2, 0xF4, 0xFA, 0xFC })
+		{
+			length[op] = 3;
+		}
+
+		for (int op = 0x06; op < 0x40; op += 0x08)
+		{
+			length[op] = 2;
+		}
+
+		for (int op = 0xC6; op <= 0xFE; op += 0x08)
+		{
+			length[op] = 2;
+		}
+
+		length[0xD3] = 2;
+		length[0xDB] = 2;
+		return length;
+	}();
+	//The cycles taken by each instruction, conditional calls and returns are not taken. They match the
+	//ticks returned by the handlers: mov r, r with the same register is executed as a nop and the
+	//undocumented opcodes (NotImplemented) take no cycles.
+	inline constexpr std::array<uint8_t, 256> cycles = []
+	{
+		std::array<uint8_t, 256> cycles
+		{
+			4, 10, 7, 5, 5, 5, 7, 4, 4, 10, 7, 5, 5, 5, 7, 4,
+			4, 10, 7, 5, 5, 5, 7, 4, 4, 10, 7, 5, 5, 5, 7, 4,
+			4, 10, 16, 5, 5, 5, 7, 4, 4, 10, 16, 5, 5, 5, 7, 4,
+			4, 10, 13, 5, 10, 10, 10, 4, 4, 10, 13, 5, 5, 5, 7, 4
+		};
+
+		for (int op = 0x40; op < 0x80; op++)
+		{
+			cycles[op] = (op & 0x07) == 0x06 || (op & 0x38) == 0x30 ? 7 : ((op >> 3) & 0x07) == (op & 0x07) ? 4 : 5;
+		}
+
+		for (int op = 0x80; op < 0xC0; op++)
+		{
+			cycles[op] = (op & 0x07) == 0x06 ? 7 : 4;
+		}
+
+		constexpr std::array<uint8_t, 64> high
+		{
+			5, 10, 10, 10, 11, 11, 7, 11, 5, 10, 10, 10, 11, 17, 7, 11,
+			5, 10, 10, 10, 11, 11, 7, 11, 5, 10, 10, 10, 11, 17, 7, 11,
+			5, 10, 10, 18, 11, 11, 7, 11, 5, 5, 10, 4, 11, 17, 7, 11,
+			5, 10, 10, 4, 11, 11, 7, 11, 5, 5, 10, 4, 11, 17, 7, 11
+		};
+
+		for (int op = 0xC0; op < 0x100; op++)
+		{
+			cycles[op] = high[op - 0xC0];
+		}
+
+		for (auto op : { 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38, 0xCB, 0xD9, 0xDD, 0xED, 0xFD })
+		{
+			cycles[op] = 0;
+		}
+
+		return cycles;
+	}();
+	//true for the instructions which end a predecoded block: jumps, calls, returns, restarts,
+	//io, halt, interrupt enable/disable and the undocumented opcodes.
+	inline constexpr std::array<bool, 256> endsBlock = []
+	{
+		std::array<bool, 256> ends{};
+
+		for (int op = 0xC0; op < 0x100; op++)
+		{
+			auto low = op & 0x07;
+			ends[op] = low == 0x00 || low == 0x02 || low == 0x04 || low == 0x07;
+		}
+
+		for (auto op : { 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38, 0x76,
+			0xC3, 0xC9, 0xCB, 0xCD, 0xD3, 0xD9, 0xDB, 0xDD, 0xE9, 0xED, 0xF3, 0xFB, 0xFD })
+		{
+			ends[op] = true;
+		}
+
+		return ends;
+	}();
+	//true for the instructions which write to memory: the stores, the read-modify-write
+	//instructions which address M, pushes, calls, restarts and xthl.
+	inline constexpr std::array<bool, 256> writesMemory = []
+	{
+		std::array<bool, 256> writes{};
+
+		for (int op = 0x70; op < 0x78; op++)
+		{
+			writes[op] = op != 0x76;
+		}
+
+		for (int op = 0xC0; op < 0x100; op++)
+		{
+			auto low = op & 0x07;
+			writes[op] = low == 0x04 || low == 0x07;
+		}
+
+		for (auto op : { 0x02, 0x12, 0x22, 0x32, 0x34, 0x35, 0x36,
+			0xC5, 0xCD, 0xD5, 0xE3, 0xE5, 0xF5 })
+		{
+			writes[op] = true;
+		}
+
+		return writes;
+	}();
+} // namespace MachEmu::Opcodes8080
+
+//The instruction executed by each opcode, the single definition expanded by each of the Intel8080
+//dispatchers. OP(opcode, instruction) is expanded for each opcode in ascending order, opcode is its
+//two hex digits and instruction is an Intel8080 member expression which executes it and evaluates to
+//the number of cycles taken. The lxi, mvi and jump instructions are wrapped in
+//OPERAND(withOperand, withoutOperand), withOperand takes the predecoded immediate data or address
+//from operand and withoutOperand reads it from memory.
+#define OPCODES_8080(OP, OPERAND) \
+	OP(00, Nop()) \
+	OP(01, OPERAND(Lxi(b_, c_, operand), Lxi(b_, c_))) \
+	OP(02, Stax(b_, c_)) \
+	OP(03, Inx(b_, c_)) \
+	OP(04, Inr(b_)) \
+	OP(05, Dcr(b_)) \
+	OP(06, OPERAND(Mvi(b_, static_cast<uint8_t>(operand)), Mvi(b_))) \
+	OP(07, Rlc()) \
+	OP(08, NotImplemented()) \
+	OP(09, Dad(b_, c_)) \
+	OP(0A, Ldax(b_, c_)) \
+	OP(0B, Dcx(b_, c_)) \
+	OP(0C, Inr(c_)) \
+	OP(0D, Dcr(c_)) \
+	OP(0E, OPERAND(Mvi(c_, static_cast<uint8_t>(operand)), Mvi(c_))) \
+	OP(0F, Rrc()) \
+	OP(10, NotImplemented()) \
+	OP(11, OPERAND(Lxi(d_, e_, operand), Lxi(d_, e_))) \
+	OP(12, Stax(d_, e_)) \
+	OP(13, Inx(d_, e_)) \
+	OP(14, Inr(d_)) \
+	OP(15, Dcr(d_)) \
+	OP(16, OPERAND(Mvi(d_, static_cast<uint8_t>(operand)), Mvi(d_))) \
+	OP(17, Ral()) \
+	OP(18, NotImplemented()) \
+	OP(19, Dad(d_, e_)) \
+	OP(1A, Ldax(d_, e_)) \
+	OP(1B, Dcx(d_, e_)) \
+	OP(1C, Inr(e_)) \
+	OP(1D, Dcr(e_)) \
+	OP(1E, OPERAND(Mvi(e_, static_cast<uint8_t>(operand)), Mvi(e_))) \
+	OP(1F, Rar()) \
+	OP(20, NotImplemented()) \
+	OP(21, OPERAND(Lxi(h_, l_, operand), Lxi(h_, l_))) \
+	OP(22, Shld()) \
+	OP(23, Inx(h_, l_)) \
+	OP(24, Inr(h_)) \
+	OP(25, Dcr(h_)) \
+	OP(26, OPERAND(Mvi(h_, static_cast<uint8_t>(operand)), Mvi(h_))) \
+	OP(27, Daa()) \
+	OP(28, NotImplemented()) \
+	OP(29, Dad(h_, l_)) \
+	OP(2A, Lhld()) \
+	OP(2B, Dcx(h_, l_)) \
+	OP(2C, Inr(l_)) \
+	OP(2D, Dcr(l_)) \
+	OP(2E, OPERAND(Mvi(l_, static_cast<uint8_t>(operand)), Mvi(l_))) \
+	OP(2F, Cma()) \
+	OP(30, NotImplemented()) \
+	OP(31, OPERAND(Lxi(operand), Lxi())) \
+	OP(32, Sta()) \
+	OP(33, Inx()) \
+	OP(34, Inr()) \
+	OP(35, Dcr(Uint16(h_, l_))) \
+	OP(36, Mvi()) \
+	OP(37, Stc()) \
+	OP(38, NotImplemented()) \
+	OP(39, Dad()) \
+	OP(3A, Lda()) \
+	OP(3B, Dcx()) \
+	OP(3C, Inr(a_)) \
+	OP(3D, Dcr(a_)) \
+	OP(3E, OPERAND(Mvi(a_, static_cast<uint8_t>(operand)), Mvi(a_))) \
+	OP(3F, Cmc()) \
+	OP(40, Nop()) \
+	OP(41, Mov(b_, c_)) \
+	OP(42, Mov(b_, d_)) \
+	OP(43, Mov(b_, e_)) \
+	OP(44, Mov(b_, h_)) \
+	OP(45, Mov(b_, l_)) \
+	OP(46, Mov(b_)) \
+	OP(47, Mov(b_, a_)) \
+	OP(48, Mov(c_, b_)) \
+	OP(49, Nop()) \
+	OP(4A, Mov(c_, d_)) \
+	OP(4B, Mov(c_, e_)) \
+	OP(4C, Mov(c_, h_)) \
+	OP(4D, Mov(c_, l_)) \
+	OP(4E, Mov(c_)) \
+	OP(4F, Mov(c_, a_)) \
+	OP(50, Mov(d_, b_)) \
+	OP(51, Mov(d_, c_)) \
+	OP(52, Nop()) \
+	OP(53, Mov(d_, e_)) \
+	OP(54, Mov(d_, h_)) \
+	OP(55, Mov(d_, l_)) \
+	OP(56, Mov(d_)) \
+	OP(57, Mov(d_, a_)) \
+	OP(58, Mov(e_, b_)) \
+	OP(59, Mov(e_, c_)) \
+	OP(5A, Mov(e_, d_)) \
+	OP(5B, Nop()) \
+	OP(5C, Mov(e_, h_)) \
+	OP(5D, Mov(e_, l_)) \
+	OP(5E, Mov(e_)) \
+	OP(5F, Mov(e_, a_)) \
+	OP(60, Mov(h_, b_)) \
+	OP(61, Mov(h_, c_)) \
+	OP(62, Mov(h_, d_)) \
+	OP(63, Mov(h_, e_)) \
+	OP(64, Nop()) \
+	OP(65, Mov(h_, l_)) \
+	OP(66, Mov(h_)) \
+	OP(67, Mov(h_, a_)) \
+	OP(68, Mov(l_, b_)) \
+	OP(69, Mov(l_, c_)) \
+	OP(6A, Mov(l_, d_)) \
+	OP(6B, Mov(l_, e_)) \
+	OP(6C, Mov(l_, h_)) \
+	OP(6D, Nop()) \
+	OP(6E, Mov(l_)) \
+	OP(6F, Mov(l_, a_)) \
+	OP(70, Mov(Uint16(h_, l_), b_)) \
+	OP(71, Mov(Uint16(h_, l_), c_)) \
+	OP(72, Mov(Uint16(h_, l_), d_)) \
+	OP(73, Mov(Uint16(h_, l_), e_)) \
+	OP(74, Mov(Uint16(h_, l_), h_)) \
+	OP(75, Mov(Uint16(h_, l_), l_)) \
+	OP(76, Hlt()) \
+	OP(77, Mov(Uint16(h_, l_), a_)) \
+	OP(78, Mov(a_, b_)) \
+	OP(79, Mov(a_, c_)) \
+	OP(7A, Mov(a_, d_)) \
+	OP(7B, Mov(a_, e_)) \
+	OP(7C, Mov(a_, h_)) \
+	OP(7D, Mov(a_, l_)) \
+	OP(7E, Mov(a_)) \
+	OP(7F, Nop()) \
+	OP(80, Add(b_, "ADD")) \
+	OP(81, Add(c_, "ADD")) \
+	OP(82, Add(d_, "ADD")) \
+	OP(83, Add(e_, "ADD")) \
+	OP(84, Add(h_, "ADD")) \
+	OP(85, Add(l_, "ADD")) \
+	OP(86, Add(Uint16(h_, l_), "ADD")) \
+	OP(87, Add(a_, "ADD")) \
+	OP(88, Adc(b_, "ADC")) \
+	OP(89, Adc(c_, "ADC")) \
+	OP(8A, Adc(d_, "ADC")) \
+	OP(8B, Adc(e_, "ADC")) \
+	OP(8C, Adc(h_, "ADC")) \
+	OP(8D, Adc(l_, "ADC")) \
+	OP(8E, Adc(Uint16(h_, l_), "ADC")) \
+	OP(8F, Adc(a_, "ADC")) \
+	OP(90, Sub(b_, "SUB")) \
+	OP(91, Sub(c_, "SUB")) \
+	OP(92, Sub(d_, "SUB")) \
+	OP(93, Sub(e_, "SUB")) \
+	OP(94, Sub(h_, "SUB")) \
+	OP(95, Sub(l_, "SUB")) \
+	OP(96, Sub(Uint16(h_, l_), "SUB")) \
+	OP(97, Sub(a_, "SUB")) \
+	OP(98, Sbb(b_, "SBB")) \
+	OP(99, Sbb(c_, "SBB")) \
+	OP(9A, Sbb(d_, "SBB")) \
+	OP(9B, Sbb(e_, "SBB")) \
+	OP(9C, Sbb(h_, "SBB")) \
+	OP(9D, Sbb(l_, "SBB")) \
+	OP(9E, Sbb(Uint16(h_, l_), "SBB")) \
+	OP(9F, Sbb(a_, "SBB")) \
+	OP(A0, Ana(b_, "ANA")) \
+	OP(A1, Ana(c_, "ANA")) \
+	OP(A2, Ana(d_, "ANA")) \
+	OP(A3, Ana(e_, "ANA")) \
+	OP(A4, Ana(h_, "ANA")) \
+	OP(A5, Ana(l_, "ANA")) \
+	OP(A6, Ana(Uint16(h_, l_), "ANA")) \
+	OP(A7, Ana(a_, "ANA")) \
+	OP(A8, Xra(b_, "XRA")) \
+	OP(A9, Xra(c_, "XRA")) \
+	OP(AA, Xra(d_, "XRA")) \
+	OP(AB, Xra(e_, "XRA")) \
+	OP(AC, Xra(h_, "XRA")) \
+	OP(AD, Xra(l_, "XRA")) \
+	OP(AE, Xra(Uint16(h_, l_), "XRA")) \
+	OP(AF, Xra(a_, "XRA")) \
+	OP(B0, Ora(b_, "ORA")) \
+	OP(B1, Ora(c_, "ORA")) \
+	OP(B2, Ora(d_, "ORA")) \
+	OP(B3, Ora(e_, "ORA")) \
+	OP(B4, Ora(h_, "ORA")) \
+	OP(B5, Ora(l_, "ORA")) \
+	OP(B6, Ora(Uint16(h_, l_), "ORA")) \
+	OP(B7, Ora(a_, "ORA")) \
+	OP(B8, Cmp(b_, "CMP")) \
+	OP(B9, Cmp(c_, "CMP")) \
+	OP(BA, Cmp(d_, "CMP")) \
+	OP(BB, Cmp(e_, "CMP")) \
+	OP(BC, Cmp(h_, "CMP")) \
+	OP(BD, Cmp(l_, "CMP")) \
+	OP(BE, Cmp(Uint16(h_, l_), "CMP")) \
+	OP(BF, Cmp(a_, "CMP")) \
+	OP(C0, RetOnFlag(Flag(Condition::ZeroFlag) == false, "RNZ")) \
+	OP(C1, Pop(b_, c_)) \
+	OP(C2, OPERAND(JmpOnFlag(Flag(Condition::ZeroFlag) == false, operand, "JNZ"), JmpOnFlag(Flag(Condition::ZeroFlag) == false, "JNZ"))) \
+	OP(C3, OPERAND(JmpOnFlag(true, operand, "JMP"), JmpOnFlag(true, "JMP"))) \
+	OP(C4, CallOnFlag(Flag(Condition::ZeroFlag) == false, "CNZ")) \
+	OP(C5, Push(b_, c_)) \
+	OP(C6, Add(++pc_, "ADI")) \
+	OP(C7, Rst()) \
+	OP(C8, RetOnFlag(Flag(Condition::ZeroFlag) == true, "RZ")) \
+	OP(C9, RetOnFlag(true, "RET")) \
+	OP(CA, OPERAND(JmpOnFlag(Flag(Condition::ZeroFlag) == true, operand, "JZ"), JmpOnFlag(Flag(Condition::ZeroFlag) == true, "JZ"))) \
+	OP(CB, NotImplemented()) \
+	OP(CC, CallOnFlag(Flag(Condition::ZeroFlag) == true, "CZ")) \
+	OP(CD, CallOnFlag(true, "CALL")) \
+	OP(CE, Adc(++pc_, "ACI")) \
+	OP(CF, Rst()) \
+	OP(D0, RetOnFlag(Flag(Condition::CarryFlag) == false, "RNC")) \
+	OP(D1, Pop(d_, e_)) \
+	OP(D2, OPERAND(JmpOnFlag(Flag(Condition::CarryFlag) == false, operand, "JNC"), JmpOnFlag(Flag(Condition::CarryFlag) == false, "JNC"))) \
+	OP(D3, Out()) \
+	OP(D4, CallOnFlag(Flag(Condition::CarryFlag) == false, "CNC")) \
+	OP(D5, Push(d_, e_)) \
+	OP(D6, Sub(++pc_, "SUI")) \
+	OP(D7, Rst()) \
+	OP(D8, RetOnFlag(Flag(Condition::CarryFlag) == true, "RC")) \
+	OP(D9, NotImplemented()) \
+	OP(DA, OPERAND(JmpOnFlag(Flag(Condition::CarryFlag) == true, operand, "JC"), JmpOnFlag(Flag(Condition::CarryFlag) == true, "JC"))) \
+	OP(DB, In()) \
+	OP(DC, CallOnFlag(Flag(Condition::CarryFlag) == true, "CC")) \
+	OP(DD, NotImplemented()) \
+	OP(DE, Sbb(++pc_, "SBI")) \
+	OP(DF, Rst()) \
+	OP(E0, RetOnFlag(Flag(Condition::ParityFlag) == false, "RPO")) \
+	OP(E1, Pop(h_, l_)) \
+	OP(E2, OPERAND(JmpOnFlag(Flag(Condition::ParityFlag) == false, operand, "JPO"), JmpOnFlag(Flag(Condition::ParityFlag) == false, "JPO"))) \
+	OP(E3, Xthl()) \
+	OP(E4, CallOnFlag(Flag(Condition::ParityFlag) == false, "CPO")) \
+	OP(E5, Push(h_, l_)) \
+	OP(E6, Ana(++pc_, "ANI")) \
+	OP(E7, Rst()) \
+	OP(E8, RetOnFlag(Flag(Condition::ParityFlag) == true, "RPE")) \
+	OP(E9, Pchl()) \
+	OP(EA, OPERAND(JmpOnFlag(Flag(Condition::ParityFlag) == true, operand, "JPE"), JmpOnFlag(Flag(Condition::ParityFlag) == true, "JPE"))) \
+	OP(EB, Xchg()) \
+	OP(EC, CallOnFlag(Flag(Condition::ParityFlag) == true, "CPE")) \
+	OP(ED, NotImplemented()) \
+	OP(EE, Xra(++pc_, "XRI")) \
+	OP(EF, Rst()) \
+	OP(F0, RetOnFlag(Flag(Condition::SignFlag) == false, "RP")) \
+	OP(F1, Pop()) \
+	OP(F2, OPERAND(JmpOnFlag(Flag(Condition::SignFlag) == false, operand, "JP"), JmpOnFlag(Flag(Condition::SignFlag) == false, "JP"))) \
+	OP(F3, Di()) \
+	OP(F4, CallOnFlag(Flag(Condition::SignFlag) == false, "CP")) \
+	OP(F5, Push()) \
+	OP(F6, Ora(++pc_, "ORI")) \
+	OP(F7, Rst()) \
+	OP(F8, RetOnFlag(Flag(Condition::SignFlag) == true, "RM")) \
+	OP(F9, Sphl()) \
+	OP(FA, OPERAND(JmpOnFlag(Flag(Condition::SignFlag) == true, operand, "JM"), JmpOnFlag(Flag(Condition::SignFlag) == true, "JM"))) \
+	OP(FB, Ei()) \
+	OP(FC, CallOnFlag(Flag(Condition::SignFlag) == true, "CM")) \
+	OP(FD, NotImplemented()) \
+	OP(FE, Cmp(++pc_, "CPI")) \
+	OP(FF, Rst())
+
+#endif // _8080_OPCODES_H
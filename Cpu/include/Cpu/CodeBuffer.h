@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef CODEBUFFER_H
+#define CODEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace MachEmu
+{
+	//Host code generation is only supported on x86-64.
+#if defined(__x86_64__) || defined(_M_X64)
+	inline constexpr bool jitSupported = true;
+#else
+	inline constexpr bool jitSupported = false;
+#endif
+
+	//A fixed size region of executable memory which host code is emitted into
+	//sequentially, the code is discarded all at once via Reset.
+	class CodeBuffer final
+	{
+	private:
+		uint8_t* data_{};
+		size_t size_{};
+		size_t pos_{};
+
+	public:
+		/** Allocate the executable memory
+
+			@param	size	The size of the buffer in bytes.
+
+			@remark			Valid returns false when executable memory can't be allocated.
+		*/
+		explicit CodeBuffer(size_t size);
+		CodeBuffer(const CodeBuffer&) = delete;
+		CodeBuffer& operator=(const CodeBuffer&) = delete;
+		~CodeBuffer();
+
+		//true when the executable memory was allocated.
+		bool Valid() const { return data_ != nullptr; }
+		//The number of bytes which can still be emitted.
+		size_t Remaining() const { return size_ - pos_; }
+		//The address the next byte will be emitted to.
+		uint8_t* Position() const { return data_ + pos_; }
+		//Discard all the emitted code.
+		void Reset() { pos_ = 0; }
+
+		void Emit(std::initializer_list<uint8_t> bytes);
+		void Emit32(uint32_t value);
+		void Emit64(uint64_t value);
+		//Overwrite a previously emitted 32 bit value.
+		static void Patch32(uint8_t* at, uint32_t value);
+	};
+} // namespace MachEmu
+
+#endif // CODEBUFFER_H
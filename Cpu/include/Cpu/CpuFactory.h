@@ -24,7 +24,6 @@ SOFTWARE.
 #define CPU_FACTORY_H
 
 #include <cstdint>
-#include <functional>
 #include <memory>
 
 #include "Cpu/ICpu.h"
@@ -32,7 +31,7 @@ SOFTWARE.
 
 namespace MachEmu
 {
-	std::unique_ptr<ICpu> Make8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, std::function<void(const SystemBus<uint16_t, uint8_t, 8>&&)>&& process);
+	std::unique_ptr<ICpu> Make8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, Dispatcher dispatcher = Dispatcher::Switch);
 } // namespace MachEmu
 
 #endif // CPU_FACTORY_H
\ No newline at end of file
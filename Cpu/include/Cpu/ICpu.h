@@ -23,17 +23,69 @@ SOFTWARE.
 #ifndef ICPU_H
 #define ICPU_H
 
+#include <array>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
+
+#include "Base/Base.h"
+#include "Controller/IController.h"
+#include "Cpu/TraceBuffer.h"
 
 namespace MachEmu
 {
+	//The method used to decode and execute instructions
+	enum class Dispatcher
+	{
+		Switch,		//Portable, decode via a switch statement
+		Threaded,	//Direct threaded code via labels as values, falls back to Switch when the compiler has no support
+		Cached,		//Predecoded basic blocks keyed by start address, invalidated when their code is written to
+		Jit,		//Cached, hot blocks are translated to host code, falls back to Cached when the host is not x86-64
+		Aot			//Cached, blocks translated to C++ ahead of time by the Recompiler are executed as native code
+	};
+
+#ifdef ENABLE_PERF_COUNTERS
+	inline constexpr bool perfCounters = true;
+#else
+	//Performance counters are compiled out unless ENABLE_PERF_COUNTERS is defined
+	inline constexpr bool perfCounters = false;
+#endif
+
+#ifdef ENABLE_COVERAGE
+	inline constexpr bool coverage = true;
+#else
+	//Branch coverage is compiled out unless ENABLE_COVERAGE is defined
+	inline constexpr bool coverage = false;
+#endif
+
+	//The number of 8 bit saturating counters in the branch coverage bitmap, one per hashed edge
+	inline constexpr size_t coverageEdges = 65536;
+
+	//Cpu performance counters, only maintained when perfCounters is true
+	struct CpuCounters
+	{
+		std::array<uint64_t, 256> instructions{};	//The number of times each opcode was executed
+		std::array<uint64_t, 256> cycles{};			//The total cycles spent executing each opcode
+		uint64_t memoryReads{};						//Including instruction fetches
+		uint64_t memoryWrites{};
+		std::array<uint64_t, 256> ioReads{};		//The number of reads from each io port
+		std::array<uint64_t, 256> ioWrites{};		//The number of writes to each io port
+		uint64_t compiledBlocks{};					//The number of blocks executed as native code by the jit and aot dispatchers
+	};
+
 	struct ICpu
 	{
 		//Executes the next instruction
 		virtual uint8_t Execute() = 0;
 
+		//Executes instructions until the cycle budget has been consumed or the machine needs to
+		//intervene (io access or halt), returns the number of cycles executed (at least one instruction),
+		//a halted cpu executes no instructions and returns the budget (at least one idle machine cycle),
+		//throws std::runtime_error when SetControllers has not been called
+		virtual int64_t ExecuteFor(int64_t cycleBudget) = 0;
+
 		virtual void Reset(uint16_t pc) = 0;
 
 		virtual std::unique_ptr<uint8_t[]> GetState(int* size) const = 0;
@@ -42,6 +94,56 @@ namespace MachEmu
 		
 		virtual std::string Save() const = 0;
 
+		//Append the binary state of the cpu to state: the cpu uuid (16 bytes) followed by the GetState registers
+		virtual void Save(std::vector<uint8_t>& state) const = 0;
+
+		//Load the binary state written by Save, the state must match in size
+		virtual void Load(std::span<const uint8_t> state) = 0;
+
+		//Map memory into the cpu address space, a nullptr memory routes all memory accesses via the memory controller
+		virtual void SetMemory(uint8_t* memory, const std::array<PageAccess, 256>& pageAccess) = 0;
+
+		//Wire the memory controller and the io port dispatch table (the controller which owns each port) into the cpu,
+		//the accesses which can't be made directly to memory call the controllers. Must be called before executing.
+		virtual void SetControllers(IController* memoryController, const std::array<IController*, 256>* ioPorts) = 0;
+
+		//Copy the registers along with the interrupt enable and halt state of a cpu of the same type
+		virtual void CopyState(const ICpu& cpu) = 0;
+
+		//The performance counters accumulated since the last Reset, always zero when perfCounters is false
+		virtual const CpuCounters& Counters() const = 0;
+
+		//Returns the 256 byte memory pages written to since the last call (or Reset) and marks them all as clean
+		virtual std::array<bool, 256> DirtyPages() = 0;
+
+		//Capture the registers along with the interrupt enable and halt state for Restore
+		virtual void Snapshot() = 0;
+
+		//Rewind the registers, interrupt enable and halt state to the last Snapshot, the given memory pages
+		//have been restored behind the cpu's back and any code predecoded from them is discarded
+		virtual void Restore(const std::array<bool, 256>& restoredPages) = 0;
+
+		//The taken branch edge counters accumulated since the last Reset, the caller may clear them, empty when coverage is false
+		virtual std::span<uint8_t> Coverage() = 0;
+
+		//Write a record of each instruction executed (and interrupt acknowledged) to trace, nullptr disables tracing.
+		//Tracing executes one instruction at a time via the switch dispatcher, the configured dispatcher resumes when disabled.
+		virtual void SetTrace(TraceBuffer* trace) = 0;
+
+		//Track the functions entered by call, rst and interrupts and left by ret, false stops tracking and forgets them.
+		virtual void SetProfiling(bool profiling) = 0;
+
+		//The entry points of the functions entered which have not returned (outermost first) followed by the
+		//address of the next instruction, stack holds the pc only when profiling is false.
+		virtual void CallStack(std::vector<uint16_t>& stack) const = 0;
+
+		//true when the last ExecuteFor left the cpu halted or spinning in a loop which only an interrupt
+		//(or a change of io input) can exit, the machine may skip the cycles up to the next interrupt
+		virtual bool Idle() const = 0;
+
+		//true when the cpu accepts interrupts, the interrupts it doesn't accept are discarded
+		virtual bool InterruptsEnabled() const = 0;
+
 		virtual ~ICpu() = default;
 	};
 } // namespace MachEmu
@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TRACEBUFFER_H
+#define TRACEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace MachEmu
+{
+	//A traced instruction, written by the cpu as it executes and read back by the TraceDecoder
+	//from the binary trace file, the fields are in host byte order.
+	struct TraceRecord
+	{
+		//Set in flags when the instruction is the restart of an acknowledged interrupt rather than a fetched opcode.
+		static constexpr uint8_t interrupt = 0x01;
+		//Set in flags when the operand and the values written are not known, the memory isn't directly mapped.
+		static constexpr uint8_t unmapped = 0x02;
+
+		//The total machine cycles when the instruction started.
+		uint64_t cycles;
+		//The registers before the instruction was executed.
+		uint16_t pc;
+		uint16_t sp;
+		uint8_t opcode;
+		uint8_t flags;
+		//The two bytes following the opcode, only meaningful for multi byte instructions.
+		uint8_t operand[2];
+		uint8_t a;
+		uint8_t b;
+		uint8_t c;
+		uint8_t d;
+		uint8_t e;
+		uint8_t h;
+		uint8_t l;
+		uint8_t status;
+		//The memory written by the instruction, writes is 0, 1 or 2.
+		uint8_t writes;
+		uint8_t values[2];
+		uint8_t reserved;
+		uint16_t addresses[2];
+	};
+
+	static_assert(sizeof(TraceRecord) == 32, "The trace file format requires 32 byte records");
+
+	//A single producer (the cpu) single consumer (the machine trace thread) lock-free ring of trace records.
+	class TraceBuffer final
+	{
+	private:
+		//The number of records, a power of two.
+		static constexpr uint64_t capacity_ = 1 << 16;
+		std::unique_ptr<TraceRecord[]> records_ = std::make_unique<TraceRecord[]>(capacity_);
+		//The machine cycles at the start of the current cpu ExecuteFor.
+		const int64_t& totalTicks_;
+		//The next record to be written, only stored by the producer.
+		alignas(64) std::atomic<uint64_t> head_{};
+		//The next record to be read, only stored by the consumer.
+		alignas(64) std::atomic<uint64_t> tail_{};
+		//The producer's copy of tail_ + capacity_, the ring is only reloaded when it appears full.
+		alignas(64) uint64_t limit_{ capacity_ };
+
+	public:
+		explicit TraceBuffer(const int64_t& totalTicks) : totalTicks_(totalTicks) {}
+
+		int64_t TotalTicks() const { return totalTicks_; }
+
+		//Producer, the record to fill in before calling Commit, waits for the consumer when the ring is full.
+		TraceRecord& Next()
+		{
+			auto head = head_.load(std::memory_order_relaxed);
+
+			while (head == limit_)
+			{
+				limit_ = tail_.load(std::memory_order_acquire) + capacity_;
+
+				if (head == limit_)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			return records_[head & (capacity_ - 1)];
+		}
+
+		//Producer, publish the record returned by Next.
+		void Commit()
+		{
+			head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		//Consumer, hand the published records to write (as at most two contiguous spans) and release them,
+		//returns the number of records drained.
+		template <typename Write>
+		size_t Drain(Write&& write)
+		{
+			auto tail = tail_.load(std::memory_order_relaxed);
+			auto head = head_.load(std::memory_order_acquire);
+
+			if (head == tail)
+			{
+				return 0;
+			}
+
+			auto first = tail & (capacity_ - 1);
+			auto count = head - tail;
+			auto contiguous = std::min(count, capacity_ - first);
+			write(std::span<const TraceRecord>(records_.get() + first, contiguous));
+
+			if (contiguous < count)
+			{
+				write(std::span<const TraceRecord>(records_.get(), count - contiguous));
+			}
+
+			tail_.store(head, std::memory_order_release);
+			return count;
+		}
+
+		//Discard all the records, neither the producer nor the consumer may be running.
+		void Reset()
+		{
+			head_ = 0;
+			tail_ = 0;
+			limit_ = capacity_;
+		}
+	};
+} // namespace MachEmu
+
+#endif // TRACEBUFFER_H
@@ -20,8 +20,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
 #include <assert.h>
+#include <limits>
 #include <nlohmann/json.hpp>
+#include <utility>
 
 #include "Cpu/8080.h"
 #include "Utils/Utils.h"
@@ -29,272 +32,60 @@ SOFTWARE.
 namespace MachEmu
 {
 
-Intel8080::Intel8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, std::function<void(const SystemBus<uint16_t, uint8_t, 8>&&)> process)
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Switch>(int64_t cycleBudget);
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Threaded>(int64_t cycleBudget);
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Cached>(int64_t cycleBudget);
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Jit>(int64_t cycleBudget);
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Aot>(int64_t cycleBudget);
+
+Intel8080::Intel8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, Dispatcher dispatcher)
 	: addressBus_(systemBus.addressBus),
 	dataBus_(systemBus.dataBus),
-	controlBus_(systemBus.controlBus),
-	process_(process)
+	controlBus_(systemBus.controlBus)
 {
+	if (dispatcher == Dispatcher::Threaded)
+	{
+		dispatch_ = &Intel8080::Dispatch<Dispatcher::Threaded>;
+	}
+	else if (dispatcher == Dispatcher::Cached || dispatcher == Dispatcher::Jit || dispatcher == Dispatcher::Aot)
+	{
+		blocks_.resize(0x10000);
+		dispatch_ = dispatcher == Dispatcher::Aot ? &Intel8080::Dispatch<Dispatcher::Aot> : &Intel8080::Dispatch<Dispatcher::Cached>;
+
+		if (dispatcher == Dispatcher::Jit && jitSupported == true)
+		{
+			codeBuffer_ = std::make_unique<CodeBuffer>(codeBufferSize_);
+
+			// Executable memory is not available, stick with the cached dispatcher
+			if (codeBuffer_->Valid() == true)
+			{
+				dispatch_ = &Intel8080::Dispatch<Dispatcher::Jit>;
+			}
+			else
+			{
+				codeBuffer_.reset();
+			}
+		}
+	}
+	else
+	{
+		dispatch_ = &Intel8080::Dispatch<Dispatcher::Switch>;
+	}
+
 #ifdef ENABLE_OPCODE_TABLE
+#define OPCODE_FUNCTION(opcode, instruction) [&] { return instruction; },
+#define MEMORY_OPERAND(withOperand, withoutOperand) withoutOperand
 	opcodeTable_ = std::unique_ptr<std::function <uint8_t()>[]>(new std::function <uint8_t()>[256]
 	{
-		[&] { return Nop(); },
-		[&] { return Lxi(b_, c_); },
-		[&] { return Stax(b_, c_); },
-		[&] { return Inx(b_, c_); },
-		[&] { return Inr(b_); },
-		[&] { return Dcr(b_); },
-		[&] { return Mvi(b_); },
-		[&] { return Rlc(); },
-		[&] { return NotImplemented(); },
-		[&] { return Dad(b_, c_); },
-		[&] { return Ldax(b_, c_); },
-		[&] { return Dcx(b_, c_); },
-		[&] { return Inr(c_); },
-		[&] { return Dcr(c_); },
-		[&] { return Mvi(c_); },
-		[&] { return Rrc(); },
-		[&] { return NotImplemented(); },
-		[&] { return Lxi(d_, e_); },
-		[&] { return Stax(d_, e_); },
-		[&] { return Inx(d_, e_); },
-		[&] { return Inr(d_); },
-		[&] { return Dcr(d_); },
-		[&] { return Mvi(d_); },
-		[&] { return Ral(); },
-		[&] { return NotImplemented(); },
-		[&] { return Dad(d_, e_); },
-		[&] { return Ldax(d_, e_); },
-		[&] { return Dcx(d_, e_); },
-		[&] { return Inr(e_); },
-		[&] { return Dcr(e_); },
-		[&] { return Mvi(e_); },
-		[&] { return Rar(); },
-		[&] { return NotImplemented(); },
-		[&] { return Lxi(h_, l_); },
-		[&] { return Shld(); },
-		[&] { return Inx(h_, l_); },
-		[&] { return Inr(h_); },
-		[&] { return Dcr(h_); },
-		[&] { return Mvi(h_); },
-		[&] { return Daa(); },
-		[&] { return NotImplemented(); },
-		[&] { return Dad(h_, l_); },
-		[&] { return Lhld(); },
-		[&] { return Dcx(h_, l_); },
-		[&] { return Inr(l_); },
-		[&] { return Dcr(l_); },
-		[&] { return Mvi(l_); },
-		[&] { return Cma(); },
-		[&] { return NotImplemented(); },
-		[&] { return Lxi(); },
-		[&] { return Sta(); },
-		[&] { return Inx(); },
-		[&] { return Inr(); },
-		[&] { return Dcr(Uint16(h_, l_)); },
-		[&] { return Mvi(); },
-		[&] { return Stc(); },
-		[&] { return NotImplemented(); },
-		[&] { return Dad(); },
-		[&] { return Lda(); },
-		[&] { return Dcx(); },
-		[&] { return Inr(a_); },
-		[&] { return Dcr(a_); },
-		[&] { return Mvi(a_); },
-		[&] { return Cmc(); },
-		[&] { return Nop(); },
-		[&] { return Mov(b_, c_); },
-		[&] { return Mov(b_, d_); },
-		[&] { return Mov(b_, e_); },
-		[&] { return Mov(b_, h_); },
-		[&] { return Mov(b_, l_); },
-		[&] { return Mov(b_); },
-		[&] { return Mov(b_, a_); },
-		[&] { return Mov(c_, b_); },
-		[&] { return Nop(); },
-		[&] { return Mov(c_, d_); },
-		[&] { return Mov(c_, e_); },
-		[&] { return Mov(c_, h_); },
-		[&] { return Mov(c_, l_); },
-		[&] { return Mov(c_); },
-		[&] { return Mov(c_, a_); },
-		[&] { return Mov(d_, b_); },
-		[&] { return Mov(d_, c_); },
-		[&] { return Nop(); },
-		[&] { return Mov(d_, e_); },
-		[&] { return Mov(d_, h_); },
-		[&] { return Mov(d_, l_); },
-		[&] { return Mov(d_); },
-		[&] { return Mov(d_, a_); },
-		[&] { return Mov(e_, b_); },
-		[&] { return Mov(e_, c_); },
-		[&] { return Mov(e_, d_); },
-		[&] { return Nop(); },
-		[&] { return Mov(e_, h_); },
-		[&] { return Mov(e_, l_); },
-		[&] { return Mov(e_); },
-		[&] { return Mov(e_, a_); },
-		[&] { return Mov(h_, b_); },
-		[&] { return Mov(h_, c_); },
-		[&] { return Mov(h_, d_); },
-		[&] { return Mov(h_, e_); },
-		[&] { return Nop(); },
-		[&] { return Mov(h_, l_); },
-		[&] { return Mov(h_); },
-		[&] { return Mov(h_, a_); },
-		[&] { return Mov(l_, b_); },
-		[&] { return Mov(l_, c_); },
-		[&] { return Mov(l_, d_); },
-		[&] { return Mov(l_, e_); },
-		[&] { return Mov(l_, h_); },
-		[&] { return Nop(); },
-		[&] { return Mov(l_); },
-		[&] { return Mov(l_, a_); },
-		[&] { return Mov(Value(b_)); },
-		[&] { return Mov(Value(c_)); },
-		[&] { return Mov(Value(d_)); },
-		[&] { return Mov(Value(e_)); },
-		[&] { return Mov(Value(h_)); },
-		[&] { return Mov(Value(l_)); },
-		[&] { return Hlt(); },
-		[&] { return Mov(Value(a_)); },
-		[&] { return Mov(a_, b_); },
-		[&] { return Mov(a_, c_); },
-		[&] { return Mov(a_, d_); },
-		[&] { return Mov(a_, e_); },
-		[&] { return Mov(a_, h_); },
-		[&] { return Mov(a_, l_); },
-		[&] { return Mov(a_); },
-		[&] { return Nop(); },
-		[&] { return Add(b_, "ADD"); },
-		[&] { return Add(c_, "ADD"); },
-		[&] { return Add(d_, "ADD"); },
-		[&] { return Add(e_, "ADD"); },
-		[&] { return Add(h_, "ADD"); },
-		[&] { return Add(l_, "ADD"); },
-		[&] { return Add(Uint16(h_, l_), "ADD"); },
-		[&] { return Add(a_, "ADD"); },
-		[&] { return Adc(b_, "ADC"); },
-		[&] { return Adc(c_, "ADC"); },
-		[&] { return Adc(d_, "ADC"); },
-		[&] { return Adc(e_, "ADC"); },
-		[&] { return Adc(h_, "ADC"); },
-		[&] { return Adc(l_, "ADC"); },
-		[&] { return Adc(Uint16(h_, l_), "ADC"); },
-		[&] { return Adc(a_, "ADC"); },
-		[&] { return Sub(b_, "SUB"); },
-		[&] { return Sub(c_, "SUB"); },
-		[&] { return Sub(d_, "SUB"); },
-		[&] { return Sub(e_, "SUB"); },
-		[&] { return Sub(h_, "SUB"); },
-		[&] { return Sub(l_, "SUB"); },
-		[&] { return Sub(Uint16(h_, l_), "SUB"); },
-		[&] { return Sub(a_, "SUB"); },
-		[&] { return Sbb(b_, "SBB"); },
-		[&] { return Sbb(c_, "SBB"); },
-		[&] { return Sbb(d_, "SBB"); },
-		[&] { return Sbb(e_, "SBB"); },
-		[&] { return Sbb(h_, "SBB"); },
-		[&] { return Sbb(l_, "SBB"); },
-		[&] { return Sbb(Uint16(h_, l_), "SBB"); },
-		[&] { return Sbb(a_, "SBB"); },
-		[&] { return Ana(b_, "ANA"); },
-		[&] { return Ana(c_, "ANA"); },
-		[&] { return Ana(d_, "ANA"); },
-		[&] { return Ana(e_, "ANA"); },
-		[&] { return Ana(h_, "ANA"); },
-		[&] { return Ana(l_, "ANA"); },
-		[&] { return Ana(Uint16(h_, l_), "ANA"); },
-		[&] { return Ana(a_, "ANA"); },
-		[&] { return Xra(b_, "XRA"); },
-		[&] { return Xra(c_, "XRA"); },
-		[&] { return Xra(d_, "XRA"); },
-		[&] { return Xra(e_, "XRA"); },
-		[&] { return Xra(h_, "XRA"); },
-		[&] { return Xra(l_, "XRA"); },
-		[&] { return Xra(Uint16(h_, l_), "XRA"); },
-		[&] { return Xra(a_, "XRA"); },
-		[&] { return Ora(b_, "ORA"); },
-		[&] { return Ora(c_, "ORA"); },
-		[&] { return Ora(d_, "ORA"); },
-		[&] { return Ora(e_, "ORA"); },
-		[&] { return Ora(h_, "ORA"); },
-		[&] { return Ora(l_, "ORA"); },
-		[&] { return Ora(Uint16(h_, l_), "ORA"); },
-		[&] { return Ora(a_, "ORA"); },
-		[&] { return Cmp(b_, "CMP"); },
-		[&] { return Cmp(c_, "CMP"); },
-		[&] { return Cmp(d_, "CMP"); },
-		[&] { return Cmp(e_, "CMP"); },
-		[&] { return Cmp(h_, "CMP"); },
-		[&] { return Cmp(l_, "CMP"); },
-		[&] { return Cmp(Uint16(h_, l_), "CMP"); },
-		[&] { return Cmp(a_, "CMP"); },
-		[&] { return RetOnFlag(status_.test(Condition::ZeroFlag) == false, "RNZ"); },
-		[&] { return Pop(b_, c_); },
-		[&] { return JmpOnFlag(status_.test(Condition::ZeroFlag) == false, "JNZ"); },
-		[&] { return JmpOnFlag(true, "JMP"); },
-		[&] { return CallOnFlag(status_.test(Condition::ZeroFlag) == false, "CNZ"); },
-		[&] { return Push(b_, c_); },
-		[&] { return Add(++pc_, "ADI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::ZeroFlag) == true, "RZ"); },
-		[&] { return RetOnFlag(true, "RET"); },
-		[&] { return JmpOnFlag(status_.test(Condition::ZeroFlag) == true, "JZ"); },
-		[&] { return NotImplemented(); },
-		[&] { return CallOnFlag(status_.test(Condition::ZeroFlag) == true, "CZ"); },
-		[&] { return CallOnFlag(true, "CALL"); },
-		[&] { return Adc(++pc_, "ACI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::CarryFlag) == false, "RNC"); },
-		[&] { return Pop(d_, e_); },
-		[&] { return JmpOnFlag(status_.test(Condition::CarryFlag) == false, "JNC"); },
-		[&] { return Out(); },
-		[&] { return CallOnFlag(status_.test(Condition::CarryFlag) == false, "CNC"); },
-		[&] { return Push(d_, e_); },
-		[&] { return Sub(++pc_, "SUI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::CarryFlag) == true, "RC"); },
-		[&] { return NotImplemented(); },
-		[&] { return JmpOnFlag(status_.test(Condition::CarryFlag) == true, "JC"); },
-		[&] { return In(); },
-		[&] { return CallOnFlag(status_.test(Condition::CarryFlag) == true, "CC"); },
-		[&] { return NotImplemented(); },
-		[&] { return Sbb(++pc_, "SBI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::ParityFlag) == false, "RPO"); },
-		[&] { return Pop(h_, l_); },
-		[&] { return JmpOnFlag(status_.test(Condition::ParityFlag) == false, "JPO"); },
-		[&] { return Xthl(); },
-		[&] { return CallOnFlag(status_.test(Condition::ParityFlag) == false, "CPO"); },
-		[&] { return Push(h_, l_); },
-		[&] { return Ana(++pc_, "ANI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::ParityFlag) == true, "RPE"); },
-		[&] { return Pchl(); },
-		[&] { return JmpOnFlag(status_.test(Condition::ParityFlag) == true, "JPE"); },
-		[&] { return Xchg(); },
-		[&] { return CallOnFlag(status_.test(Condition::ParityFlag) == true, "CPE"); },
-		[&] { return NotImplemented(); },
-		[&] { return Xra(++pc_, "XRI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::SignFlag) == false, "RP"); },
-		[&] { auto ticks = 0; ticks = Pop(a_, status_); status_ = (status_ & Register(0xD7)) | Register(0x02); return ticks; },
-		[&] { return JmpOnFlag(status_.test(Condition::SignFlag) == false, "JP"); },
-		[&] { return Di(); },
-		[&] { return CallOnFlag(status_.test(Condition::SignFlag) == false, "CP"); },
-		[&] { return Push(a_, status_); },
-		[&] { return Ora(++pc_, "ORI"); },
-		[&] { return Rst(); },
-		[&] { return RetOnFlag(status_.test(Condition::SignFlag) == true, "RM"); },
-		[&] { return Sphl(); },
-		[&] { return JmpOnFlag(status_.test(Condition::SignFlag) == true, "JM"); },
-		[&] { return Ei(); },
-		[&] { return CallOnFlag(status_.test(Condition::SignFlag) == true, "CM"); },
-		[&] { return NotImplemented(); },
-		[&] { return Cmp(++pc_, "CPI"); },
-		[&] { return Rst(); },
+		OPCODES_8080(OPCODE_FUNCTION, MEMORY_OPERAND)
 	});
+#undef MEMORY_OPERAND
+#undef OPCODE_FUNCTION
 #endif
 }
 
@@ -302,14 +93,14 @@ std::unique_ptr<uint8_t[]> Intel8080::GetState(int* size) const
 {
 	auto state = std::make_unique<uint8_t[]>(12);
 
-	state[0] = Value(a_);
-	state[1] = Value(b_);
-	state[2] = Value(c_);
-	state[3] = Value(d_);
-	state[4] = Value(e_);
-	state[5] = Value(h_);
-	state[6] = Value(l_);
-	state[7] = Value(status_);
+	state[0] = a_;
+	state[1] = b_;
+	state[2] = c_;
+	state[3] = d_;
+	state[4] = e_;
+	state[5] = h_;
+	state[6] = l_;
+	state[7] = Status();
 	state[8] = static_cast<uint8_t>(pc_ >> 8);
 	state[9] = static_cast<uint8_t>(pc_ & 0xFF);
 	state[10] = static_cast<uint8_t>(sp_ >> 8);
@@ -355,35 +146,945 @@ void Intel8080::Load(const std::string&& str)
 	e_ = e;
 	h_ = h;
 	l_ = l;
-	status_ = s;
+	status_ = s & 0xFE;
+	carry_ = (s & 0x01) != 0;
+	lazyFlags_ = false;
 	pc_ = pc;
 	sp_ = sp;
+	halted_ = false;
+	ClearSpin();
+	// The memory has been restored along with the cpu
+	FlushBlocks();
 }
 
 std::string Intel8080::Save() const
 {
 	auto b64 = Utils::BinToTxt("base64", "none", uuid_.data(), uuid_.size());
 	auto fmtStr = "{\"uuid\":\"%s\",\"registers\":{\"a\":%d,\"b\":%d,\"c\":%d,\"d\":%d,\"e\":%d,\"h\":%d,\"l\":%d,\"s\":%d},\"pc\":%d,\"sp\":%d}";
-	auto count = snprintf(nullptr, 0, fmtStr, b64.c_str(), Value(a_), Value(b_), Value(c_), Value(d_), Value(e_), Value(h_), Value(l_), Value(status_), pc_, sp_);
+	auto count = snprintf(nullptr, 0, fmtStr, b64.c_str(), a_, b_, c_, d_, e_, h_, l_, Status(), pc_, sp_);
 	std::string str(count + 1, '\0');
-	snprintf(str.data(), count + 1, fmtStr, b64.c_str(), Value(a_), Value(b_), Value(c_), Value(d_), Value(e_), Value(h_), Value(l_), Value(status_), pc_, sp_);
+	snprintf(str.data(), count + 1, fmtStr, b64.c_str(), a_, b_, c_, d_, e_, h_, l_, Status(), pc_, sp_);
 	return str;
 }
 
+void Intel8080::Save(std::vector<uint8_t>& state) const
+{
+	state.insert(state.end(), uuid_.begin(), uuid_.end());
+	state.insert(state.end(), { a_, b_, c_, d_, e_, h_, l_, Status(),
+		static_cast<uint8_t>(pc_ >> 8), static_cast<uint8_t>(pc_ & 0xFF),
+		static_cast<uint8_t>(sp_ >> 8), static_cast<uint8_t>(sp_ & 0xFF) });
+}
+
+void Intel8080::Load(std::span<const uint8_t> state)
+{
+	// The cpus must be the same
+	if (state.size() != uuid_.size() + 12 || std::equal(uuid_.begin(), uuid_.end(), state.begin()) == false)
+	{
+		throw std::runtime_error("Incompatible cpu");
+	}
+
+	// Restore the state of the cpu
+	LoadRegisters(state.subspan(uuid_.size()));
+	halted_ = false;
+	ClearSpin();
+	// The memory has been restored along with the cpu
+	FlushBlocks();
+}
+
+void Intel8080::LoadRegisters(std::span<const uint8_t> registers)
+{
+	a_ = registers[0];
+	b_ = registers[1];
+	c_ = registers[2];
+	d_ = registers[3];
+	e_ = registers[4];
+	h_ = registers[5];
+	l_ = registers[6];
+	status_ = registers[7] & 0xFE;
+	carry_ = (registers[7] & 0x01) != 0;
+	lazyFlags_ = false;
+	pc_ = (registers[8] << 8) | registers[9];
+	sp_ = (registers[10] << 8) | registers[11];
+}
+
+void Intel8080::CopyState(const ICpu& cpu)
+{
+	std::vector<uint8_t> state;
+	cpu.Save(state);
+	// Throws when the cpus are not of the same type
+	Load(state);
+	iff_ = static_cast<const Intel8080&>(cpu).iff_;
+	halted_ = static_cast<const Intel8080&>(cpu).halted_;
+}
+
 uint8_t Intel8080::Fetch()
 {
 	//Fetch the next instruction
-	ReadFromAddress(Signal::MemoryRead, pc_);
-	opcode_ = dataBus_->Receive();
+	opcode_ = ReadMemory(pc_);
 	return -1;
 }
 
+/**
+	Execute the instruction held in opcode_
+
+	Decodes opcode_ via a switch statement (or the opcode table when ENABLE_OPCODE_TABLE
+	is defined) and executes it, pc_ must address the opcode. Shared by the switch and
+	cached dispatchers.
+
+	@param	predecoded	When true the immediate data or address of the lxi, mvi and jump
+						instructions is taken from operand instead of being read from memory.
+	@param	operand		The predecoded immediate data or address (little endian).
+
+	@return				The number of cycles taken.
+*/
+template <bool predecoded>
+uint8_t Intel8080::ExecuteOpcode([[maybe_unused]] uint16_t operand)
+{
+	uint8_t timePeriods = 0;
+
+#ifdef ENABLE_OPCODE_TABLE
+	timePeriods = opcodeTable_[opcode_]();
+#else
+#define EXECUTE_OPCODE(opcode, instruction) case 0x##opcode: timePeriods = instruction; break;
+#define PREDECODED_OPERAND(withOperand, withoutOperand) (predecoded == true ? withOperand : withoutOperand)
+	switch(opcode_)
+	{
+		OPCODES_8080(EXECUTE_OPCODE, PREDECODED_OPERAND)
+		default: assert(0); break;
+	}
+#undef PREDECODED_OPERAND
+#undef EXECUTE_OPCODE
+#endif
+
+	return timePeriods;
+}
+
+/**
+	Switch dispatcher
+
+	The portable dispatcher, decodes each instruction via a switch statement (or
+	the opcode table when ENABLE_OPCODE_TABLE is defined). Instructions are executed
+	until the cycle budget has been consumed or an instruction requires the attention of
+	the machine, at least one instruction is always executed.
+*/
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Switch>(int64_t cycleBudget)
+{
+	int64_t ticks = 0;
+	cycleBudget_ = cycleBudget;
+
+	do
+	{
+		/* opcode = */Fetch();
+		auto timePeriods = ExecuteOpcode<false>();
+
+		ticks += timePeriods;
+
+		if constexpr (perfCounters == true)
+		{
+			counters_.instructions[opcode_]++;
+			counters_.cycles[opcode_] += timePeriods;
+		}
+	}
+	while (ticks < cycleBudget_);
+
+	return ticks;
+}
+
+/**
+	Traced dispatcher
+
+	The switch dispatcher with a TraceRecord written to trace_ for each instruction, selected
+	by SetTrace in place of the switch dispatcher (the cached dispatcher traces its own blocks).
+*/
+int64_t Intel8080::DispatchTraced(int64_t cycleBudget)
+{
+	int64_t ticks = 0;
+	cycleBudget_ = cycleBudget;
+
+	do
+	{
+		/* opcode = */Fetch();
+		auto timePeriods = ExecuteTracedOpcode<false>();
+		ticks += timePeriods;
+
+		if constexpr (perfCounters == true)
+		{
+			counters_.instructions[opcode_]++;
+			counters_.cycles[opcode_] += timePeriods;
+		}
+	}
+	while (ticks < cycleBudget_);
+
+	return ticks;
+}
+
+template <bool predecoded>
+uint8_t Intel8080::ExecuteTracedOpcode(uint16_t operand)
+{
+	auto& record = TraceBegin(0);
+	auto timePeriods = ExecuteOpcode<predecoded>(operand);
+	TraceEnd(record);
+	traceTicks_ += timePeriods;
+	return timePeriods;
+}
+
+TraceRecord& Intel8080::TraceBegin(uint8_t flags)
+{
+	auto& record = trace_->Next();
+	record.cycles = traceTicks_;
+	record.pc = pc_;
+	record.sp = sp_;
+	record.opcode = opcode_;
+	record.a = a_;
+	record.b = b_;
+	record.c = c_;
+	record.d = d_;
+	record.e = e_;
+	record.h = h_;
+	record.l = l_;
+	record.status = Status();
+	record.writes = 0;
+	record.reserved = 0;
+
+	// Peek rather than read the operand, a read may have side effects when the memory isn't directly mapped
+	uint16_t operand = pc_ + 1;
+
+	if (memory_ != nullptr && pageAccess_[operand >> 8] != PageAccess::Trap && pageAccess_[static_cast<uint16_t>(operand + 1) >> 8] != PageAccess::Trap)
+	{
+		record.operand[0] = memory_[operand];
+		record.operand[1] = memory_[static_cast<uint16_t>(operand + 1)];
+	}
+	else
+	{
+		record.operand[0] = 0;
+		record.operand[1] = 0;
+		flags |= TraceRecord::unmapped;
+	}
+
+	record.flags = flags;
+	traceWrites_ = writes_;
+	return record;
+}
+
+void Intel8080::TraceEnd(TraceRecord& record)
+{
+	// writes_ also counts the io writes, only the instructions which write memory are considered
+	auto writes = writes_ - traceWrites_;
+
+	if (writes > 0 && (Opcodes8080::writesMemory[record.opcode] == true || (record.flags & TraceRecord::interrupt) != 0))
+	{
+		uint16_t addr[2]{};
+
+		switch (record.opcode)
+		{
+			case 0x02: addr[0] = (record.b << 8) | record.c; break;	// STAX B
+			case 0x12: addr[0] = (record.d << 8) | record.e; break;	// STAX D
+			case 0x22:												// SHLD
+			case 0x32:												// STA
+				addr[0] = (record.operand[1] << 8) | record.operand[0];
+				addr[1] = addr[0] + 1;
+				break;
+			case 0xE3:												// XTHL
+				addr[0] = record.sp;
+				addr[1] = record.sp + 1;
+				break;
+			default:
+				if ((record.opcode & 0xC0) == 0xC0)
+				{
+					// PUSH, CALL and RST, the high byte is pushed first
+					addr[0] = record.sp - 1;
+					addr[1] = record.sp - 2;
+				}
+				else
+				{
+					// The M register
+					addr[0] = (record.h << 8) | record.l;
+				}
+				break;
+		}
+
+		record.writes = static_cast<uint8_t>(std::min<uint64_t>(writes, 2));
+
+		for (int i = 0; i < record.writes; i++)
+		{
+			record.addresses[i] = addr[i];
+
+			if (memory_ != nullptr && pageAccess_[addr[i] >> 8] == PageAccess::ReadWrite)
+			{
+				record.values[i] = memory_[addr[i]];
+			}
+			else
+			{
+				record.values[i] = 0;
+				record.flags |= TraceRecord::unmapped;
+			}
+		}
+	}
+
+	trace_->Commit();
+}
+
+/**
+	Threaded dispatcher
+
+	Direct threaded dispatch using the GCC/Clang labels as values extension. Each
+	instruction handler jumps straight to the handler of the next instruction instead
+	of returning to a central switch, which gives the host branch predictor one
+	indirect jump per opcode. Instructions are executed until the cycle budget has
+	been consumed or an instruction requires the attention of the machine, at least
+	one instruction is always executed.
+*/
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Threaded>(int64_t cycleBudget)
+{
+#ifdef __GNUC__
+#define OPCODE_LABEL(opcode, instruction) &&op##opcode,
+#define MEMORY_OPERAND(withOperand, withoutOperand) withoutOperand
+	static const void* const labels[256] =
+	{
+		OPCODES_8080(OPCODE_LABEL, MEMORY_OPERAND)
+	};
+
+	int64_t ticks = 0;
+	//The ticks at the start of the current instruction, used by the performance counters
+	[[maybe_unused]] int64_t opTicks = 0;
+	cycleBudget_ = cycleBudget;
+
+#define COUNT_INSTRUCTION() if constexpr (perfCounters == true) { counters_.instructions[opcode_]++; counters_.cycles[opcode_] += ticks - opTicks; opTicks = ticks; }
+#define NEXT_INSTRUCTION() COUNT_INSTRUCTION(); if (ticks >= cycleBudget_) { return ticks; } Fetch(); goto *labels[opcode_]
+
+	Fetch();
+	goto *labels[opcode_];
+
+#define OPCODE_HANDLER(opcode, instruction) op##opcode: ticks += instruction; NEXT_INSTRUCTION();
+	OPCODES_8080(OPCODE_HANDLER, MEMORY_OPERAND)
+
+#undef OPCODE_HANDLER
+#undef NEXT_INSTRUCTION
+#undef COUNT_INSTRUCTION
+#undef MEMORY_OPERAND
+#undef OPCODE_LABEL
+#else
+	// Labels as values are not supported by this compiler, use the portable dispatcher
+	return Dispatch<Dispatcher::Switch>(cycleBudget);
+#endif
+}
+
+/**
+	Cached dispatcher
+
+	Decodes each guest basic block once into an array of predecoded instructions keyed by
+	its start address, each carrying its operand and cycle count. The lxi, mvi and jump
+	instructions are executed directly from the predecoded operand, the remainder are executed
+	via the shared switch. A block is invalidated when a page holding any of its code is written
+	to, execution of the current block stops as soon as it is invalidated so self modifying code
+	observes its own writes. Code in pages which are not mapped via SetMemory (or are trapped) is
+	never cached and is executed one instruction at a time. Instructions are executed until the
+	cycle budget has been consumed or an instruction requires the attention of the machine, at
+	least one instruction is always executed.
+*/
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Cached>(int64_t cycleBudget)
+{
+	return DispatchBlocks<Dispatcher::Cached>(cycleBudget);
+}
+
+/**
+	Jit dispatcher
+
+	The cached dispatcher, a block which has been executed hotBlock_ times is translated to
+	x86-64 host code which calls the handler of each instruction in turn with its predecoded
+	operand and sums the cycles they return, so the cycle counts are exact. The host code only
+	runs when the whole block fits in the cycle budget, it returns as soon as the block is
+	invalidated (self modifying code). A trailing in or out instruction is left to the
+	interpreter.
+*/
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Jit>(int64_t cycleBudget)
+{
+	return DispatchBlocks<Dispatcher::Jit>(cycleBudget);
+}
+
+/**
+	Aot dispatcher
+
+	The cached dispatcher, a block which starts at the same address and holds the same code
+	as a block translated to C++ ahead of time by the Recompiler (see the recompiledImages
+	build option) executes the recompiled block. Like the jit, the recompiled block only runs
+	when the whole block fits in the cycle budget and returns as soon as it is invalidated.
+	Code which the Recompiler didn't discover is executed by the cached dispatcher.
+*/
+template <>
+int64_t Intel8080::Dispatch<Dispatcher::Aot>(int64_t cycleBudget)
+{
+	return DispatchBlocks<Dispatcher::Aot>(cycleBudget);
+}
+
+template <Dispatcher dispatcher, bool traced>
+int64_t Intel8080::DispatchBlocks(int64_t cycleBudget)
+{
+	// The host code of the jit and aot blocks can't write a trace record for each instruction
+	static_assert(traced == false || dispatcher == Dispatcher::Cached);
+
+	// A single instruction doesn't benefit from a block lookup
+	if (cycleBudget <= 0)
+	{
+		if constexpr (traced == true)
+		{
+			return DispatchTraced(cycleBudget);
+		}
+		else
+		{
+			return Dispatch<Dispatcher::Switch>(cycleBudget);
+		}
+	}
+
+	int64_t ticks = 0;
+	cycleBudget_ = cycleBudget;
+
+	do
+	{
+		auto& block = blocks_[pc_];
+
+		if (block == nullptr)
+		{
+			block = std::make_unique<DecodedBlock>();
+		}
+
+		if (block->valid == false)
+		{
+			if (DecodeBlock(pc_, *block) == false)
+			{
+				// Not cacheable, execute a single instruction
+				Fetch();
+				auto timePeriods = traced == true ? ExecuteTracedOpcode<false>() : ExecuteOpcode<false>();
+				ticks += timePeriods;
+
+				if constexpr (perfCounters == true)
+				{
+					counters_.instructions[opcode_]++;
+					counters_.cycles[opcode_] += timePeriods;
+				}
+
+				continue;
+			}
+
+			if constexpr (dispatcher == Dispatcher::Aot)
+			{
+				LinkRecompiledBlock(pc_, *block);
+			}
+		}
+
+		// The block may be invalidated (but not freed) while it is being executed
+		const auto& current = *block;
+		// When the whole block fits in the budget only self modifying code can end it early, the
+		// instructions which take a variable number of cycles or clear the budget always end a block
+		auto fits = ticks + current.cycles < cycleBudget_;
+		auto budget = fits == true ? std::numeric_limits<int64_t>::max() : cycleBudget_;
+		size_t first = 0;
+
+		if constexpr (dispatcher != Dispatcher::Cached)
+		{
+			if (fits == true)
+			{
+				if constexpr (dispatcher == Dispatcher::Jit)
+				{
+					if (current.code == nullptr && ++block->executions == hotBlock_)
+					{
+						// Compiling may flush every block when the code buffer is full
+						CompileBlock(pc_, *block);
+					}
+				}
+
+				if (current.valid == true && current.code != nullptr)
+				{
+					if constexpr (perfCounters == true)
+					{
+						counters_.compiledBlocks++;
+					}
+
+					jitBlock_ = block.get();
+					ticks += current.code(this);
+					jitBlock_ = nullptr;
+
+					if constexpr (dispatcher == Dispatcher::Jit)
+					{
+						if (jitException_ != nullptr)
+						{
+							std::rethrow_exception(std::exchange(jitException_, nullptr));
+						}
+					}
+
+					first = current.compiledOps;
+				}
+			}
+
+			if (current.valid == false)
+			{
+				continue;
+			}
+		}
+
+		for (auto op = current.ops.begin() + first; op != current.ops.end(); op++)
+		{
+			opcode_ = op->opcode;
+			auto timePeriods = traced == true ? ExecuteTracedOpcode<true>(op->operand) : ExecuteOpcode<true>(op->operand);
+			ticks += timePeriods;
+
+			if constexpr (perfCounters == true)
+			{
+				counters_.instructions[opcode_]++;
+				counters_.cycles[opcode_] += timePeriods;
+			}
+
+			if (ticks >= budget || current.valid == false)
+			{
+				break;
+			}
+		}
+	}
+	while (ticks < cycleBudget_);
+
+	return ticks;
+}
+
+template <uint8_t opcode>
+uint8_t Intel8080::JitOp(Intel8080* cpu, uint16_t operand)
+{
+	// Exceptions can't unwind through the host code
+	try
+	{
+		cpu->opcode_ = opcode;
+		auto timePeriods = cpu->ExecuteOpcode<true>(operand);
+
+		if constexpr (perfCounters == true)
+		{
+			cpu->counters_.instructions[opcode]++;
+			cpu->counters_.cycles[opcode] += timePeriods;
+		}
+
+		return timePeriods;
+	}
+	catch (...)
+	{
+		cpu->jitException_ = std::current_exception();
+		cpu->jitBlock_->valid = false;
+		return 0;
+	}
+}
+
+template <uint8_t opcode>
+uint8_t Intel8080::RecompiledOp(uint16_t operand)
+{
+	opcode_ = opcode;
+	auto timePeriods = ExecuteOpcode<true>(operand);
+
+	if constexpr (perfCounters == true)
+	{
+		counters_.instructions[opcode]++;
+		counters_.cycles[opcode] += timePeriods;
+	}
+
+	return timePeriods;
+}
+
+const std::vector<Intel8080::RecompiledBlock>& Intel8080::RecompiledBlocks()
+{
+	// The blocks are lambdas defined within this member function so they can access the cpu state
+	static const std::vector<RecompiledBlock> blocks = []
+	{
+		std::vector<RecompiledBlock> blocks
+		{
+#include "RecompiledBlocks.inc"
+		};
+
+		std::stable_sort(blocks.begin(), blocks.end(), [](const auto& lhs, const auto& rhs) { return lhs.pc < rhs.pc; });
+		return blocks;
+	}();
+
+	return blocks;
+}
+
+void Intel8080::LinkRecompiledBlock(uint16_t pc, DecodedBlock& block)
+{
+	const auto& blocks = RecompiledBlocks();
+	auto first = std::lower_bound(blocks.begin(), blocks.end(), pc, [](const auto& recompiled, uint16_t pc) { return recompiled.pc < pc; });
+
+	// More than one image may have a block at the same address
+	for (auto recompiled = first; recompiled != blocks.end() && recompiled->pc == pc; recompiled++)
+	{
+		if (recompiled->ops <= block.ops.size() && pc + recompiled->code.size() <= 0x10000 &&
+			std::equal(recompiled->code.begin(), recompiled->code.end(), memory_ + pc) == true)
+		{
+			block.code = recompiled->run;
+			block.compiledOps = recompiled->ops;
+			return;
+		}
+	}
+}
+
+void Intel8080::CompileBlock(uint16_t pc, DecodedBlock& block)
+{
+	if constexpr (jitSupported == true)
+	{
+		static constexpr auto jitOps = []<size_t... opcodes>(std::index_sequence<opcodes...>)
+		{
+			return std::array<uint8_t(*)(Intel8080*, uint16_t), 256>{ &Intel8080::JitOp<opcodes>... };
+		}(std::make_index_sequence<256>{});
+
+		// The interpreter handles io
+		auto count = block.ops.size();
+
+		if (block.ops.back().opcode == 0xD3 || block.ops.back().opcode == 0xDB)
+		{
+			count--;
+		}
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		// The worst case size of the prologue, each instruction and the epilogue
+		if (codeBuffer_->Remaining() < 32 + count * 64 + 32)
+		{
+			// Start again with an empty buffer, every block is decoded and compiled again
+			FlushBlocks();
+			return;
+		}
+
+		auto& code = *codeBuffer_;
+		auto entry = code.Position();
+		std::vector<uint8_t*> exits;
+
+		// Preserve the callee saved registers holding the cpu (rbx) and the cycle count (r12)
+		code.Emit({ 0x53 });						// push rbx
+		code.Emit({ 0x41, 0x54 });					// push r12
+#ifdef _WIN32
+		code.Emit({ 0x48, 0x83, 0xEC, 0x28 });		// sub rsp, 40 (shadow space and alignment)
+		code.Emit({ 0x48, 0x89, 0xCB });			// mov rbx, rcx
+#else
+		code.Emit({ 0x48, 0x83, 0xEC, 0x08 });		// sub rsp, 8 (alignment)
+		code.Emit({ 0x48, 0x89, 0xFB });			// mov rbx, rdi
+#endif
+		code.Emit({ 0x45, 0x31, 0xE4 });			// xor r12d, r12d
+
+		// The register operand of the mov and mvi instructions as an offset from the cpu (rbx), B C D E H L M A
+		auto offset = [this](const auto& member) { return static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(&member) - reinterpret_cast<const uint8_t*>(this)); };
+		const std::array<uint32_t, 8> reg { offset(b_), offset(c_), offset(d_), offset(e_), offset(h_), offset(l_), 0, offset(a_) };
+		auto pcOffset = offset(pc_);
+		auto spOffset = offset(sp_);
+		// The program counter and cycles of the instructions translated inline are only written
+		// back before the next call to an instruction handler and at the end of the block.
+		auto addr = pc;
+		bool pcStale = false;
+		uint32_t pendingCycles = 0;
+
+		auto storeByte = [&code](uint32_t disp, uint8_t value)
+		{
+			code.Emit({ 0xC6, 0x83 });				// mov byte [rbx + disp], value
+			code.Emit32(disp);
+			code.Emit({ value });
+		};
+
+		auto storeWord = [&code](uint32_t disp, uint16_t value)
+		{
+			code.Emit({ 0x66, 0xC7, 0x83 });		// mov word [rbx + disp], value
+			code.Emit32(disp);
+			code.Emit({ static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) });
+		};
+
+		auto writeBack = [&]()
+		{
+			if (pcStale == true)
+			{
+				storeWord(pcOffset, addr);
+				pcStale = false;
+			}
+
+			if (pendingCycles > 0)
+			{
+				code.Emit({ 0x49, 0x81, 0xC4 });	// add r12, pendingCycles
+				code.Emit32(pendingCycles);
+				pendingCycles = 0;
+			}
+		};
+
+		// Translate the instruction inline, returns false when the handler must be called
+		auto translate = [&](const DecodedOp& op)
+		{
+			auto dst = (op.opcode >> 3) & 0x07;
+			auto src = op.opcode & 0x07;
+
+			if (op.opcode == 0x00)
+			{
+				// nop
+			}
+			else if (op.opcode >= 0x40 && op.opcode < 0x80 && dst != 6 && src != 6)
+			{
+				code.Emit({ 0x0F, 0xB6, 0x83 });	// movzx eax, byte [rbx + src]
+				code.Emit32(reg[src]);
+				code.Emit({ 0x88, 0x83 });			// mov byte [rbx + dst], al
+				code.Emit32(reg[dst]);
+			}
+			else if (op.opcode < 0x40 && src == 6 && dst != 6)
+			{
+				storeByte(reg[dst], static_cast<uint8_t>(op.operand));
+			}
+			else if (op.opcode == 0x01 || op.opcode == 0x11 || op.opcode == 0x21)
+			{
+				storeByte(reg[dst], static_cast<uint8_t>(op.operand >> 8));
+				storeByte(reg[dst + 1], static_cast<uint8_t>(op.operand));
+			}
+			else if (op.opcode == 0x31)
+			{
+				storeWord(spOffset, op.operand);
+			}
+			else if (op.opcode == 0xC3 && static_cast<uint16_t>(addr - op.operand) >= spinLoopBytes_)
+			{
+				// Always the last instruction of a block, a short backwards jump is left to its handler for DetectSpin
+				storeWord(pcOffset, op.operand);
+				pendingCycles += op.cycles;
+				pcStale = false;
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+
+			pendingCycles += op.cycles;
+			addr += opLength_[op.opcode];
+			pcStale = true;
+			return true;
+		};
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto& op = block.ops[i];
+
+			// The instruction counters and the branch coverage are only maintained by the handlers
+			if (perfCounters == false && coverage == false && translate(op) == true)
+			{
+				continue;
+			}
+
+			// Bring pc_ up to date for the handler
+			writeBack();
+#ifdef _WIN32
+			code.Emit({ 0x48, 0x89, 0xD9 });		// mov rcx, rbx
+			code.Emit({ 0xBA });					// mov edx, operand
+#else
+			code.Emit({ 0x48, 0x89, 0xDF });		// mov rdi, rbx
+			code.Emit({ 0xBE });					// mov esi, operand
+#endif
+			code.Emit32(op.operand);
+			code.Emit({ 0x48, 0xB8 });				// mov rax, handler
+			code.Emit64(reinterpret_cast<uint64_t>(jitOps[op.opcode]));
+			code.Emit({ 0xFF, 0xD0 });				// call rax
+			code.Emit({ 0x0F, 0xB6, 0xC0 });		// movzx eax, al
+			code.Emit({ 0x49, 0x01, 0xC4 });		// add r12, rax
+			addr += opLength_[op.opcode];
+
+			if (i + 1 < count)
+			{
+				code.Emit({ 0x48, 0xB8 });			// mov rax, &block.valid
+				code.Emit64(reinterpret_cast<uint64_t>(&block.valid));
+				code.Emit({ 0x80, 0x38, 0x00 });	// cmp byte [rax], 0
+				code.Emit({ 0x0F, 0x84 });			// je epilogue
+				exits.push_back(code.Position());
+				code.Emit32(0);
+			}
+		}
+
+		writeBack();
+
+		for (auto exit : exits)
+		{
+			CodeBuffer::Patch32(exit, static_cast<uint32_t>(code.Position() - (exit + 4)));
+		}
+
+		code.Emit({ 0x4C, 0x89, 0xE0 });			// mov rax, r12
+#ifdef _WIN32
+		code.Emit({ 0x48, 0x83, 0xC4, 0x28 });		// add rsp, 40
+#else
+		code.Emit({ 0x48, 0x83, 0xC4, 0x08 });		// add rsp, 8
+#endif
+		code.Emit({ 0x41, 0x5C });					// pop r12
+		code.Emit({ 0x5B });						// pop rbx
+		code.Emit({ 0xC3 });						// ret
+
+		block.code = reinterpret_cast<int64_t(*)(Intel8080*)>(entry);
+		block.compiledOps = count;
+	}
+}
+
+bool Intel8080::DecodeBlock(uint16_t pc, DecodedBlock& block)
+{
+	block.ops.clear();
+	block.cycles = 0;
+	block.executions = 0;
+	block.code = nullptr;
+	block.compiledOps = 0;
+
+	if (memory_ == nullptr)
+	{
+		return false;
+	}
+
+	uint32_t addr = pc;
+
+	while (block.ops.size() < maxBlockOps_)
+	{
+		auto opcode = memory_[addr];
+		auto length = opLength_[opcode];
+		auto last = addr + length - 1;
+
+		// Only cache code from directly accessible pages, don't wrap around the address space
+		if (last > 0xFFFF || pageAccess_[addr >> 8] == PageAccess::Trap || pageAccess_[last >> 8] == PageAccess::Trap)
+		{
+			break;
+		}
+
+		uint16_t operand = 0;
+
+		if (length == 2)
+		{
+			operand = memory_[addr + 1];
+		}
+		else if (length == 3)
+		{
+			operand = Uint16(memory_[addr + 2], memory_[addr + 1]);
+		}
+
+		block.ops.push_back({ opcode, opCycles_[opcode], operand });
+		block.cycles += opCycles_[opcode];
+		addr += length;
+
+		if (endsBlock_[opcode] == true)
+		{
+			break;
+		}
+	}
+
+	if (block.ops.empty() == true)
+	{
+		return false;
+	}
+
+	// Register the block with each page holding its code
+	for (auto page = pc >> 8; page <= static_cast<int>((addr - 1) >> 8); page++)
+	{
+		auto& starts = pageBlocks_[page];
+
+		if (std::find(starts.begin(), starts.end(), pc) == starts.end())
+		{
+			starts.push_back(pc);
+		}
+
+		codePages_[page] = true;
+	}
+
+	block.valid = true;
+	return true;
+}
+
+void Intel8080::InvalidateBlocks(uint8_t page)
+{
+	for (auto pc : pageBlocks_[page])
+	{
+		if (blocks_[pc] != nullptr)
+		{
+			blocks_[pc]->valid = false;
+		}
+	}
+
+	pageBlocks_[page].clear();
+	codePages_[page] = false;
+}
+
+void Intel8080::FlushBlocks()
+{
+	if (codeBuffer_ != nullptr)
+	{
+		codeBuffer_->Reset();
+	}
+
+	for (int page = 0; page < 256; page++)
+	{
+		if (codePages_[page] == true)
+		{
+			InvalidateBlocks(page);
+		}
+	}
+}
+
+void Intel8080::DetectSpin(uint16_t pc, uint16_t addr)
+{
+	if (static_cast<uint16_t>(pc - addr) >= spinLoopBytes_)
+	{
+		return;
+	}
+
+	uint64_t registers = 0;
+
+	for (auto r : { a_, b_, c_, d_, e_, h_, l_, Status() })
+	{
+		registers = (registers << 8) | r;
+	}
+
+	if (addr == spinTarget_ && registers == spinRegisters_ && sp_ == spinSp_ && writes_ == spinWrites_)
+	{
+		// The next iteration will be identical to the last, yield to the machine
+		spinning_ = true;
+		cycleBudget_ = 0;
+	}
+	else
+	{
+		spinTarget_ = addr;
+		spinRegisters_ = registers;
+		spinSp_ = sp_;
+		spinWrites_ = writes_;
+	}
+}
+
+void Intel8080::ClearSpin()
+{
+	spinning_ = false;
+	spinTarget_ = 0x10000;
+}
+
+bool Intel8080::Idle() const
+{
+	return halted_ == true || spinning_ == true;
+}
+
+bool Intel8080::InterruptsEnabled() const
+{
+	return iff_;
+}
+
 uint8_t Intel8080::Execute()
 {
-	static int nb_instructions = 0;
+	return static_cast<uint8_t>(ExecuteFor(0));
+}
+
+int64_t Intel8080::ExecuteFor(int64_t cycleBudget)
+{
+	if (memoryController_ == nullptr || ioPorts_ == nullptr)
+	{
+		throw std::runtime_error("The controllers have not been set");
+	}
 
 	auto isr = ISR::NoInterrupt;
-	uint8_t timePeriods = 0;
+	int64_t ticks = 0;
+	spinning_ = false;
+
+	if (trace_ != nullptr)
+	{
+		traceTicks_ = trace_->TotalTicks();
+	}
 
 	//Acknowledge the interrupt
 	if (controlBus_->Receive(Signal::Interrupt) == true)
@@ -403,315 +1104,229 @@ uint8_t Intel8080::Execute()
 
 	if (isr == ISR::NoInterrupt)
 	{
-		/* opcode = */Fetch();
-
-#ifdef ENABLE_OPCODE_TABLE
-		timePeriods = opcodeTable_[opcode_]();
-#else
-		switch(opcode_)
+		if (halted_ == true)
 		{
-			case 0x00: timePeriods = Nop(); break;
-			case 0x01: timePeriods = Lxi(b_, c_); break;
-			case 0x02: timePeriods = Stax(b_, c_); break;
-			case 0x03: timePeriods = Inx(b_, c_); break;
-			case 0x04: timePeriods = Inr(b_); break;
-			case 0x05: timePeriods = Dcr(b_); break;
-			case 0x06: timePeriods = Mvi(b_); break;
-			case 0x07: timePeriods = Rlc(); break;
-			case 0x08: timePeriods = NotImplemented(); break;
-			case 0x09: timePeriods = Dad(b_, c_); break;
-			case 0x0A: timePeriods = Ldax(b_, c_); break;
-			case 0x0B: timePeriods = Dcx(b_, c_); break;
-			case 0x0C: timePeriods = Inr(c_); break;
-			case 0x0D: timePeriods = Dcr(c_); break;
-			case 0x0E: timePeriods = Mvi(c_); break;
-			case 0x0F: timePeriods = Rrc(); break;
-			case 0x10: timePeriods = NotImplemented(); break;
-			case 0x11: timePeriods = Lxi(d_, e_); break;
-			case 0x12: timePeriods = Stax(d_, e_); break;
-			case 0x13: timePeriods = Inx(d_, e_); break;
-			case 0x14: timePeriods = Inr(d_); break;
-			case 0x15: timePeriods = Dcr(d_); break;
-			case 0x16: timePeriods = Mvi(d_); break;
-			case 0x17: timePeriods = Ral(); break;
-			case 0x18: timePeriods = NotImplemented(); break;
-			case 0x19: timePeriods = Dad(d_, e_); break;
-			case 0x1A: timePeriods = Ldax(d_, e_); break;
-			case 0x1B: timePeriods = Dcx(d_, e_); break;
-			case 0x1C: timePeriods = Inr(e_); break;
-			case 0x1D: timePeriods = Dcr(e_); break;
-			case 0x1E: timePeriods = Mvi(e_); break;
-			case 0x1F: timePeriods = Rar(); break;
-			case 0x20: timePeriods = NotImplemented(); break;
-			case 0x21: timePeriods = Lxi(h_, l_); break;
-			case 0x22: timePeriods = Shld(); break;
-			case 0x23: timePeriods = Inx(h_, l_); break;
-			case 0x24: timePeriods = Inr(h_); break;
-			case 0x25: timePeriods = Dcr(h_); break;
-			case 0x26: timePeriods = Mvi(h_); break;
-			case 0x27: timePeriods = Daa(); break;
-			case 0x28: timePeriods = NotImplemented(); break;
-			case 0x29: timePeriods = Dad(h_, l_); break;
-			case 0x2A: timePeriods = Lhld(); break;
-			case 0x2B: timePeriods = Dcx(h_, l_); break;
-			case 0x2C: timePeriods = Inr(l_); break;
-			case 0x2D: timePeriods = Dcr(l_); break;
-			case 0x2E: timePeriods = Mvi(l_); break;
-			case 0x2F: timePeriods = Cma(); break;
-			case 0x30: timePeriods = NotImplemented(); break;
-			case 0x31: timePeriods = Lxi(); break;
-			case 0x32: timePeriods = Sta(); break;
-			case 0x33: timePeriods = Inx(); break;
-			case 0x34: timePeriods = Inr(); break;
-			case 0x35: timePeriods = Dcr(Uint16(h_, l_)); break;
-			case 0x36: timePeriods = Mvi(); break;
-			case 0x37: timePeriods = Stc(); break;
-			case 0x38: timePeriods = NotImplemented(); break;
-			case 0x39: timePeriods = Dad(); break;
-			case 0x3A: timePeriods = Lda(); break;
-			case 0x3B: timePeriods = Dcx(); break;
-			case 0x3C: timePeriods = Inr(a_); break;
-			case 0x3D: timePeriods = Dcr(a_); break;
-			case 0x3E: timePeriods = Mvi(a_); break;
-			case 0x3F: timePeriods = Cmc(); break;
-			case 0x40: timePeriods = Nop(); break;
-			case 0x41: timePeriods = Mov(b_, c_); break;
-			case 0x42: timePeriods = Mov(b_, d_); break;
-			case 0x43: timePeriods = Mov(b_, e_); break;
-			case 0x44: timePeriods = Mov(b_, h_); break;
-			case 0x45: timePeriods = Mov(b_, l_); break;
-			case 0x46: timePeriods = Mov(b_); break;
-			case 0x47: timePeriods = Mov(b_, a_); break;
-			case 0x48: timePeriods = Mov(c_, b_); break;
-			case 0x49: timePeriods = Nop(); break;
-			case 0x4A: timePeriods = Mov(c_, d_); break;
-			case 0x4B: timePeriods = Mov(c_, e_); break;
-			case 0x4C: timePeriods = Mov(c_, h_); break;
-			case 0x4D: timePeriods = Mov(c_, l_); break;
-			case 0x4E: timePeriods = Mov(c_); break;
-			case 0x4F: timePeriods = Mov(c_, a_); break;
-			case 0x50: timePeriods = Mov(d_, b_); break;
-			case 0x51: timePeriods = Mov(d_, c_); break;
-			case 0x52: timePeriods = Nop(); break;
-			case 0x53: timePeriods = Mov(d_, e_); break;
-			case 0x54: timePeriods = Mov(d_, h_); break;
-			case 0x55: timePeriods = Mov(d_, l_); break;
-			case 0x56: timePeriods = Mov(d_); break;
-			case 0x57: timePeriods = Mov(d_, a_); break;
-			case 0x58: timePeriods = Mov(e_, b_); break;
-			case 0x59: timePeriods = Mov(e_, c_); break;
-			case 0x5A: timePeriods = Mov(e_, d_); break;
-			case 0x5B: timePeriods = Nop(); break;
-			case 0x5C: timePeriods = Mov(e_, h_); break;
-			case 0x5D: timePeriods = Mov(e_, l_); break;
-			case 0x5E: timePeriods = Mov(e_); break;
-			case 0x5F: timePeriods = Mov(e_, a_); break;
-			case 0x60: timePeriods = Mov(h_, b_); break;
-			case 0x61: timePeriods = Mov(h_, c_); break;
-			case 0x62: timePeriods = Mov(h_, d_); break;
-			case 0x63: timePeriods = Mov(h_, e_); break;
-			case 0x64: timePeriods = Nop(); break;
-			case 0x65: timePeriods = Mov(h_, l_); break;
-			case 0x66: timePeriods = Mov(h_); break;
-			case 0x67: timePeriods = Mov(h_, a_); break;
-			case 0x68: timePeriods = Mov(l_, b_); break;
-			case 0x69: timePeriods = Mov(l_, c_); break;
-			case 0x6A: timePeriods = Mov(l_, d_); break;
-			case 0x6B: timePeriods = Mov(l_, e_); break;
-			case 0x6C: timePeriods = Mov(l_, h_); break;
-			case 0x6D: timePeriods = Nop(); break;
-			case 0x6E: timePeriods = Mov(l_); break;
-			case 0x6F: timePeriods = Mov(l_, a_); break;
-			case 0x70: timePeriods = Mov(Value(b_)); break;
-			case 0x71: timePeriods = Mov(Value(c_)); break;
-			case 0x72: timePeriods = Mov(Value(d_)); break;
-			case 0x73: timePeriods = Mov(Value(e_)); break;
-			case 0x74: timePeriods = Mov(Value(h_)); break;
-			case 0x75: timePeriods = Mov(Value(l_)); break;
-			case 0x76: timePeriods = Hlt(); break;
-			case 0x77: timePeriods = Mov(Value(a_)); break;
-			case 0x78: timePeriods = Mov(a_, b_); break;
-			case 0x79: timePeriods = Mov(a_, c_); break;
-			case 0x7A: timePeriods = Mov(a_, d_); break;
-			case 0x7B: timePeriods = Mov(a_, e_); break;
-			case 0x7C: timePeriods = Mov(a_, h_); break;
-			case 0x7D: timePeriods = Mov(a_, l_); break;
-			case 0x7E: timePeriods = Mov(a_); break;
-			case 0x7F: timePeriods = Nop(); break;
-			case 0x80: timePeriods = Add(b_, "ADD"); break;
-			case 0x81: timePeriods = Add(c_, "ADD"); break;
-			case 0x82: timePeriods = Add(d_, "ADD"); break;
-			case 0x83: timePeriods = Add(e_, "ADD"); break;
-			case 0x84: timePeriods = Add(h_, "ADD"); break;
-			case 0x85: timePeriods = Add(l_, "ADD"); break;
-			case 0x86: timePeriods = Add(Uint16(h_, l_), "ADD"); break;
-			case 0x87: timePeriods = Add(a_, "ADD"); break;
-			case 0x88: timePeriods = Adc(b_, "ADC"); break;
-			case 0x89: timePeriods = Adc(c_, "ADC"); break;
-			case 0x8A: timePeriods = Adc(d_, "ADC"); break;
-			case 0x8B: timePeriods = Adc(e_, "ADC"); break;
-			case 0x8C: timePeriods = Adc(h_, "ADC"); break;
-			case 0x8D: timePeriods = Adc(l_, "ADC"); break;
-			case 0x8E: timePeriods = Adc(Uint16(h_, l_), "ADC"); break;
-			case 0x8F: timePeriods = Adc(a_, "ADC"); break;
-			case 0x90: timePeriods = Sub(b_, "SUB"); break;
-			case 0x91: timePeriods = Sub(c_, "SUB"); break;
-			case 0x92: timePeriods = Sub(d_, "SUB"); break;
-			case 0x93: timePeriods = Sub(e_, "SUB"); break;
-			case 0x94: timePeriods = Sub(h_, "SUB"); break;
-			case 0x95: timePeriods = Sub(l_, "SUB"); break;
-			case 0x96: timePeriods = Sub(Uint16(h_, l_), "SUB"); break;
-			case 0x97: timePeriods = Sub(a_, "SUB"); break;
-			case 0x98: timePeriods = Sbb(b_, "SBB"); break;
-			case 0x99: timePeriods = Sbb(c_, "SBB"); break;
-			case 0x9A: timePeriods = Sbb(d_, "SBB"); break;
-			case 0x9B: timePeriods = Sbb(e_, "SBB"); break;
-			case 0x9C: timePeriods = Sbb(h_, "SBB"); break;
-			case 0x9D: timePeriods = Sbb(l_, "SBB"); break;
-			case 0x9E: timePeriods = Sbb(Uint16(h_, l_), "SBB"); break;
-			case 0x9F: timePeriods = Sbb(a_, "SBB"); break;
-			case 0xA0: timePeriods = Ana(b_, "ANA"); break;
-			case 0xA1: timePeriods = Ana(c_, "ANA"); break;
-			case 0xA2: timePeriods = Ana(d_, "ANA"); break;
-			case 0xA3: timePeriods = Ana(e_, "ANA"); break;
-			case 0xA4: timePeriods = Ana(h_, "ANA"); break;
-			case 0xA5: timePeriods = Ana(l_, "ANA"); break;
-			case 0xA6: timePeriods = Ana(Uint16(h_, l_), "ANA"); break;
-			case 0xA7: timePeriods = Ana(a_, "ANA"); break;
-			case 0xA8: timePeriods = Xra(b_, "XRA"); break;
-			case 0xA9: timePeriods = Xra(c_, "XRA"); break;
-			case 0xAA: timePeriods = Xra(d_, "XRA"); break;
-			case 0xAB: timePeriods = Xra(e_, "XRA"); break;
-			case 0xAC: timePeriods = Xra(h_, "XRA"); break;
-			case 0xAD: timePeriods = Xra(l_, "XRA"); break;
-			case 0xAE: timePeriods = Xra(Uint16(h_, l_), "XRA"); break;
-			case 0xAF: timePeriods = Xra(a_, "XRA"); break;
-			case 0xB0: timePeriods = Ora(b_, "ORA"); break;
-			case 0xB1: timePeriods = Ora(c_, "ORA"); break;
-			case 0xB2: timePeriods = Ora(d_, "ORA"); break;
-			case 0xB3: timePeriods = Ora(e_, "ORA"); break;
-			case 0xB4: timePeriods = Ora(h_, "ORA"); break;
-			case 0xB5: timePeriods = Ora(l_, "ORA"); break;
-			case 0xB6: timePeriods = Ora(Uint16(h_, l_), "ORA"); break;
-			case 0xB7: timePeriods = Ora(a_, "ORA"); break;
-			case 0xB8: timePeriods = Cmp(b_, "CMP"); break;
-			case 0xB9: timePeriods = Cmp(c_, "CMP"); break;
-			case 0xBA: timePeriods = Cmp(d_, "CMP"); break;
-			case 0xBB: timePeriods = Cmp(e_, "CMP"); break;
-			case 0xBC: timePeriods = Cmp(h_, "CMP"); break;
-			case 0xBD: timePeriods = Cmp(l_, "CMP"); break;
-			case 0xBE: timePeriods = Cmp(Uint16(h_, l_), "CMP"); break;
-			case 0xBF: timePeriods = Cmp(a_, "CMP"); break;
-			case 0xC0: timePeriods = RetOnFlag(status_.test(Condition::ZeroFlag) == false, "RNZ"); break;
-			case 0xC1: timePeriods = Pop(b_, c_); break;
-			case 0xC2: timePeriods = JmpOnFlag(status_.test(Condition::ZeroFlag) == false, "JNZ"); break;
-			case 0xC3: timePeriods = JmpOnFlag(true, "JMP"); break;
-			case 0xC4: timePeriods = CallOnFlag(status_.test(Condition::ZeroFlag) == false, "CNZ"); break;
-			case 0xC5: timePeriods = Push(b_, c_); break;
-			case 0xC6: timePeriods = Add(++pc_, "ADI"); break;
-			case 0xC7: timePeriods = Rst(); break;
-			case 0xC8: timePeriods = RetOnFlag(status_.test(Condition::ZeroFlag) == true, "RZ"); break;
-			case 0xC9: timePeriods = RetOnFlag(true, "RET"); break;
-			case 0xCA: timePeriods = JmpOnFlag(status_.test(Condition::ZeroFlag) == true, "JZ"); break;
-			case 0xCB: timePeriods = NotImplemented(); break;
-			case 0xCC: timePeriods = CallOnFlag(status_.test(Condition::ZeroFlag) == true, "CZ"); break;
-			case 0xCD: timePeriods = CallOnFlag(true, "CALL"); break;
-			case 0xCE: timePeriods = Adc(++pc_, "ACI"); break;
-			case 0xCF: timePeriods = Rst(); break;
-			case 0xD0: timePeriods = RetOnFlag(status_.test(Condition::CarryFlag) == false, "RNC"); break;
-			case 0xD1: timePeriods = Pop(d_, e_); break;
-			case 0xD2: timePeriods = JmpOnFlag(status_.test(Condition::CarryFlag) == false, "JNC"); break;
-			case 0xD3: timePeriods = Out(); break;
-			case 0xD4: timePeriods = CallOnFlag(status_.test(Condition::CarryFlag) == false, "CNC"); break;
-			case 0xD5: timePeriods = Push(d_, e_); break;
-			case 0xD6: timePeriods = Sub(++pc_, "SUI"); break;
-			case 0xD7: timePeriods = Rst(); break;
-			case 0xD8: timePeriods = RetOnFlag(status_.test(Condition::CarryFlag) == true, "RC"); break;
-			case 0xD9: timePeriods = NotImplemented(); break;
-			case 0xDA: timePeriods = JmpOnFlag(status_.test(Condition::CarryFlag) == true, "JC"); break;
-			case 0xDB: timePeriods = In(); break;
-			case 0xDC: timePeriods = CallOnFlag(status_.test(Condition::CarryFlag) == true, "CC"); break;
-			case 0xDD: timePeriods = NotImplemented(); break;
-			case 0xDE: timePeriods = Sbb(++pc_, "SBI"); break;
-			case 0xDF: timePeriods = Rst(); break;
-			case 0xE0: timePeriods = RetOnFlag(status_.test(Condition::ParityFlag) == false, "RPO"); break;
-			case 0xE1: timePeriods = Pop(h_, l_); break;
-			case 0xE2: timePeriods = JmpOnFlag(status_.test(Condition::ParityFlag) == false, "JPO"); break;
-			case 0xE3: timePeriods = Xthl(); break;
-			case 0xE4: timePeriods = CallOnFlag(status_.test(Condition::ParityFlag) == false, "CPO"); break;
-			case 0xE5: timePeriods = Push(h_, l_); break;
-			case 0xE6: timePeriods = Ana(++pc_, "ANI"); break;
-			case 0xE7: timePeriods = Rst(); break;
-			case 0xE8: timePeriods = RetOnFlag(status_.test(Condition::ParityFlag) == true, "RPE"); break;
-			case 0xE9: timePeriods = Pchl(); break;
-			case 0xEA: timePeriods = JmpOnFlag(status_.test(Condition::ParityFlag) == true, "JPE"); break;
-			case 0xEB: timePeriods = Xchg(); break;
-			case 0xEC: timePeriods = CallOnFlag(status_.test(Condition::ParityFlag) == true, "CPE"); break;
-			case 0xED: timePeriods = NotImplemented(); break;
-			case 0xEE: timePeriods = Xra(++pc_, "XRI"); break;
-			case 0xEF: timePeriods = Rst(); break;
-			case 0xF0: timePeriods = RetOnFlag(status_.test(Condition::SignFlag) == false, "RP"); break;
-			case 0xF1: timePeriods = Pop(a_, status_); status_ = (status_ & Register(0xD7)) | Register(0x02); break;
-			case 0xF2: timePeriods = JmpOnFlag(status_.test(Condition::SignFlag) == false, "JP"); break;
-			case 0xF3: timePeriods = Di(); break;
-			case 0xF4: timePeriods = CallOnFlag(status_.test(Condition::SignFlag) == false, "CP"); break;
-			case 0xF5: timePeriods = Push(a_, status_); break;
-			case 0xF6: timePeriods = Ora(++pc_, "ORI"); break;
-			case 0xF7: timePeriods = Rst(); break;
-			case 0xF8: timePeriods = RetOnFlag(status_.test(Condition::SignFlag) == true, "RM"); break;
-			case 0xF9: timePeriods = Sphl(); break;
-			case 0xFA: timePeriods = JmpOnFlag(status_.test(Condition::SignFlag) == true, "JM"); break;
-			case 0xFB: timePeriods = Ei(); break;
-			case 0xFC: timePeriods = CallOnFlag(status_.test(Condition::SignFlag) == true, "CM"); break;
-			case 0xFD: timePeriods = NotImplemented(); break;
-			case 0xFE: timePeriods = Cmp(++pc_, "CPI"); break;
-			case 0xFF: timePeriods = Rst(); break;
-			default: assert(0); break;
+			//Idle for the whole budget, at least one machine cycle
+			ticks = std::max<int64_t>(cycleBudget, 4);
+		}
+		else
+		{
+			//Execute instructions until the budget has been consumed
+			ticks = (this->*dispatch_)(cycleBudget);
 		}
-#endif
 	}
 	else
 	{
+		//The interrupt returns to the instruction following the HLT
+		halted_ = false;
 		opcode_ = 0xC7 | (static_cast<uint8_t>(isr) << 3);
-		timePeriods = Rst(opcode_);
+
+		if (trace_ != nullptr)
+		{
+			auto& record = TraceBegin(TraceRecord::interrupt);
+			ticks = Rst(opcode_);
+			TraceEnd(record);
+			traceTicks_ += ticks;
+		}
+		else
+		{
+			ticks = Rst(opcode_);
+		}
+
+		if constexpr (perfCounters == true)
+		{
+			counters_.instructions[opcode_]++;
+			counters_.cycles[opcode_] += ticks;
+		}
 
 		//Interrupt is being serviced, clear it.
 		isr = ISR::NoInterrupt;
+
+		//Continue with the interrupt service routine if there is any budget remaining
+		if (ticks < cycleBudget)
+		{
+			ticks += (this->*dispatch_)(cycleBudget - ticks);
+		}
 	}
 
-	nb_instructions++;
-	return timePeriods;
+	return ticks;
 }
 
 //This essentially powers on the cpu
 void Intel8080::Reset(uint16_t pc)
 {
-	a_.reset();
-	b_.reset();
-	c_.reset();
-	d_.reset();
-	e_.reset();
-	h_.reset();
-	l_.reset();
+	a_ = 0;
+	b_ = 0;
+	c_ = 0;
+	d_ = 0;
+	e_ = 0;
+	h_ = 0;
+	l_ = 0;
 	pc_ = pc;
 	sp_ = 0;
 	status_ = 0b00000010;
+	carry_ = false;
+	lazyFlags_ = false;
 	iff_ = false;
+	halted_ = false;
+	ClearSpin();
+	dirtyPages_.fill(false);
+	frameCount_ = 0;
+	FlushBlocks();
+
+	if constexpr (perfCounters == true)
+	{
+		counters_ = {};
+	}
+
+	if constexpr (coverage == true)
+	{
+		coverage_.fill(0);
+	}
+}
+
+void Intel8080::SetMemory(uint8_t* memory, const std::array<PageAccess, 256>& pageAccess)
+{
+	memory_ = memory;
+	pageAccess_ = pageAccess;
+	FlushBlocks();
+}
+
+void Intel8080::SetControllers(IController* memoryController, const std::array<IController*, 256>* ioPorts)
+{
+	memoryController_ = memoryController;
+	ioPorts_ = ioPorts;
+}
+
+const CpuCounters& Intel8080::Counters() const
+{
+	return counters_;
+}
+
+std::array<bool, 256> Intel8080::DirtyPages()
+{
+	return std::exchange(dirtyPages_, {});
+}
+
+void Intel8080::Snapshot()
+{
+	snapshot_.clear();
+	Save(snapshot_);
+	snapshotIff_ = iff_;
+	snapshotHalted_ = halted_;
 }
 
-void Intel8080::ReadFromAddress(Signal readLocation, uint16_t addr)
+void Intel8080::Restore(const std::array<bool, 256>& restoredPages)
 {
-	controlBus_->Send(readLocation);
-	addressBus_->Send (addr);
-	process_(SystemBus<uint16_t, uint8_t, 8>(addressBus_, dataBus_, controlBus_));
+	if (snapshot_.empty() == true)
+	{
+		throw std::runtime_error("No cpu snapshot has been taken");
+	}
+
+	LoadRegisters(std::span(snapshot_).subspan(uuid_.size()));
+	iff_ = snapshotIff_;
+	halted_ = snapshotHalted_;
+	ClearSpin();
+
+	// Unlike Load only the code in the restored pages is stale
+	for (int page = 0; page < 256; page++)
+	{
+		if (restoredPages[page] == true && codePages_[page] == true)
+		{
+			InvalidateBlocks(page);
+		}
+	}
 }
 
-void Intel8080::WriteToAddress(Signal writeLocation, uint16_t addr, uint8_t value)
+std::span<uint8_t> Intel8080::Coverage()
 {
-	controlBus_->Send(writeLocation);
-	addressBus_->Send(addr);
-	dataBus_->Send(value);
-	process_(SystemBus<uint16_t, uint8_t, 8>(addressBus_, dataBus_, controlBus_));
+	return coverage_;
+}
+
+void Intel8080::SetTrace(TraceBuffer* trace)
+{
+	if (trace != nullptr && trace_ == nullptr)
+	{
+		// Trace the dispatcher chosen at construction, the other dispatchers are rejected by the trace option
+		if (dispatch_ == &Intel8080::Dispatch<Dispatcher::Switch>)
+		{
+			untracedDispatch_ = std::exchange(dispatch_, &Intel8080::DispatchTraced);
+		}
+		else if (dispatch_ == &Intel8080::Dispatch<Dispatcher::Cached>)
+		{
+			untracedDispatch_ = std::exchange(dispatch_, &Intel8080::DispatchBlocks<Dispatcher::Cached, true>);
+		}
+		else
+		{
+			throw std::runtime_error("Tracing is only supported by the switch and cached dispatchers");
+		}
+	}
+	else if (trace == nullptr && trace_ != nullptr)
+	{
+		dispatch_ = untracedDispatch_;
+	}
+
+	trace_ = trace;
+}
+
+void Intel8080::SetProfiling(bool profiling)
+{
+	profiling_ = profiling;
+	frameCount_ = 0;
+}
+
+void Intel8080::CallStack(std::vector<uint16_t>& stack) const
+{
+	stack.clear();
+
+	// The frames below sp_ have been left without a ret, the deeper frames can only be below them
+	for (size_t i = 0; i < frameCount_ && frames_[i].sp >= sp_; i++)
+	{
+		stack.push_back(frames_[i].addr);
+	}
+
+	stack.push_back(pc_);
+}
+
+uint8_t Intel8080::ReadMemory(uint16_t addr)
+{
+	if constexpr (perfCounters == true)
+	{
+		counters_.memoryReads++;
+	}
+
+	if (memory_ != nullptr && pageAccess_[addr >> 8] != PageAccess::Trap)
+	{
+		return memory_[addr];
+	}
+
+	return memoryController_->Read(addr);
+}
+
+void Intel8080::WriteMemory(uint16_t addr, uint8_t value)
+{
+	if constexpr (perfCounters == true)
+	{
+		counters_.memoryWrites++;
+	}
+
+	dirtyPages_[addr >> 8] = true;
+	writes_++;
+
+	// Self modifying code, the predecoded blocks in this page are stale
+	if (codePages_[addr >> 8] == true)
+	{
+		InvalidateBlocks(addr >> 8);
+	}
+
+	if (memory_ != nullptr && pageAccess_[addr >> 8] == PageAccess::ReadWrite)
+	{
+		memory_[addr] = value;
+	}
+	else
+	{
+		memoryController_->Write(addr, value);
+	}
 }
 
 /**
@@ -729,12 +1344,11 @@ uint8_t Intel8080::Inr()
 {
 	auto addr = Uint16(h_, l_);
 
-	ReadFromAddress(Signal::MemoryRead, addr);
 	//Get the data and process it.
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 	r = Add(r, 0x01, 0, false, "INR");
 	//Inr(r);
-	WriteToAddress(Signal::MemoryWrite, addr, Value(r));
+	WriteMemory(addr, r);
 	return 10;
 }
 
@@ -753,32 +1367,42 @@ uint8_t Intel8080::Dcr(Register& r)
 
 uint8_t Intel8080::Dcr(uint16_t addr)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 	r = Add(r, 0xFF, 0, false, "DCR");
 	//Dcr(r);
-	WriteToAddress (Signal::MemoryWrite, addr, Value(r));
+	WriteMemory(addr, r);
 	return 10;
 }
 
 uint8_t Intel8080::Mvi(Register& reg)
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	reg = dataBus_->Receive();
+	reg = ReadMemory(++pc_);
 
 	if constexpr (dbg == true)
 	{
-		printf("0x%04X MVI %c, 0x%02X\n", pc_ - 1, registerName_[(opcode_ & 0x38) >> 3], Value(reg));
+		printf("0x%04X MVI %c, 0x%02X\n", pc_ - 1, registerName_[(opcode_ & 0x38) >> 3], reg);
 	}
 
 	++pc_;
 	return 7;
 }
 
+uint8_t Intel8080::Mvi(Register& reg, uint8_t data)
+{
+	reg = data;
+
+	if constexpr (dbg == true)
+	{
+		printf("0x%04X MVI %c, 0x%02X\n", pc_, registerName_[(opcode_ & 0x38) >> 3], reg);
+	}
+
+	pc_ += 2;
+	return 7;
+}
+
 uint8_t Intel8080::Mvi()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto data = dataBus_->Receive();
+	auto data = ReadMemory(++pc_);
 	auto addr = Uint16(h_, l_);
 
 	if constexpr (dbg == true)
@@ -786,7 +1410,7 @@ uint8_t Intel8080::Mvi()
 		printf("0x%04X MVI [0x%04X], 0x%02X\n", pc_ - 1, addr, data);
 	}
 
-	WriteToAddress (Signal::MemoryWrite, addr, data);
+	WriteMemory(addr, data);
 	++pc_;
 	return 10;
 }
@@ -806,21 +1430,21 @@ uint8_t Intel8080::Daa()
 	}
 
 	uint8_t adjustment = 0;
-	uint8_t highNibble = Value(a_) >> 4;
-	uint8_t lowNibble = Value(a_) & 0x0F;
+	uint8_t highNibble = a_ >> 4;
+	uint8_t lowNibble = a_ & 0x0F;
 
-	if (lowNibble > 0x09 || status_[Condition::AuxCarryFlag] == true)
+	if (lowNibble > 0x09 || Flag(Condition::AuxCarryFlag) == true)
 	{
 		adjustment += 6;
 	}
 
-	if (highNibble > 0x09 || status_[Condition::CarryFlag] == true || (highNibble >= 9 && lowNibble > 9))
+	if (highNibble > 0x09 || carry_ == true || (highNibble >= 9 && lowNibble > 9))
 	{
 		adjustment += 0x60;
-		status_[Condition::CarryFlag] = true;
+		carry_ = true;
 	}
 
-	a_ = Add(a_, Register(adjustment), 0, false, "");
+	a_ = Add(a_, adjustment, 0, false, "");
 	return 4;
 }
 
@@ -839,9 +1463,8 @@ uint8_t Intel8080::Rlc()
 		printf("0x%04X RLC\n", pc_);
 	}
 
-	status_[CarryFlag] = a_[7];
-	a_ <<= 1;
-	a_[0] = status_[CarryFlag];
+	carry_ = (a_ & 0x80) != 0;
+	a_ = (a_ << 1) | carry_;
 	++pc_;
 	return 4;
 }
@@ -861,9 +1484,8 @@ uint8_t Intel8080::Rrc()
 		printf("0x%04X RRC\n", pc_);
 	}
 
-	status_[CarryFlag] = a_[0];
-	a_ >>= 1;
-	a_[7] = status_[CarryFlag];
+	carry_ = (a_ & 0x01) != 0;
+	a_ = (a_ >> 1) | (carry_ << 7);
 	++pc_;
 	return 4;
 }
@@ -883,10 +1505,9 @@ uint8_t Intel8080::Ral()
 		printf("0x%04X RAL\n", pc_);
 	}
 
-	bool tmp = status_[CarryFlag];
-	status_[CarryFlag] = a_[7];
-	a_ <<= 1;
-	a_[0] = tmp;
+	bool tmp = carry_;
+	carry_ = (a_ & 0x80) != 0;
+	a_ = (a_ << 1) | tmp;
 	++pc_;
 	return 4;
 }
@@ -906,36 +1527,58 @@ uint8_t Intel8080::Rar()
 		printf("0x%04X RAR\n", pc_);
 	}
 
-	bool tmp = status_[CarryFlag];
-	status_[CarryFlag] = a_[0];
-	a_ >>= 1;
-	a_[7] = tmp;
+	bool tmp = carry_;
+	carry_ = (a_ & 0x01) != 0;
+	a_ = (a_ >> 1) | (tmp << 7);
 	++pc_;
 	return 4;
 }
 
 uint8_t Intel8080::Lxi(Register& regHi, Register& regLow)
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	regLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	regHi = dataBus_->Receive();
+	regLow = ReadMemory(++pc_);
+	regHi = ReadMemory(++pc_);
 
 	if constexpr (dbg == true)
 	{
-		printf("0x%04X LXI %c, 0x%04X\n", pc_ - 2, registerName_[(opcode_ & 0x30) >> 3], Uint16(Value(regHi), Value(regLow)));
+		printf("0x%04X LXI %c, 0x%04X\n", pc_ - 2, registerName_[(opcode_ & 0x30) >> 3], Uint16(regHi, regLow));
 	}
 
 	++pc_;
 	return 10;
 }
 
+uint8_t Intel8080::Lxi(Register& regHi, Register& regLow, uint16_t data)
+{
+	regLow = data & 0xFF;
+	regHi = data >> 8;
+
+	if constexpr (dbg == true)
+	{
+		printf("0x%04X LXI %c, 0x%04X\n", pc_, registerName_[(opcode_ & 0x30) >> 3], data);
+	}
+
+	pc_ += 3;
+	return 10;
+}
+
+uint8_t Intel8080::Lxi(uint16_t data)
+{
+	sp_ = data;
+
+	if constexpr (dbg == true)
+	{
+		printf("0x%04X LXI SP, 0x%04X\n", pc_, sp_);
+	}
+
+	pc_ += 3;
+	return 10;
+}
+
 uint8_t Intel8080::Lxi()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto spLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	sp_ = Uint16(dataBus_->Receive(), spLow);
+	auto spLow = ReadMemory(++pc_);
+	sp_ = Uint16(ReadMemory(++pc_), spLow);
 
 	if constexpr (dbg == true)
 	{
@@ -956,18 +1599,16 @@ uint8_t Intel8080::Lxi()
 */
 uint8_t Intel8080::Shld()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	uint16_t addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	uint16_t addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X SHLD, [0x%04X]\n", pc_ - 2, addr);
 	}
 
-	WriteToAddress(Signal::MemoryWrite, addr, Value(l_));
-	WriteToAddress(Signal::MemoryWrite, addr + 1, Value(h_));
+	WriteMemory(addr, l_);
+	WriteMemory(addr + 1, h_);
 	++pc_;
 	return 16;
 }
@@ -991,7 +1632,7 @@ uint8_t Intel8080::Stax(const Register& hi, const Register& low)
 		printf("0x%04X STAX %c\n", pc_, registerName_[(opcode_ & 0x10) >> 3]);
 	}
 
-	WriteToAddress(Signal::MemoryWrite, Uint16(hi, low), Value(a_));
+	WriteMemory(Uint16(hi, low), a_);
 	++pc_;
 	return 7;
 }
@@ -1052,7 +1693,7 @@ uint8_t Intel8080::Dad(const Register& hi, const Register& low)
 	uint32_t val = Uint16(hi, low) + Uint16(h_, l_);
 	h_ = (val >> 8) & 0xFF;
 	l_ = val & 0xFF;
-	status_[Condition::CarryFlag] = (val > 0xFFFF);
+	carry_ = (val > 0xFFFF);
 	++pc_;
 	return 10;
 }
@@ -1071,20 +1712,16 @@ uint8_t Intel8080::Dad()
 */
 uint8_t Intel8080::Lhld()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	uint16_t addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	uint16_t addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X LHLD, [0x%04X]\n", pc_ - 2, addr);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, addr);
-	l_ = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, addr + 1);
-	h_ = dataBus_->Receive();
+	l_ = ReadMemory(addr);
+	h_ = ReadMemory(addr + 1);
 	++pc_;
 	return 16;
 }
@@ -1102,8 +1739,7 @@ uint8_t Intel8080::Ldax(const Register& hi, const Register& low)
 		printf("0x%04X LDAX, %c\n", pc_, registerName_[(opcode_ & 0x10) >> 3]);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, Uint16(hi, low));
-	a_ = dataBus_->Receive();
+	a_ = ReadMemory(Uint16(hi, low));
 	++pc_;
 	return 7;
 }
@@ -1152,24 +1788,22 @@ uint8_t Intel8080::Cma()
 		printf("0x%04X CMA\n", pc_);
 	}
 
-	a_.flip();
+	a_ = ~a_;
 	++pc_;
 	return 4;
 }
 
 uint8_t Intel8080::Sta()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	uint16_t addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	uint16_t addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X STA, [0x%04X]\n", pc_ - 2, addr);
 	}
 
-	WriteToAddress (Signal::MemoryWrite, addr, Value(a_));
+	WriteMemory(addr, a_);
 	++pc_;
 	return 13;
 }
@@ -1181,25 +1815,22 @@ uint8_t Intel8080::Stc()
 		printf("0x%04X STC\n", pc_);
 	}
 
-	status_[Condition::CarryFlag] = true;
+	carry_ = true;
 	++pc_;
 	return 4;
 }
 
 uint8_t Intel8080::Lda()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	uint16_t addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	uint16_t addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X LDA, [0x%04X]\n", pc_ - 2, addr);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, addr);
-	a_ = dataBus_->Receive();
+	a_ = ReadMemory(addr);
 	++pc_;
 	return 13;
 }
@@ -1211,7 +1842,7 @@ uint8_t Intel8080::Cmc()
 		printf("0x%04X CMC\n", pc_);
 	}
 
-	status_[Condition::CarryFlag] = !status_[Condition::CarryFlag];
+	carry_ = !carry_;
 	pc_++;
 	return 4;
 }
@@ -1237,22 +1868,19 @@ uint8_t Intel8080::Mov(Register& lhs)
 		printf("0x%04X MOV %c, [0x%04X]\n", pc_, registerName_[(opcode_ & 0x38) >> 3], addr);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, addr);
-	lhs = dataBus_->Receive();
+	lhs = ReadMemory(addr);
 	pc_++;
 	return 7;
 }
 
-uint8_t Intel8080::Mov(uint8_t value)
+uint8_t Intel8080::Mov(uint16_t addr, Register value)
 {
-	uint16_t addr = Uint16(h_, l_);
-
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X MOV [0x%04X], %c\n", pc_, addr, registerName_[opcode_ & 0x07]);
 	}
 
-	WriteToAddress(Signal::MemoryWrite, addr, value);
+	WriteMemory(addr, value);
 	pc_++;
 	return 7;
 }
@@ -1292,29 +1920,28 @@ uint8_t Intel8080::Hlt()
 		printf("0x%04X HLT\n", pc_);
 	}
 
-	// Untested
-	assert(0);
+	//Nothing more to do until an interrupt occurs, yield to the machine
+	halted_ = true;
+	cycleBudget_ = 0;
 	pc_++;
 	return 7;
 }
 
 Intel8080::Register Intel8080::Add(const Register& lhs, const Register& rhs, uint8_t carry, bool setCarryFlag, [[maybe_unused]] std::string_view instructionName)
 {
-	uint8_t a = Value(lhs);
-	uint8_t b = Value(rhs);
+	uint16_t sum = lhs + rhs + carry;
 
 	if (setCarryFlag == true)
 	{
-		status_[Condition::CarryFlag] = (a + b + carry) > 0xFF;
+		carry_ = sum > 0xFF;
 	}
 
-	status_[Condition::AuxCarryFlag] = ((a & 0x0F) + (b & 0x0F) + carry) > 0x0F;
-	auto r = Register(a + b + carry);
-	status_[Condition::ZeroFlag] = Zero(r);
-	status_[Condition::SignFlag] = Sign(r);
-	status_[Condition::ParityFlag] = Parity(r);
+	//The carry into bit 4 is the auxiliary carry
+	auxCarry_ = lhs ^ rhs;
+	result_ = static_cast<Register>(sum);
+	lazyFlags_ = true;
 	pc_++;
-	return r;
+	return result_;
 }
 
 uint8_t Intel8080::Add(const Register& r, std::string_view instructionName)
@@ -1325,29 +1952,27 @@ uint8_t Intel8080::Add(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Add(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	a_ = Add(a_, Register(dataBus_->Receive()), 0, true, instructionName);
+	a_ = Add(a_, ReadMemory(addr), 0, true, instructionName);
 	return 7;
 }
 
 
 uint8_t Intel8080::Adc(const Register& r, std::string_view instructionName)
 {
-	a_ = Add(a_, r, status_[Condition::CarryFlag], true, instructionName);
+	a_ = Add(a_, r, carry_, true, instructionName);
 	return 4;
 }
 
 uint8_t Intel8080::Adc(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	a_ = Add(a_, Register(dataBus_->Receive()), status_[Condition::CarryFlag], true, instructionName);
+	a_ = Add(a_, ReadMemory(addr), carry_, true, instructionName);
 	return 7;
 }
 
 Intel8080::Register Intel8080::Sub(const Register& r, uint8_t withCarry, std::string_view instructionName)
 {
-	auto reg = Add(a_, ~Value(r), !withCarry /* carry flag */, true, instructionName);
-	status_.flip(Condition::CarryFlag);
+	auto reg = Add(a_, static_cast<Register>(~r), !withCarry /* carry flag */, true, instructionName);
+	carry_ = !carry_;
 	return reg;
 }
 
@@ -1359,34 +1984,33 @@ uint8_t Intel8080::Sub(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Sub(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	a_ = Sub(Register(dataBus_->Receive()), 0, instructionName);
+	a_ = Sub(ReadMemory(addr), 0, instructionName);
 	return 7;
 }
 
 uint8_t Intel8080::Sbb(const Register& r, std::string_view instructionName)
 {
-	a_ = Sub(r, status_[Condition::CarryFlag], instructionName);
+	a_ = Sub(r, carry_, instructionName);
 	return 4;
 }
 
 uint8_t Intel8080::Sbb(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	a_ = Sub(Register(dataBus_->Receive()), status_[Condition::CarryFlag], instructionName);
+	a_ = Sub(ReadMemory(addr), carry_, instructionName);
 	return 7;
 }
 
 void Intel8080::Ana(const Register& r)
 {
-	status_[Condition::AuxCarryFlag] = ((a_ | r) & Register(0x08)) != 0;
+	//The auxiliary carry is set to bit 3 of a_ | r
+	auto auxCarry = ((a_ | r) & 0x08) << 1;
 
 	a_ &= r;
 
-	status_[Condition::CarryFlag] = false;
-	status_[Condition::ZeroFlag] = Zero(a_);
-	status_[Condition::SignFlag] = Sign(a_);
-	status_[Condition::ParityFlag] = Parity(a_);
+	carry_ = false;
+	result_ = a_;
+	auxCarry_ = a_ ^ auxCarry;
+	lazyFlags_ = true;
 	pc_++;
 }
 
@@ -1403,14 +2027,13 @@ uint8_t Intel8080::Ana(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Ana(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 
 	if constexpr (dbg == true)
 	{
 		if (instructionName.data() == "ANI")
 		{
-			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), Value(r));
+			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), r);
 		}
 		else
 		{
@@ -1426,11 +2049,10 @@ void Intel8080::Xra(const Register& r)
 {
 	a_ ^= r;
 
-	status_[Condition::AuxCarryFlag] = false;
-	status_[Condition::CarryFlag] = false;
-	status_[Condition::ZeroFlag] = Zero(a_);
-	status_[Condition::SignFlag] = Sign(a_);
-	status_[Condition::ParityFlag] = Parity(a_);
+	carry_ = false;
+	result_ = a_;
+	auxCarry_ = a_;
+	lazyFlags_ = true;
 	pc_++;
 }
 
@@ -1447,14 +2069,13 @@ uint8_t Intel8080::Xra(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Xra(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 
 	if constexpr (dbg == true)
 	{
 		if (instructionName.data() == "XRI")
 		{
-			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), Value(r));
+			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), r);
 		}
 		else
 		{
@@ -1470,11 +2091,10 @@ void Intel8080::Ora(const Register& r)
 {
 	a_ |= r;
 
-	status_[Condition::AuxCarryFlag] = false;
-	status_[Condition::CarryFlag] = false;
-	status_[Condition::ZeroFlag] = Zero(a_);
-	status_[Condition::SignFlag] = Sign(a_);
-	status_[Condition::ParityFlag] = Parity(a_);
+	carry_ = false;
+	result_ = a_;
+	auxCarry_ = a_;
+	lazyFlags_ = true;
 	pc_++;
 }
 
@@ -1491,14 +2111,13 @@ uint8_t Intel8080::Ora(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Ora(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 
 	if constexpr (dbg == true)
 	{
 		if (instructionName.data() == "ORI")
 		{
-			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), Value(r));
+			printf("0x%04X %s 0x%02X\n", pc_ - 1, instructionName.data(), r);
 		}
 		else
 		{
@@ -1518,8 +2137,7 @@ uint8_t Intel8080::Cmp(const Register& r, std::string_view instructionName)
 
 uint8_t Intel8080::Cmp(uint16_t addr, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, addr);
-	Register r = dataBus_->Receive();
+	Register r = ReadMemory(addr);
 	Sub(r, 0, instructionName);
 	return 7;
 }
@@ -1555,10 +2173,11 @@ uint8_t Intel8080::RetOnFlag(bool status, std::string_view instructionName)
 
 	if (status == true)
 	{
-		ReadFromAddress(Signal::MemoryRead, sp_++);
-		auto pcLow = dataBus_->Receive();
-		ReadFromAddress(Signal::MemoryRead, sp_++);
-		pc_ = Uint16(dataBus_->Receive(), pcLow);
+		LeaveFrame();
+		auto pcLow = ReadMemory(sp_++);
+		auto from = pc_ - 1;
+		pc_ = Uint16(ReadMemory(sp_++), pcLow);
+		CoverEdge(from, pc_);
 
 		if (std::string(instructionName) == "RET")
 		{
@@ -1589,36 +2208,113 @@ uint8_t Intel8080::Pop(Register& hi, Register& low)
 		}
 	}
 
-	ReadFromAddress(Signal::MemoryRead, sp_++);
-	low = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, sp_++);
-	hi = dataBus_->Receive();
+	low = ReadMemory(sp_++);
+	hi = ReadMemory(sp_++);
+	pc_++;
+	return 10;
+}
+
+uint8_t Intel8080::Pop()
+{
+	if constexpr (dbg == true)
+	{
+		printf("0x%04X POP PSW\n", pc_);
+	}
+
+	auto status = ReadMemory(sp_++);
+	a_ = ReadMemory(sp_++);
+	//Bits 3 and 5 are always 0, bit 1 is always 1
+	status_ = (status & 0xD6) | 0x02;
+	carry_ = (status & 0x01) != 0;
+	lazyFlags_ = false;
 	pc_++;
 	return 10;
 }
 
 uint8_t Intel8080::JmpOnFlag(bool status, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	auto addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X %s 0x%04X\n", pc_ - 2, instructionName.data(), addr);
 	}
 
-	status ? pc_ = addr : ++pc_;
+	if (status == true)
+	{
+		DetectSpin(pc_ - 2, addr);
+		CoverEdge(pc_ - 2, addr);
+		pc_ = addr;
+	}
+	else
+	{
+		++pc_;
+	}
+
+	return 10;
+}
+
+uint8_t Intel8080::JmpOnFlag(bool status, uint16_t addr, std::string_view instructionName)
+{
+	if constexpr (dbg == true)
+	{
+		printf("0x%04X %s 0x%04X\n", pc_, instructionName.data(), addr);
+	}
+
+	if (status == true)
+	{
+		DetectSpin(pc_, addr);
+		CoverEdge(pc_, addr);
+		pc_ = addr;
+	}
+	else
+	{
+		pc_ += 3;
+	}
+
 	return 10;
 }
 
+void Intel8080::CoverEdge(uint16_t from, uint16_t to)
+{
+	if constexpr (coverage == true)
+	{
+		// AFL style, the shift makes the edges from a to b and b to a distinct
+		auto& count = coverage_[(from >> 1) ^ to];
+		count += count != 0xFF;
+	}
+}
+
+void Intel8080::EnterFrame(uint16_t addr)
+{
+	if (profiling_ == true)
+	{
+		// The frames at or below the return address are stale, they were left without a ret
+		LeaveFrame();
+
+		if (frameCount_ < maxFrames_)
+		{
+			frames_[frameCount_++] = { addr, sp_ };
+		}
+	}
+}
+
+void Intel8080::LeaveFrame()
+{
+	if (profiling_ == true)
+	{
+		while (frameCount_ > 0 && frames_[frameCount_ - 1].sp <= sp_)
+		{
+			frameCount_--;
+		}
+	}
+}
+
 uint8_t Intel8080::CallOnFlag(bool status, std::string_view instructionName)
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addrLow = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto addr = Uint16(dataBus_->Receive(), addrLow);
+	auto addrLow = ReadMemory(++pc_);
+	auto addr = Uint16(ReadMemory(++pc_), addrLow);
 
 	if constexpr (dbg == true)
 	{
@@ -1630,9 +2326,9 @@ uint8_t Intel8080::CallOnFlag(bool status, std::string_view instructionName)
 	if (status == true)
 	{
 		sp_ += 0xFFFF;
-		WriteToAddress(Signal::MemoryWrite, sp_, pc_ >> 8);
+		WriteMemory(sp_, pc_ >> 8);
 		sp_ += 0xFFFF;
-		WriteToAddress(Signal::MemoryWrite, sp_, pc_ & 0xFF);
+		WriteMemory(sp_, pc_ & 0xFF);
 
 		/*
 			This needs to be moved ... by calling push above
@@ -1641,7 +2337,9 @@ uint8_t Intel8080::CallOnFlag(bool status, std::string_view instructionName)
 			This works because we can't interrupt an instruction mid execution.
 			If we could this would have to FIXED. It isn't technically correct, but works, a minor issue to fix someday.
 		*/
+		CoverEdge(pc_ - 3, addr);
 		pc_ = addr;
+		EnterFrame(addr);
 		return 17;
 	}
 	else
@@ -1665,13 +2363,18 @@ uint8_t Intel8080::Push(const Register& hi, const Register& low)
 	}
 
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, Value(hi));
+	WriteMemory(sp_, hi);
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, Value(low));
+	WriteMemory(sp_, low);
 	pc_++;
 	return 11;
 }
 
+uint8_t Intel8080::Push()
+{
+	return Push(a_, Status());
+}
+
 uint8_t Intel8080::Adi(const Register& r)
 {
 	if constexpr (dbg == true)
@@ -1679,8 +2382,7 @@ uint8_t Intel8080::Adi(const Register& r)
 		printf("0x%04X ADI %c\n", pc_, registerName_[(opcode_ & 0x30) >> 3]);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	a_ = Value(a_) + dataBus_->Receive();
+	a_ += ReadMemory(++pc_);
 	++pc_;
 	return 7;
 }
@@ -1705,9 +2407,9 @@ uint8_t Intel8080::Rst(uint8_t restart)
 	}
 
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, pc_ >> 8);
+	WriteMemory(sp_, pc_ >> 8);
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, pc_ & 0xFF);
+	WriteMemory(sp_, pc_ & 0xFF);
 
 	/*
 		This needs to be moved ... by calling push above
@@ -1717,6 +2419,7 @@ uint8_t Intel8080::Rst(uint8_t restart)
 		If we could this would have to FIXED. It isn't technically correct, but works, a minor issue to fix someday.
 	*/
 	pc_ = addr;
+	EnterFrame(addr);
 	return 11;
 }
 
@@ -1738,9 +2441,9 @@ uint8_t Intel8080::Rst()
 	++pc_;
 
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, pc_ >> 8);
+	WriteMemory(sp_, pc_ >> 8);
 	sp_ += 0xFFFF;
-	WriteToAddress(Signal::MemoryWrite, sp_, pc_ & 0xFF);
+	WriteMemory(sp_, pc_ & 0xFF);
 
 	/*
 		This needs to be moved ... by calling push above
@@ -1750,38 +2453,53 @@ uint8_t Intel8080::Rst()
 		If we could this would have to FIXED. It isn't technically correct, but works, a minor issue to fix someday.
 	*/
 	pc_ = addr;
+	EnterFrame(addr);
 	return 11;
 }
 
 uint8_t Intel8080::Out()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto out = dataBus_->Receive();
+	auto out = ReadMemory(++pc_);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X OUT 0x%02X\n", pc_ - 1, out);
 	}
 
+	if constexpr (perfCounters == true)
+	{
+		counters_.ioWrites[out]++;
+	}
+
 	//write to IO port 'out' the accumulator
-	WriteToAddress(Signal::IoWrite, out, Value(a_));
+	(*ioPorts_)[out]->Write(out, a_);
+
+	writes_++;
+	//The io controller may have work for the machine, yield to it
+	cycleBudget_ = 0;
 	++pc_;
 	return 10;
 }
 
 uint8_t Intel8080::In()
 {
-	ReadFromAddress(Signal::MemoryRead, ++pc_);
-	auto in = dataBus_->Receive();
+	auto in = ReadMemory(++pc_);
 
 	if constexpr (dbg == true)
 	{
 		printf("0x%04X IN 0x%02X\n", pc_ - 1, in);
 	}
 
+	if constexpr (perfCounters == true)
+	{
+		counters_.ioReads[in]++;
+	}
+
 	//Read into the accumulator the value in IO port 'in'.
-	ReadFromAddress(Signal::IoRead, in);
-	a_ = dataBus_->Receive();
+	a_ = (*ioPorts_)[in]->Read(in);
+
+	//The io controller may have work for the machine, yield to it
+	cycleBudget_ = 0;
 	++pc_;
 	return 10;
 }
@@ -1800,13 +2518,11 @@ uint8_t Intel8080::Xthl()
 		printf("0x%04X XTHL\n", pc_);
 	}
 
-	ReadFromAddress(Signal::MemoryRead, sp_);
-	auto spl = dataBus_->Receive();
-	ReadFromAddress(Signal::MemoryRead, sp_ + 1);
-	auto sph = dataBus_->Receive();
+	auto spl = ReadMemory(sp_);
+	auto sph = ReadMemory(sp_ + 1);
 
-	uint8_t l = Value(l_);
-	uint8_t h = Value(h_);
+	uint8_t l = l_;
+	uint8_t h = h_;
 
 	std::swap(spl, l);
 	std::swap(sph, h);
@@ -1814,8 +2530,8 @@ uint8_t Intel8080::Xthl()
 	l_ = l;
 	h_ = h;
 
-	WriteToAddress(Signal::MemoryWrite, sp_, spl);
-	WriteToAddress(Signal::MemoryWrite, sp_ + 1, sph);
+	WriteMemory(sp_, spl);
+	WriteMemory(sp_ + 1, sph);
 	pc_++;
 	return 18;
 }
@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "Cpu/CodeBuffer.h"
+
+namespace MachEmu
+{
+	CodeBuffer::CodeBuffer(size_t size)
+	{
+		if constexpr (jitSupported == true)
+		{
+#ifdef _WIN32
+			auto data = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+			auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_JIT
+			flags |= MAP_JIT;
+#endif
+			auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+
+			if (data == MAP_FAILED)
+			{
+				data = nullptr;
+			}
+#endif
+			if (data != nullptr)
+			{
+				data_ = static_cast<uint8_t*>(data);
+				size_ = size;
+			}
+		}
+	}
+
+	CodeBuffer::~CodeBuffer()
+	{
+		if (data_ != nullptr)
+		{
+#ifdef _WIN32
+			VirtualFree(data_, 0, MEM_RELEASE);
+#else
+			munmap(data_, size_);
+#endif
+		}
+	}
+
+	void CodeBuffer::Emit(std::initializer_list<uint8_t> bytes)
+	{
+		std::memcpy(data_ + pos_, bytes.begin(), bytes.size());
+		pos_ += bytes.size();
+	}
+
+	void CodeBuffer::Emit32(uint32_t value)
+	{
+		Patch32(data_ + pos_, value);
+		pos_ += sizeof(value);
+	}
+
+	void CodeBuffer::Emit64(uint64_t value)
+	{
+		// x86-64 is little endian
+		std::memcpy(data_ + pos_, &value, sizeof(value));
+		pos_ += sizeof(value);
+	}
+
+	void CodeBuffer::Patch32(uint8_t* at, uint32_t value)
+	{
+		std::memcpy(at, &value, sizeof(value));
+	}
+} // namespace MachEmu
@@ -24,8 +24,8 @@ SOFTWARE.
 
 namespace MachEmu
 {
-	std::unique_ptr<ICpu> Make8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, std::function<void(const SystemBus<uint16_t, uint8_t, 8>&&)>&& process)
+	std::unique_ptr<ICpu> Make8080(const SystemBus<uint16_t, uint8_t, 8>& systemBus, Dispatcher dispatcher)
 	{
-		return std::make_unique<Intel8080>(systemBus, process);
+		return std::make_unique<Intel8080>(systemBus, dispatcher);
 	}
 } // namespace MachEmu
\ No newline at end of file
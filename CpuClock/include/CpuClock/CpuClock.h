@@ -33,41 +33,45 @@ SOFTWARE.
 namespace MachEmu
 {
 	//Slow down the current thread to emulate the desired clock speed.
-	//Achieved through a combination of sleep/spin.
+	//Achieved by sleeping until an absolute deadline at the end of each
+	//resolution slice followed by a bounded spin.
 	class CpuClock final : public ICpuClock
 	{
 	private:
-		//Since sleep only guarantees a minimim sleep time, asking for
-		//what we really want will more than likley mean that we will
-		//over sleep, so we only ask for a percentage of what we want,
-		//(this can be reduced if we continually oversleep) then spin
-		//for the remainder.
+		//The clock speed in ticks per second.
 		//cppcheck-suppress unusedStructMember
-		static constexpr double spinPercantageToSleep_{ 0.7 };
+		uint64_t speed_{};
+		//The maximum amount of time to spin at the end of each slice, since
+		//sleep only guarantees a minimum sleep time we sleep until this amount
+		//of time before the deadline then spin for the remainder.
+		std::chrono::nanoseconds spinLimit_{};
 		// The number of ticks to accumulate before a correlation occurs.
 		// Set the default to -1 (don't sync the clock, run as fast as possible)
 		//cppcheck-suppress unusedStructMember
-		int totalTicks_{-1};
+		int64_t totalTicks_{-1};
 		// the current tick count in this correlation period.
 		//cppcheck-suppress unusedStructMember
-		int tickCount_{};
-		//The amount of time for one cycle to complete,
-		//this tends to be variable, for example, on the
-		//i8080 it ranges for 480ns to 2000ns.
-		//Could use a range here and then use a random
-		//value within the range .... or not ....
-		//just leaving it constant.
-		std::chrono::nanoseconds timePeriod_{};
-		// the total amount of oversleep
-		std::chrono::nanoseconds error_{};
+		int64_t tickCount_{};
+		// the total tick count since the epoch, each slice deadline is derived from it
+		// so oversleeping in one slice is recovered in the next
+		//cppcheck-suppress unusedStructMember
+		uint64_t ticks_{};
 		//The time at which this clock begun.
 		std::chrono::steady_clock::time_point epoch_{};
-		//The time at which this clock was sampled.
-		std::chrono::steady_clock::time_point lastTime_{};
 		// the current time of the clock expressed at a frequency as specified by correlateFreq
 		std::chrono::nanoseconds time_{};
 		// the maximum resolution of the host clock
 		std::chrono::nanoseconds maxResolution_{};
+		// the host cpu time of the ticking thread at its first tick, negative until then
+		std::chrono::nanoseconds cpuEpoch_{-1};
+		ClockTelemetry telemetry_{};
+
+		//Block the current thread until the deadline (or later).
+		static void SleepUntil(std::chrono::steady_clock::time_point deadline);
+		//The host cpu time consumed by the current thread.
+		static std::chrono::nanoseconds ThreadCpuTime();
+		//Sleep and spin until the deadline of the slice which has just completed.
+		void Pace();
 
 	public:
 		//correlateFreq
@@ -77,15 +81,16 @@ namespace MachEmu
 		//correlating at every tick or close to it will force a spin to maintain
 		//sync, anything above 50ms will allow a sleep for part of the time at the
 		//expense of sync accuracy.
-		CpuClock(uint64_t speed);
+		CpuClock(uint64_t speed, std::chrono::nanoseconds spinLimit);
 		~CpuClock() = default;
 
-		void Reset() final;
+		void Reset(uint64_t ticks) final;
 		ErrorCode SetTickResolution(std::chrono::nanoseconds resolution, int64_t* resolutionInTicks) final;
+		const ClockTelemetry& Telemetry() const final;
 
 		//Returns the host CPU time.
 		std::chrono::nanoseconds Tick(uint64_t ticks) final;
 	};
 } // namespace MachEmu
 
-#endif // CPUCLOCK_H
\ No newline at end of file
+#endif // CPUCLOCK_H
@@ -35,10 +35,14 @@ namespace MachEmu
 		execute at the correct rate.
 
 		@param	speed					The desired clock speed in ticks per second, for the i8080 cpu this will be 2000000 (2Mhz)
+		@param	timeSource				The source of the time returned by ICpuClock::Tick, a virtual clock never
+										reads the host clock nor synchronises with it.
+		@param	spinLimit				The maximum amount of time a host clock spins at the end of each resolution slice,
+										it sleeps until this amount of time before the slice deadline.
 
 		@return	unique_ptr				A unique_ptr to the CpuClock interface.
 	*/
-	std::unique_ptr<ICpuClock> MakeCpuClock(uint64_t speed);
+	std::unique_ptr<ICpuClock> MakeCpuClock(uint64_t speed, TimeSource timeSource = TimeSource::Host, std::chrono::nanoseconds spinLimit = std::chrono::nanoseconds(50000));
 } // namespace MachEmu
 
 #endif // CPUCLOCK_FACTORY_H
\ No newline at end of file
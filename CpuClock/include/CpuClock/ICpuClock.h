@@ -23,6 +23,7 @@ SOFTWARE.
 #ifndef ICPUCLOCK_H
 #define ICPUCLOCK_H
 
+#include <array>
 #include <chrono>
 #include <cstdint>
 
@@ -30,6 +31,23 @@ SOFTWARE.
 
 namespace MachEmu
 {
+	//The source of the time reported by the clock
+	enum class TimeSource
+	{
+		Host,		//The host steady clock, the clock can be synchronised to run at realtime
+		Virtual		//Derived from the elapsed ticks and the clock speed, the host clock is never read
+	};
+
+	//The pacing statistics accumulated since the last Reset, only a host clock with a non negative resolution paces
+	struct ClockTelemetry
+	{
+		uint64_t slices{};							//The number of resolution slices paced
+		std::array<uint64_t, 16> overshoot{};		//A log2 microsecond histogram of how late each slice completed: <1us, 1-2us, 2-4us ... >=16384us
+		std::array<uint64_t, 16> undershoot{};		//A log2 microsecond histogram of how early each slice completed
+		std::chrono::nanoseconds drift{};			//The host time minus the emulated time at the end of the last slice
+		std::chrono::nanoseconds cpuTime{};			//The host cpu time consumed by the thread ticking the clock
+	};
+
 	/** ICpuClock
 	
 		Represents the clock of an emulated cpu.
@@ -87,9 +105,18 @@ namespace MachEmu
 
 		/** Reset.
 
-			Resets the epoch of the clock.
+			Resets the epoch of the clock and its telemetry.
+
+			@param	ticks		The number of ticks the clock has already advanced by, the epoch is
+								set back by this many time periods so the clock resumes from them.
+		*/
+		virtual void Reset(uint64_t ticks = 0) = 0;
+
+		/** Telemetry.
+
+			The pacing statistics accumulated since the last Reset.
 		*/
-		virtual void Reset() = 0;
+		virtual const ClockTelemetry& Telemetry() const = 0;
 
 		virtual ~ICpuClock() = default;
 	};
@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VIRTUALCPUCLOCK_H
+#define VIRTUALCPUCLOCK_H
+
+#include <cstdint>
+#include <chrono>
+
+#include "Base/Base.h"
+#include "CpuClock/ICpuClock.h"
+
+namespace MachEmu
+{
+	//A clock whose time is derived from the number of elapsed ticks and the clock speed.
+	//The host clock is never read and the current thread is never slowed down, hence
+	//the machine runs as fast as possible and every run is reproducible.
+	class VirtualCpuClock final : public ICpuClock
+	{
+	private:
+		//The clock speed in ticks per second.
+		//cppcheck-suppress unusedStructMember
+		uint64_t speed_{};
+		//The number of ticks since the last Reset.
+		//cppcheck-suppress unusedStructMember
+		uint64_t ticks_{};
+		//Always empty, the clock never paces.
+		ClockTelemetry telemetry_{};
+
+	public:
+		VirtualCpuClock(uint64_t speed);
+		~VirtualCpuClock() = default;
+
+		void Reset(uint64_t ticks) final;
+		//Sets the number of ticks the resolution represents, the clock never synchronises with the host.
+		ErrorCode SetTickResolution(std::chrono::nanoseconds resolution, int64_t* resolutionInTicks) final;
+		const ClockTelemetry& Telemetry() const final;
+
+		//Returns the virtual time.
+		std::chrono::nanoseconds Tick(uint64_t ticks) final;
+	};
+} // namespace MachEmu
+
+#endif // VIRTUALCPUCLOCK_H
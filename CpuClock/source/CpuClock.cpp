@@ -20,14 +20,19 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+#include <bit>
+
 #ifdef __GNUC__
-// use nanosleep
+// use clock_nanosleep/nanosleep
+#include <cerrno>
 #include <time.h>
 #elif defined _WINDOWS
 // use hi-res window sleep
 #include <Windows.h>
 #else
-// use std::thread::sleep_for
+// use std::thread::sleep_until
+#include <ctime>
 #include <thread>
 #endif
 
@@ -37,8 +42,9 @@ using namespace std::chrono;
 
 namespace MachEmu
 {
-	CpuClock::CpuClock(uint64_t speed) :
-		timePeriod_(1000000000 / speed)
+	CpuClock::CpuClock(uint64_t speed, nanoseconds spinLimit) :
+		speed_(speed),
+		spinLimit_(spinLimit)
 	{
 		// tick the clock after at least this many ticks
 		//totalTicks_ = speed / 1000.0 /* millis: 1000 ticks per second*/ * correlateFreq.count();
@@ -93,14 +99,15 @@ namespace MachEmu
 	{
 		auto err = ErrorCode::NoError;
 
-		if (resolution >= nanoseconds::zero() && timePeriod_ >= nanoseconds::zero())
+		if (resolution >= nanoseconds::zero())
 		{
 			if (resolution < maxResolution_)
 			{
 				err = ErrorCode::ClockResolution;
 			}
 
-			totalTicks_ = resolution / timePeriod_;
+			// split into whole seconds so the tick count can't overflow when converting from nanoseconds
+			totalTicks_ = duration_cast<seconds>(resolution).count() * speed_ + (resolution % seconds(1)).count() * speed_ / 1000000000;
 		}
 		else
 		{
@@ -115,91 +122,140 @@ namespace MachEmu
 		return err;
 	}
 
-	nanoseconds CpuClock::Tick(uint64_t ticks)
+	const ClockTelemetry& CpuClock::Telemetry() const
 	{
-		if (totalTicks_ >= 0)
+		return telemetry_;
+	}
+
+	void CpuClock::SleepUntil(steady_clock::time_point deadline)
+	{
+#ifdef __linux__
+		// The steady clock is CLOCK_MONOTONIC, sleep to the absolute deadline so an
+		// interrupted sleep or a late wake up never pushes back the following slices
+		auto sinceEpoch = deadline.time_since_epoch();
+		struct timespec req
 		{
-			tickCount_ += ticks;
+			static_cast<time_t>(duration_cast<seconds>(sinceEpoch).count()),
+			static_cast<long>((sinceEpoch % seconds(1)).count())
+		};
+
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &req, nullptr) == EINTR);
+#elif defined __GNUC__
+		auto sleepFor = deadline - steady_clock::now();
+		struct timespec req
+		{
+			static_cast<time_t>(duration_cast<seconds>(sleepFor).count()),
+			static_cast<long>((sleepFor % seconds(1)).count())
+		};
 
-			if (tickCount_ >= totalTicks_)
-			{
-				auto sleepFor = [this](nanoseconds spinTime)
-				{
-					// don't attempt to sleep for anything less than a millisecond
-					if (spinTime >= nanoseconds(1000000))
-					{
-						auto now = steady_clock::now();
-#ifdef __GNUC__
-						struct timespec req
-						{
-							0,
-#ifdef __arm__
-							static_cast<int32_t>(spinTime.count()* spinPercantageToSleep_)
+		nanosleep(&req, nullptr);
+#elif defined _WINDOWS
+		LARGE_INTEGER sleepPeriod;
+		// Convert from nanoseconds to 100 nanosescond units, and negative for relative time.
+		sleepPeriod.QuadPart = -(duration_cast<nanoseconds>(deadline - steady_clock::now()).count() / 100);
+
+		// Create the timer, sleep until time has passed, and clean up - available since the 1803 version of Windows 10.
+		// Sleep down to 0.5 ms intervals without raising the system level interrupt frequency, which is much friendlier.
+		HANDLE timer = CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		SetWaitableTimer(timer, &sleepPeriod, 0, nullptr, nullptr, 0);
+		WaitForSingleObject(timer, INFINITE);
+		CloseHandle(timer);
 #else
-							static_cast<int64_t>(spinTime.count()* spinPercantageToSleep_)
+		std::this_thread::sleep_until(deadline);
 #endif
-						};
-						nanosleep(&req, nullptr);
+	}
+
+	nanoseconds CpuClock::ThreadCpuTime()
+	{
+#ifdef __GNUC__
+		struct timespec ts{};
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+		return seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec);
 #elif defined _WINDOWS
-						LARGE_INTEGER sleepPeriod;
-						// Convert from nanoseconds to 100 nanosescond units, and negative for relative time.
-						sleepPeriod.QuadPart = -(static_cast<int64_t>(spinTime.count() * spinPercantageToSleep_) / 100);
-
-						// Create the timer, sleep until time has passed, and clean up - available since the 1803 version of Windows 10.
-						// Sleep down to 0.5 ms intervals without raising the system level interrupt frequency, which is much friendlier.
-						HANDLE timer = CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
-						SetWaitableTimer(timer, &sleepPeriod, 0, nullptr, nullptr, 0);
-						WaitForSingleObject(timer, INFINITE);
-						CloseHandle(timer);
+		FILETIME creation, exit, kernel, user;
+		GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+		auto hundredNanos = [](const FILETIME& ft) { return (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+		return nanoseconds((hundredNanos(kernel) + hundredNanos(user)) * 100);
 #else
-						std::this_thread::sleep_for(nanoseconds(static_cast<int64_t>(spinTime.count() * spinPercantageToSleep_)));
+		// process cpu time, the best that is available
+		return nanoseconds(static_cast<int64_t>(std::clock() * (1000000000.0 / CLOCKS_PER_SEC)));
 #endif
-						spinTime -= duration_cast<nanoseconds>(steady_clock::now() - now);
-					}
+	}
 
-					return spinTime;
-				};
+	void CpuClock::Pace()
+	{
+		if (cpuEpoch_ < nanoseconds::zero())
+		{
+			// The clock is reset from the thread which powers on the machine, the cpu time is measured from the first slice of the ticking thread
+			cpuEpoch_ = ThreadCpuTime();
+		}
 
-				auto spinFor = [this](nanoseconds spinTime)
-				{
-					auto now = steady_clock::now();
+		// split into whole seconds so the tick count can't overflow when converting to nanoseconds
+		auto deadline = epoch_ + nanoseconds((ticks_ / speed_) * 1000000000 + (ticks_ % speed_) * 1000000000 / speed_);
+		auto now = steady_clock::now();
 
-					if (spinTime > nanoseconds::zero())
-					{
-						auto start = now;
-						auto end = (now + spinTime);
+		if (deadline - now > spinLimit_)
+		{
+			SleepUntil(deadline - spinLimit_);
+			now = steady_clock::now();
+		}
+
+		// Spin for the remainder, never for longer than the spin limit
+		auto spinUntil = std::min(deadline, now + spinLimit_);
+
+		while (now < spinUntil)
+		{
+			now = steady_clock::now();
+		}
+
+		auto error = duration_cast<nanoseconds>(now - deadline);
+		auto bucket = [](nanoseconds error) { return std::min<size_t>(std::bit_width(static_cast<uint64_t>(error.count() / 1000)), 15); };
+
+		if (error >= nanoseconds::zero())
+		{
+			telemetry_.overshoot[bucket(error)]++;
+		}
+		else
+		{
+			telemetry_.undershoot[bucket(-error)]++;
+		}
 
-						while (now < end)
-						{
-							now = steady_clock::now();
-						}
+		telemetry_.slices++;
+		telemetry_.drift = error;
+		telemetry_.cpuTime = ThreadCpuTime() - cpuEpoch_;
+		time_ = duration_cast<nanoseconds>(now - epoch_);
+	}
 
-						// record any over spin
-						spinTime = duration_cast<nanoseconds>(end - now);
-					}
+	nanoseconds CpuClock::Tick(uint64_t ticks)
+	{
+		ticks_ += ticks;
 
-					return spinTime;
-				};
+		if (totalTicks_ >= 0)
+		{
+			tickCount_ += ticks;
 
-				auto nanos = nanoseconds(tickCount_ * timePeriod_) - duration_cast<nanoseconds>(steady_clock::now() - lastTime_) + error_;
-				error_ = spinFor(sleepFor(nanos));
+			if (tickCount_ >= totalTicks_)
+			{
 				tickCount_ = 0;
-				lastTime_ = steady_clock::now();
-				time_ = duration_cast<nanoseconds>(lastTime_ - epoch_);
+				Pace();
 			}
 		}
 		else
 		{
-			lastTime_ = steady_clock::now();
-			time_ = duration_cast<nanoseconds>(lastTime_ - epoch_);
+			time_ = duration_cast<nanoseconds>(steady_clock::now() - epoch_);
 		}
 
 		return time_;
 	}
 
-	void CpuClock::Reset()
+	void CpuClock::Reset(uint64_t ticks)
 	{
-		epoch_ = steady_clock::now();
-		lastTime_ = epoch_;
+		// split into whole seconds so the tick count can't overflow when converting to nanoseconds
+		time_ = nanoseconds((ticks / speed_) * 1000000000 + (ticks % speed_) * 1000000000 / speed_);
+		epoch_ = steady_clock::now() - time_;
+		ticks_ = ticks;
+		tickCount_ = 0;
+		cpuEpoch_ = nanoseconds(-1);
+		telemetry_ = {};
 	}
 } // namespace MachEmu
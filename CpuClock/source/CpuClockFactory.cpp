@@ -22,12 +22,18 @@ SOFTWARE.
 
 #include "CpuClock/CpuClock.h"
 #include "CpuClock/CpuClockFactory.h"
+#include "CpuClock/VirtualCpuClock.h"
 
 namespace MachEmu
 {
 	//factory free form function
-	std::unique_ptr<ICpuClock> MakeCpuClock(uint64_t speed)
+	std::unique_ptr<ICpuClock> MakeCpuClock(uint64_t speed, TimeSource timeSource, std::chrono::nanoseconds spinLimit)
 	{
-		return std::make_unique<CpuClock>(speed);
+		if (timeSource == TimeSource::Virtual)
+		{
+			return std::make_unique<VirtualCpuClock>(speed);
+		}
+
+		return std::make_unique<CpuClock>(speed, spinLimit);
 	}
 } // namespace MachEmu
\ No newline at end of file
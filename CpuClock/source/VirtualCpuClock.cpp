@@ -0,0 +1,62 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "CpuClock/VirtualCpuClock.h"
+
+using namespace std::chrono;
+
+namespace MachEmu
+{
+	VirtualCpuClock::VirtualCpuClock(uint64_t speed) :
+		speed_(speed)
+	{
+
+	}
+
+	ErrorCode VirtualCpuClock::SetTickResolution(nanoseconds resolution, int64_t* resolutionInTicks)
+	{
+		if (resolutionInTicks != nullptr)
+		{
+			// split into whole seconds so the tick count can't overflow when converting from nanoseconds
+			*resolutionInTicks = resolution >= nanoseconds::zero() ? duration_cast<seconds>(resolution).count() * speed_ + (resolution % seconds(1)).count() * speed_ / 1000000000 : -1;
+		}
+
+		return ErrorCode::NoError;
+	}
+
+	const ClockTelemetry& VirtualCpuClock::Telemetry() const
+	{
+		return telemetry_;
+	}
+
+	nanoseconds VirtualCpuClock::Tick(uint64_t ticks)
+	{
+		ticks_ += ticks;
+		// split into whole seconds so the tick count can't overflow when converting to nanoseconds
+		return nanoseconds((ticks_ / speed_) * 1000000000 + (ticks_ % speed_) * 1000000000 / speed_);
+	}
+
+	void VirtualCpuClock::Reset(uint64_t ticks)
+	{
+		ticks_ = ticks;
+	}
+} // namespace MachEmu
@@ -23,8 +23,10 @@ SOFTWARE.
 #ifndef IMACHINE_H
 #define IMACHINE_H
 
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include "Controller/IController.h"
 
@@ -124,6 +126,37 @@ namespace MachEmu
 		*/
 		virtual uint64_t Run(uint16_t pc = 0x00) = 0;
 
+		/** Run the machine for a number of cycles
+
+			Synchronously run the machine until the cycle budget has been consumed or the
+			io controller generates an ISR::Quit interrupt. The machine retains its state
+			between calls, so a long running program can be executed as a series of batches.
+
+			@param	cycles				The number of cpu cycles to execute. The budget may be
+										exceeded by the cycles of a single instruction.
+
+			@param	pc					The program counter at which the cpu will start executing
+										instructions. It is only used when the machine is powered on,
+										that is, on the first call or the first call after an ISR::Quit.
+
+			@param	quit				Optional storage which is set to true when the machine quit
+										(ISR::Quit) during this call, false otherwise.
+
+			@return						The number of cpu cycles that were executed.
+
+			@throws						std::runtime_error if no memory or io controller has been set on
+										this machine or if the machine is currently running via Run.
+
+			@remark						Between interrupt service periods (see the `isrFreq` and
+										`clockResolution` configuration options) the cpu executes
+										instructions in a tight loop, only returning to the machine
+										when an io access or halt requires it. An `isrFreq` of 0 services
+										interrupts after every instruction and gains no benefit.
+
+			@since	version 1.7.0
+		*/
+		virtual int64_t RunFor(int64_t cycles, uint16_t pc = 0x00, bool* quit = nullptr) = 0;
+
 		/** Wait for the machine to finish running
 
 			Block the current thread until the machine execution loop has completed.
@@ -165,6 +198,33 @@ namespace MachEmu
 		*/
 		virtual void SetIoController (const std::shared_ptr<IController>& controller) = 0;
 
+		/** Add an io device
+
+			Routes the reads and writes of a range of io ports to an io device instead of the io controller.
+			The ports are looked up in a 256 entry dispatch table so each access costs a single call to the
+			owning device.
+
+			@param	controller	The io device, it can claim several port ranges by calling this method for each range.
+			@param	firstPort	The first port of the range claimed by the device.
+			@param	lastPort	The last port (inclusive) of the range claimed by the device.
+
+			@throws				std::invalid_argument when the controller is nullptr, the range is empty or any port in the
+								range has already been claimed by another device.
+
+			@throws				std::runtime_error when the machine is currently running.
+
+			@remark				The ports which no device claims are routed to the io controller set via SetIoController,
+								which remains mandatory.
+
+			@remark				ServiceInterrupts is called on each device (in the order they were added) after the io controller
+								every isrFreq clock resolutions, the devices never schedule their interrupts (see IController::Schedule).
+								The cpu interrupts returned are held pending until the cpu accepts them, the lowest numbered
+								pending interrupt has the highest priority and one interrupt is delivered per service of interrupts.
+
+			@since	version 1.7.0
+		*/
+		virtual void AddIoController(const std::shared_ptr<IController>& controller, uint8_t firstPort, uint8_t lastPort) = 0;
+
 		/** Set machine options
 
 			@param		options		A json string specifying the desired options to update. Passing in an options string of nullptr will set all options
@@ -179,7 +239,7 @@ namespace MachEmu
 
 			@throws					std::invalid_argument when any option value is illegal.
 
-			@remark					The `cpu` configuration option can only be set via the factory machine constructor.
+			@remark					The `cpu` and `dispatcher` configuration options can only be set via the factory machine constructor.
 
 			@see					MakeMachine for supported configuration options.
 		*/
@@ -243,6 +303,68 @@ namespace MachEmu
 		*/
 		virtual void OnSave(std::function<void(const char* json)>&& onSave) = 0;
 
+		/** Machine binary save state completion handler
+
+			Registers a method which will be called when the ISR::Save interrupt is triggered. The registered
+			method accepts a std::span which is the machine save state in a versioned binary format, no text
+			encoding is performed. All multi-byte values are little endian.
+
+			<table>
+			<tr><td>Offset</td><td>Size</td><td>Description</td></tr>
+			<tr><td>0</td><td>4</td><td>The magic bytes 'M' 'E' 'M' 'U'</td></tr>
+			<tr><td>4</td><td>2</td><td>The format version, currently 1</td></tr>
+			<tr><td>6</td><td>2</td><td>Flags: bit 0 is set for a delta save state, the remaining bits are reserved</td></tr>
+			<tr><td>8</td><td>16</td><td>The unique identifier of the memory controller</td></tr>
+			<tr><td>24</td><td>16</td><td>The MD5 hash of the rom</td></tr>
+			<tr><td>40</td><td>2</td><td>The size of the cpu state (n)</td></tr>
+			<tr><td>42</td><td>n</td><td>The cpu state: the unique identifier of the cpu (16 bytes) followed by the registers as laid out by GetState</td></tr>
+			<tr><td>42 + n</td><td>1</td><td>The ram compressor: 0 - none, 1 - zlib</td></tr>
+			<tr><td>43 + n</td><td>4</td><td>The size of the uncompressed ram</td></tr>
+			<tr><td>47 + n</td><td>4</td><td>The size of the (compressed) ram bytes (m)</td></tr>
+			<tr><td>51 + n</td><td>m</td><td>The (compressed) ram bytes, the ram blocks are concatenated in the order given by the ram option</td></tr>
+			</table>
+
+			When the deltaSaves config option is non zero each full save state is followed by up to deltaSaves
+			delta save states. A delta save state only carries the 256 byte ram pages written to by the cpu since
+			the previous save state, the ram section (starting at 42 + n above) is preceded by:
+
+			<table>
+			<tr><td>Offset</td><td>Size</td><td>Description</td></tr>
+			<tr><td>42 + n</td><td>4</td><td>The delta sequence number, 1 for the first delta after a full save state</td></tr>
+			<tr><td>46 + n</td><td>32</td><td>The dirty page bitmap, bit (page % 8) of byte (page / 8) is set when the page is carried</td></tr>
+			</table>
+
+			and the ram bytes only contain the parts of the ram blocks that lie within the dirty pages.
+
+			@param	onSave				The method to call with the binary machine save state after it has has been
+										generated via the ISR::Save interrupt. The span is only valid for the duration of
+										the call. Replaces any previously registered OnSave handler.
+
+			@throws						std::runtime_error if the machine is currently running.
+
+			@remark						The ram is compressed using the compressor config option, the encoder option is ignored.
+
+			@remark						Memory written directly by the controllers (not via the cpu) is not tracked by delta
+										save states. The first save state after Run or a load is always a full save state.
+
+			@remark						The function parameter onSave will be called from a different thread from which this
+										method was called if the runAsync or saveAsync config options have been specified.
+
+			@remark						Save requests are not queued. When a save is in progress, additional save interrupts
+										will be ignored.
+
+			@since	version 1.7.0
+		*/
+		virtual void OnSave(std::function<void(std::span<const uint8_t> state)>&& onSave) = 0;
+
+		/** Clear the machine save state completion handler
+
+			@throws						std::runtime_error if the machine is currently running.
+
+			@since	version 1.7.0
+		*/
+		void OnSave(std::nullptr_t) { OnSave(std::function<void(const char* json)>{}); }
+
 		/** Machine load state initiation handler
 		
 			Registers a method that will be called when the ISR::Load interrupt is triggered. The register
@@ -274,6 +396,75 @@ namespace MachEmu
 		*/
 		virtual void OnLoad(std::function<const char*()>&& onLoad) = 0;
 
+		/** Machine binary load state initiation handler
+
+			Registers a method that will be called when the ISR::Load interrupt is triggered. The registered
+			method returns a std::span which is the binary machine state to load as passed to the binary
+			OnSave handler. To load a delta save state return the concatenation of the full save state it
+			applies to followed by all the deltas up to and including it, in order.
+
+			@param	onLoad				The method to call to get the binary machine state to load when the ISR::Load
+										interrupt is triggered. The returned span must remain valid until the load completes.
+										Replaces any previously registered OnLoad handler.
+
+			@throws						std::runtime_error if machine is currently running.
+
+			@remark						The binary state fails to load for the same reasons as the json state along with an
+										unsupported format version or a broken chain of delta save states, the state of the
+										machine shall remain unchanged.
+
+			@since	version 1.7.0
+		*/
+		virtual void OnLoad(std::function<std::span<const uint8_t>()>&& onLoad) = 0;
+
+		/** Machine recording completion handler
+
+			Registers a method which will be called with a recording of the run when the machine powers off (ISR::Quit).
+			The recording holds every value read from the io ports and every interrupt delivered to the cpu keyed by
+			cycle count in a compact binary log which can be passed to Replay to reproduce the run exactly.
+
+			@param	onRecord			The method to call with the recording, the span is only valid for the duration of the call.
+										Replaces any previously registered OnRecord handler, nullptr stops recording.
+
+			@throws						std::runtime_error if machine is currently running.
+
+			@remark						The recording starts when the machine is powered on via Run or RunFor, the state loaded
+										by an ISR::Load interrupt and the values read from memory mapped io are not recorded.
+
+			@since	version 1.7.0
+		*/
+		virtual void OnRecord(std::function<void(std::span<const uint8_t> log)>&& onRecord) = 0;
+
+		/** Replay a recording
+
+			Reproduces a recorded run without calling the io controllers, the values read from the io ports and the
+			interrupts delivered to the cpu are fed back from the recording at the cycle counts they were recorded at,
+			so the replay runs as fast as the cpu can execute (when the clockResolution option is -1).
+
+			@param	log					The recording passed to the OnRecord handler, an empty log stops replaying. The
+										log is copied.
+
+			@throws						std::invalid_argument if the log is not a valid recording.
+
+			@throws						std::runtime_error if machine is currently running.
+
+			@remark						The memory controller must hold the same memory as it did when the recording started and
+										the options must be the same (apart from the clock, clockResolution and dispatcher
+										options). An io controller is not required, Run and RunFor throw std::runtime_error when the
+										run diverges from the recording.
+
+			@since	version 1.7.0
+		*/
+		virtual void Replay(std::span<const uint8_t> log) = 0;
+
+		/** Clear the machine load state initiation handler
+
+			@throws						std::runtime_error if machine is currently running.
+
+			@since	version 1.7.0
+		*/
+		void OnLoad(std::nullptr_t) { OnLoad(std::function<const char*()>{}); }
+
 		/** Save the state of the machine.
 
 			Returns the state of the machine as a JSON string.
@@ -353,6 +544,139 @@ namespace MachEmu
 		*/
 		[[deprecated("Will be removed in v2.0.0, please use OnSave")]] virtual std::unique_ptr<uint8_t[]> GetState(int* size = nullptr) const = 0;
 
+		/** Get the performance counters
+
+			Query the counters accumulated since the machine was last powered on via Run or RunFor.
+
+			@return				A json string containing the following counters:
+
+			<table>
+			<tr><td>Key</td><td>Description</td></tr>
+			<tr><td>cpu.instructions</td><td>An array of 256 execution counts, one per opcode</td></tr>
+			<tr><td>cpu.cycles</td><td>An array of 256 cycle totals, one per opcode</td></tr>
+			<tr><td>cpu.memoryReads</td><td>The number of memory reads, including instruction fetches</td></tr>
+			<tr><td>cpu.memoryWrites</td><td>The number of memory writes</td></tr>
+			<tr><td>cpu.ioReads</td><td>An array of 256 read counts, one per io port</td></tr>
+			<tr><td>cpu.ioWrites</td><td>An array of 256 write counts, one per io port</td></tr>
+			<tr><td>cpu.compiledBlocks</td><td>The number of blocks executed as native code by the jit and aot dispatchers</td></tr>
+			<tr><td>interrupts.cpu</td><td>An array of 8 counts, one per cpu level interrupt (ISR::Zero to ISR::Seven)</td></tr>
+			<tr><td>interrupts.save, interrupts.load, interrupts.quit</td><td>The number of machine level interrupts</td></tr>
+			<tr><td>serviceInterrupts.calls</td><td>The number of calls made to the io controller ServiceInterrupts method</td></tr>
+			<tr><td>serviceInterrupts.nanoseconds</td><td>The wall time spent servicing interrupts</td></tr>
+			<tr><td>idle.cycles</td><td>The cycles skipped while the cpu was halted or spinning until the next interrupt, see IController::NextInterrupt</td></tr>
+			<tr><td>clock.nanoseconds</td><td>The wall time spent in the cpu clock, including time spent synchronising to the clock resolution</td></tr>
+			</table>
+
+			@throws				std::runtime_error if the machine is currently running or the library was built
+								without performance counters.
+
+			@remark				Performance counters are compiled out by default so they cost nothing, they
+								are enabled via the cmake cache variable `enablePerfCounters` or the conan
+								option `with_perf_counters`.
+
+			@since	version 1.7.0
+		*/
+		virtual std::string GetPerfCounters() const = 0;
+
+		/** Get the clock telemetry
+
+			Query the clock pacing statistics accumulated since the machine was last powered on via Run or RunFor.
+			The clock paces the machine when the clock option is "host" and the clock resolution is not negative,
+			each resolution slice sleeps until its absolute deadline and then spins for at most the clockSpin option.
+
+			@return				A json string containing the following statistics:
+
+			<table>
+			<tr><td>Key</td><td>Description</td></tr>
+			<tr><td>slices</td><td>The number of resolution slices paced</td></tr>
+			<tr><td>overshoot</td><td>An array of 16 counts, a log2 microsecond histogram of how late each slice completed: &lt;1us, 1-2us, 2-4us ... &gt;=16384us</td></tr>
+			<tr><td>undershoot</td><td>An array of 16 counts, a log2 microsecond histogram of how early each slice completed</td></tr>
+			<tr><td>drift</td><td>The host time minus the emulated time in nanoseconds at the end of the last slice</td></tr>
+			<tr><td>cpuTime</td><td>The host cpu time in nanoseconds consumed by the thread running the machine</td></tr>
+			</table>
+
+			@throws				std::runtime_error if the machine is currently running.
+
+			@since	version 1.7.0
+		*/
+		virtual std::string GetClockTelemetry() const = 0;
+
+		/** Clone the machine
+
+			Create an independent machine with the same options, completion handlers, cpu, clock and memory state,
+			including the interrupts its io controller has scheduled and the recording made so far (see OnRecord),
+			forking a machine which is paused between calls to RunFor is an inexpensive way to explore several
+			branches of execution from the same starting point.
+
+			@return				The cloned machine, when this machine has been powered on (via RunFor) the clone resumes
+								execution where this machine left off when RunFor is called on it, otherwise it must
+								be powered on as usual.
+
+			@throws				std::runtime_error if the machine is currently running, no memory or io controller
+								has been set or any of the controllers doesn't support cloning (see IController::Clone).
+
+			@remark				The memory, io and any additional io controllers of the clone are clones of the
+								controllers of this machine, it's up to the memory controller how it duplicates its memory.
+
+			@since	version 1.7.0
+		*/
+		virtual std::unique_ptr<IMachine> Clone() const = 0;
+
+		/** Snapshot the machine
+
+			Capture the cpu, clock, machine loop and memory state of a machine which is paused between calls to RunFor
+			so Restore can rewind it, a snapshot is held in memory and is not encoded like a save state.
+
+			@throws				std::runtime_error if the machine is currently running or has not been powered on via RunFor.
+
+			@remark				The memory is read via the memory controller (directly when it supports direct memory access),
+								the state of the io controllers is not captured.
+
+			@see				Restore
+
+			@since	version 1.7.0
+		*/
+		virtual void Snapshot() = 0;
+
+		/** Restore the machine
+
+			Rewind the machine to the last Snapshot, only the memory pages which have been written to since the
+			snapshot (or the previous restore) are copied back. A machine which has powered off (ISR::Quit) since the
+			snapshot is powered on again, resuming where the snapshot left off at the next call to RunFor.
+
+			@throws				std::runtime_error if the machine is currently running or no snapshot has been taken.
+
+			@remark				Restore is intended to be called at a high rate (a fuzzing harness running a guest program
+								in persistent mode for example), it doesn't allocate or parse the machine options. The io
+								controllers are responsible for rewinding their own state, an io controller which schedules
+								its interrupts is passed the emptied scheduler again via IController::Schedule. The next
+								delta save state is a full save state and the coverage counters are cleared.
+
+			@see				Snapshot
+
+			@since	version 1.7.0
+		*/
+		virtual void Restore() = 0;
+
+		/** Get the branch coverage
+
+			The 8 bit saturating counters of the taken branch edges (jump, call and return instructions) executed by
+			the cpu since the machine was powered on or last restored. Each edge is hashed AFL style to the counter
+			at index (from >> 1) ^ to where from and to are the addresses of the branch instruction and its target.
+
+			@return				A view of the 65536 counters, it remains valid until the machine is destroyed.
+
+			@throws				std::runtime_error if the machine is currently running or the library was built
+								without branch coverage.
+
+			@remark				Branch coverage is compiled out by default so it costs nothing, it is enabled
+								via the cmake cache variable `enableCoverage` or the conan option `with_fuzzer`.
+								The jit dispatcher doesn't translate any instructions inline when it is enabled.
+
+			@since	version 1.7.0
+		*/
+		virtual std::span<const uint8_t> GetCoverage() const = 0;
+
 		/** Destruct the machine
 
 			Release all resources used by this machine instance.
@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef IMACHINE_FARM_H
+#define IMACHINE_FARM_H
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "Machine/IMachine.h"
+
+namespace MachEmu
+{
+	/** Machine farm interface
+
+		Runs many independent machines on a fixed pool of worker threads. Each machine is
+		executed in time slices measured in emulated cpu cycles (see IMachine::RunFor), after
+		which it is placed back on the queue of the worker that ran it. Idle workers steal
+		machines from the queues of busy workers.
+
+		@code{.cpp}
+
+		// Create a farm with one worker per hardware thread
+		auto farm = MakeMachineFarm();
+		std::vector<std::future<int64_t>> futures;
+
+		for (auto& machine : machines)
+		{
+			// The memory and io controllers must have been set
+			futures.push_back(farm->Run(machine, 0x100));
+		}
+
+		for (auto& future : futures)
+		{
+			// The total number of cycles the machine executed before it quit
+			auto cycles = future.get();
+		}
+
+		// {"machines":1000,"completed":1000,"cycles":...,"cyclesPerSecond":...}
+		std::cout << farm->Stats() << std::endl;
+
+		@endcode
+
+		@remark	A machine is only ever run by one worker at a time, however, successive time slices
+				may run on different workers. The controllers of a machine must not depend on being
+				called from a particular thread.
+
+		@since	version 1.7.0
+	*/
+	struct IMachineFarm
+	{
+		/** Run a machine on the farm
+
+			Schedule a machine to run until its io controller generates an ISR::Quit interrupt.
+
+			@param	machine		The machine to run. It must not be running and it must not be used
+								by the caller until the returned future is ready.
+
+			@param	pc			The program counter at which the machine will start executing instructions.
+
+			@return				A future which is set to the total number of cpu cycles that the machine executed
+								once it has quit, or to the exception thrown by the machine.
+
+			@throws				std::invalid_argument when the machine is nullptr.
+
+			@remark				The clock resolution of the machine should be disabled (the default), otherwise
+								the machine will sleep on, and block, the worker thread that is running it.
+		*/
+		virtual std::future<int64_t> Run(const std::shared_ptr<IMachine>& machine, uint16_t pc = 0x00) = 0;
+
+		/** Wait for all machines to complete
+
+			Block the current thread until every machine that has been passed to Run has quit.
+		*/
+		virtual void WaitForCompletion() = 0;
+
+		/** Aggregate throughput statistics
+
+			@return		A json string of the form:
+
+						@code{.json}
+						{
+							"threads":8,					// The number of worker threads
+							"machines":1000,				// The number of machines passed to Run
+							"completed":1000,				// The number of machines that have quit
+							"slices":52310,					// The number of time slices executed
+							"steals":1201,					// The number of time slices stolen by idle workers
+							"cycles":5231000000,			// The total number of cpu cycles executed
+							"seconds":3.2,					// The wall time since the first machine was run
+							"cyclesPerSecond":1634687500	// The aggregate emulated cycles per second
+						}
+						@endcode
+		*/
+		virtual std::string Stats() const = 0;
+
+		/** Destruct the farm
+
+			Stop the worker threads once their current time slice is complete. The futures of
+			machines which have not quit are abandoned (std::future_errc::broken_promise).
+		*/
+		virtual ~IMachineFarm() = default;
+	};
+} // namespace MachEmu
+
+#endif // IMACHINE_FARM_H
@@ -23,12 +23,19 @@ SOFTWARE.
 #ifndef MACHINE_H
 #define MACHINE_H
 
+#include <chrono>
 #include <future>
+#include <limits>
+#include <optional>
 
 #include "Controller/IController.h"
 #include "Cpu/ICpu.h"
 #include "CpuClock/ICpuClock.h"
 #include "Machine/IMachine.h"
+#include "Machine/Profiler.h"
+#include "Machine/Recorder.h"
+#include "Machine/Scheduler.h"
+#include "Machine/Tracer.h"
 #include "Opt/Opt.h"
 #include "SystemBus/SystemBus.h"
 
@@ -41,21 +48,151 @@ namespace MachEmu
 	struct Machine final : public IMachine
 	{
 	private:
+		// The binary save state magic bytes and format version, see IMachine::OnSave
+		static constexpr std::string_view binaryMagic_ = "MEMU";
+		static constexpr uint16_t binaryVersion_ = 1;
 		std::unique_ptr<ICpuClock> clock_;
 		std::unique_ptr<ICpu> cpu_;
 		std::shared_ptr<IController> memoryController_;
 		std::shared_ptr<IController> ioController_;
+		// The io devices in the order they were added and the index + 1 of the device which owns each port, 0 for the io controller
+		std::vector<std::shared_ptr<IController>> ioDevices_;
+		std::array<uint8_t, 256> portOwners_{};
+		// The port dispatch table built from portOwners_ when the machine powers on
+		std::array<IController*, 256> ioPorts_{};
 		SystemBus<uint16_t, uint8_t, 8> systemBus_;
 		Opt opt_;
 		//cppcheck-suppress unusedStructMember
 		int64_t ticksPerIsr_{};
+		// The number of ticks between clock synchronisations, -1 when the clock is not synchronised
+		//cppcheck-suppress unusedStructMember
+		int64_t ticksPerSync_{-1};
+		// Drains the cpu instruction trace to the trace option file, declared before fut_ so the
+		// execution loop has finished with it before it is destroyed
+		Tracer tracer_{ totalTicks_ };
 		std::future<int64_t> fut_;
 		//cppcheck-suppress unusedStructMember
 		bool running_{};
-		std::function<const char*()> onLoad_{};
+		// Returns the json or binary machine state to load
+		std::function<std::string()> onLoad_{};
 		std::function<void(const char* json)> onSave_{};
+		std::function<void(std::span<const uint8_t> state)> onSaveBinary_{};
+		// The binary save state, it is reused across saves and handed to onSaveBinary_ without a copy
+		std::vector<uint8_t> saveState_;
+		// The machine state captured on the emulation thread by ISR::Save, it is encoded by the save future
+		struct
+		{
+			std::string cpu;
+			std::array<uint8_t, 16> memUuid{};
+			std::array<uint8_t, 16> romMd5{};
+			std::vector<uint8_t> ram;
+			std::string encoder;
+			std::string compressor;
+		} saveCapture_;
+		// The sequence number of the next binary delta save state, 0 when the next save must be a full save state
+		//cppcheck-suppress unusedStructMember
+		uint32_t deltaSequence_{};
+		// The rom digest, computed (or supplied by the memory controller) when the machine starts running
+		// and reused by all saves and loads until the memory controller or the rom option changes
+		std::optional<std::array<uint8_t, 16>> romMd5_;
+
+		// The state of the machine loop, it persists across calls to RunFor
+		std::chrono::nanoseconds currTime_{};
+		//cppcheck-suppress unusedStructMember
+		int64_t totalTicks_{};
+		//cppcheck-suppress unusedStructMember
+		int64_t lastTicks_{};
+		std::future<std::string> loadFut_;
+		std::future<std::string> saveFut_;
+		//cppcheck-suppress unusedStructMember
+		bool poweredOn_{};
+		// The interrupts scheduled by the io controller, only used when scheduled_ is true
+		Scheduler scheduler_{ totalTicks_, currTime_ };
+		//cppcheck-suppress unusedStructMember
+		bool scheduled_{};
+		// Records (when onRecord_ is set) or replays the io reads and the interrupts, the cpu reads and writes
+		// the io ports via the recorder when recording_ or replaying_ is true
+		Recorder recorder_;
+		std::array<IController*, 256> recorderPorts_{};
+		std::function<void(std::span<const uint8_t> log)> onRecord_{};
+		//cppcheck-suppress unusedStructMember
+		bool recording_{};
+		//cppcheck-suppress unusedStructMember
+		bool replaying_{};
+		// Samples the cpu call stack every sampleInterval_ cycles when the profile option is set, nextSample_ is
+		// the cycle count of the next sample, the maximum int64_t when the machine isn't being profiled
+		Profiler profiler_;
+		std::vector<uint16_t> callStack_;
+		//cppcheck-suppress unusedStructMember
+		int64_t nextSample_{ std::numeric_limits<int64_t>::max() };
+		//cppcheck-suppress unusedStructMember
+		int64_t sampleInterval_{};
+		// The cpu interrupts which have been serviced but not yet accepted by the cpu, bit n for ISR n
+		//cppcheck-suppress unusedStructMember
+		uint8_t pendingIsrs_{};
+		// The memory and the machine loop state captured by Snapshot, the cpu holds its own snapshot
+		struct
+		{
+			std::vector<uint8_t> memory;
+			std::chrono::nanoseconds currTime{};
+			int64_t totalTicks{};
+			int64_t lastTicks{};
+			uint8_t pendingIsrs{};
+			// The pages written to since the snapshot, the save states drain the cpu dirty pages too
+			std::array<bool, 256> dirtyPages{};
+		} snapshot_;
+
+		// The machine performance counters, only maintained when perfCounters is true
+		struct
+		{
+			std::array<uint64_t, 8> cpuInterrupts{};
+			uint64_t saveInterrupts{};
+			uint64_t loadInterrupts{};
+			uint64_t quitInterrupts{};
+			uint64_t serviceCalls{};
+			uint64_t idleCycles{};
+			std::chrono::nanoseconds serviceTime{};
+			std::chrono::nanoseconds clockTime{};
+		} counters_;
 
-		void ProcessControllers(const SystemBus<uint16_t, uint8_t, 8>&& systemBus);
+		// Create the cpu clock from the clock, clockSpin and cpuFrequency options
+		void MakeClock();
+		// Reset the cpu, clock and machine loop state ready for execution to begin at pc
+		void PowerOn(uint16_t pc);
+		// Stop the trace and write the profile (when enabled) once the io controller has powered off the machine
+		void PowerOff();
+		// Sample the cpu call stack, weighed by the number of sample intervals since the last sample
+		void SampleProfile();
+		// Build the io port dispatch table and wire it along with the memory controller into the cpu
+		void WireControllers();
+		// Execute until the cycle budget has been consumed or the machine powers off (ISR::Quit)
+		int64_t Execute(int64_t cycleBudget);
+		// Execute until the cycle budget has been consumed or the recording powers off, replaying each recorded event at its cycle count
+		int64_t ExecuteReplay(int64_t cycleBudget);
+		// The cycles an idle cpu can skip, up to the first service of interrupts at or after the io controller's next interrupt
+		int64_t IdleTicks(int64_t maxTicks) const;
+		// Service the io controller interrupts (when they are due if the io controller schedules its interrupts)
+		void ServiceInterrupts();
+		void ServiceInterrupt(ISR isr);
+		void LoadMachineState(std::string&& str);
+		// Drain the cpu dirty pages, they are also accumulated for Restore
+		std::array<bool, 256> DirtyPages();
+		// Copy the cpu state and the (dirty) ram to saveCapture_, along with the binary header to saveState_
+		void CaptureSaveState(const std::array<uint8_t, 16>& memUuid);
+		// Compress and/or encode the captured ram and complete the binary (saveState_) or json save state, see IMachine::OnSave
+		void EncodeBinaryState();
+		std::string EncodeJsonState() const;
+		void LoadBinaryState(std::span<const uint8_t> state);
+		// Throws when the memory controller uuid or the rom md5 do not match those of the machine
+		void CheckMemoryState(std::span<const uint8_t> memUuid, std::span<const uint8_t> romMd5);
+		// The memory controller supplied rom digest, or the md5 of the rom read from the memory controller
+		std::array<uint8_t, 16> ComputeRomMd5() const;
+		// Read/write memory blocks directly from/to the memory controller backing store where the page access allows it
+		void ReadMemory(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, std::vector<uint8_t>& mem) const;
+		void WriteMemory(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, const uint8_t* mem);
+		// Split the memory blocks into the (merged) 256 byte page aligned chunks whose pages are dirty
+		static std::vector<std::pair<uint16_t, uint16_t>> DirtyBlocks(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, const std::array<bool, 256>& dirtyPages);
+		static std::string CheckHandler(std::future<std::string>& fut);
 	public:
 		Machine(const char* json);
 		~Machine() = default;
@@ -66,6 +203,12 @@ namespace MachEmu
 		*/
 		uint64_t Run(uint16_t pc) final;
 
+		/** RunFor
+
+			@see IMachine::RunFor
+		*/
+		int64_t RunFor(int64_t cycles, uint16_t pc, bool* quit) final;
+
 		/** WaitForCompletion
 
 			@see IMachine::WaitForCompletion
@@ -84,6 +227,12 @@ namespace MachEmu
 		*/
 		void SetIoController(const std::shared_ptr<IController>& controller) final;
 
+		/** AddIoController
+
+			@see IMachine::AddIoController
+		*/
+		void AddIoController(const std::shared_ptr<IController>& controller, uint8_t firstPort, uint8_t lastPort) final;
+
 		/** SetOptions
 
 			@see IMachine::SetOpts
@@ -96,12 +245,36 @@ namespace MachEmu
 		*/
 		void OnLoad(std::function<const char*()>&& onLoad) final;
 
+		/** OnLoad
+
+			@see IMachine::OnLoad
+		*/
+		void OnLoad(std::function<std::span<const uint8_t>()>&& onLoad) final;
+
 		/** OnSave
 
 			@see IMachine::OnSave
 		*/
 		void OnSave(std::function<void(const char* json)>&& onSave) final;
 
+		/** OnSave
+
+			@see IMachine::OnSave
+		*/
+		void OnSave(std::function<void(std::span<const uint8_t> state)>&& onSave) final;
+
+		/** OnRecord
+
+			@see IMachine::OnRecord
+		*/
+		void OnRecord(std::function<void(std::span<const uint8_t> log)>&& onRecord) final;
+
+		/** Replay
+
+			@see IMachine::Replay
+		*/
+		void Replay(std::span<const uint8_t> log) final;
+
 		/** Get the machine state
 
 			@see IMachine::GetState
@@ -119,6 +292,42 @@ namespace MachEmu
 			@see IMachine::GetCpuState
 		*/
 		std::unique_ptr<uint8_t[]> GetState(int* size) const final;
+
+		/** GetPerfCounters
+
+			@see IMachine::GetPerfCounters
+		*/
+		std::string GetPerfCounters() const final;
+
+		/** GetClockTelemetry
+
+			@see IMachine::GetClockTelemetry
+		*/
+		std::string GetClockTelemetry() const final;
+
+		/** Clone
+
+			@see IMachine::Clone
+		*/
+		std::unique_ptr<IMachine> Clone() const final;
+
+		/** Snapshot
+
+			@see IMachine::Snapshot
+		*/
+		void Snapshot() final;
+
+		/** Restore
+
+			@see IMachine::Restore
+		*/
+		void Restore() final;
+
+		/** GetCoverage
+
+			@see IMachine::GetCoverage
+		*/
+		std::span<const uint8_t> GetCoverage() const final;
 	};
 } // namespace MachEmu
 
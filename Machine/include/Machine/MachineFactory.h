@@ -25,6 +25,7 @@ SOFTWARE.
 
 #include <memory>
 #include "IMachine.h"
+#include "IMachineFarm.h"
 
 #ifdef _WINDOWS
 #ifdef mach_emu_EXPORTS
@@ -91,19 +92,35 @@ namespace MachEmu
 
 							| Option          | Type   | Value	            | Remarks                                                                            |
 							|:----------------|:-------|:-------------------|:-----------------------------------------------------------------------------------|
+							| clock           | string | "host" (default)   | The machine clock is driven by the host steady clock                               |
+							|                 |        | "virtual"          | The machine time is derived from the elapsed cpu cycles, the host clock is never read and `clockResolution` does not slow the machine down, runs are fully reproducible |
 							| clockResolution | int64  | -1 (default)       | Run the machine as fast as possible with the highest possible resolution           |
 							|                 |        | 0                  | Run the machine at realtime (or as close to) with the highest possible resolution  |
 							|                 |        | 0 - 1000000        | Will always spin the cpu to maintain the clock speed and is not recommended        |
 							|                 |        | n                  | A request in nanoseconds as to how frequently the machine clock will tick          |
+							| clockSpin       | int64  | 50000 (default)    | The maximum nanoseconds to spin at the end of each clock resolution slice, the clock sleeps until this long before each slice deadline |
 							| compressor      | string | "zlib" (default)   | Use zlib compression library to compress the ram when saving its state             |
 							|                 |        | "none"             | No compression will be used when saving the state of the ram                       |
 							| encoder         | string | "base64" (default) | The binary to text encoder to use when saving the machine state ram to json        |
 							| cpu             | string | "i8080" (default)  | A machine based on the Intel8080 cpu (can only be set via MachEmu::MakeMachine)    |
+							| dispatcher      | string | "switch" (default) | Decode instructions via a switch statement (can only be set via MakeMachine)       |
+							|                 |        | "threaded"         | Decode instructions via direct threaded code, requires GCC or Clang, falls back to "switch" otherwise |
+							|                 |        | "cached"           | Decode each basic block once and execute it from a cache, blocks are invalidated when their code is written to, only effective when the cpu runs for a cycle budget (isrFreq > 0 or RunFor) |
+							|                 |        | "jit"              | As "cached", hot blocks are translated to x86-64 host code, falls back to "cached" on other hosts or when executable memory is not available |
+							|                 |        | "aot"              | As "cached", blocks of the images recompiled ahead of time by the Recompiler (cmake option recompiledImages) are executed as native code when the memory holds the same code |
+							| cpuFrequency    | uint64 | 2000000 (default)  | The cpu clock speed in ticks per second, at most 10000000000                       |
+							| deltaSaves      | uint32 | 0 (default)        | Every binary save state is a full save state                                       |
+							|                 |        | n                  | Write n binary delta save states (dirty ram pages only) between full save states   |
 							| isrFreq         | double | 0 (default)        | Service interrupts at the completion of each instruction                           |
 							|                 |        | 1                  | Service interrupts after each clock tick                                           |
 							|                 |        | n                  | Service interrupts frequency, example: 0.5 - twice per clock tick                  |
 							| loadAsync       | bool   | true               | Run the load initiation handler on a separate thread                               |
 							|                 |        | false (default)    | Run the load initiation handler from the thread specified by the `runAsync` option |
+							| profile         | string | "" (default)       | The guest is not profiled                                                          |
+							|                 |        | path               | Sample the guest call stack while the machine runs, the collapsed stacks (for flamegraph tools) are written to path and the pc histogram to path.pcs when the machine powers off |
+							| profileInterval | int64  | 10000 (default)    | The cpu cycles between samples of the guest call stack                             |
+							| profileSymbols  | string | "" (default)       | The profile names functions by address                                             |
+							|                 |        | path               | The profile names functions by the symbols in the file at path, one "address name" per line |
 							| ramOffset       | uint16 | n (default: 0)     | The offset in bytes from the start of the memory to the start of the ram           |
 							| ramSize         | uint16 | n (default: 0)     | The size of the ram in bytes                                                       |
 							| romOffset		  | uint16 | n (default: 0)     | The offset in bytes from the start of the memory to the start of the rom           |
@@ -112,15 +129,33 @@ namespace MachEmu
 							|                 |        | false (default)    | `IMachine::Run` will run its execution loop on the current thread                  |
 							| saveAsync       | bool   | true               | Run the save completion handler on a separate thread                               |
 							|                 |        | false (default)    | Run the save completion handler from the thread specifed by the `runAsync` option  |
+							| trace           | string | "" (default)       | Instructions are not traced                                                        |
+							|                 |        | path               | Write a record of each instruction executed to the binary file at path while the machine runs, decode it with the TraceDecoder, only supported by the switch and cached dispatchers |
 
 
 		@throws		std::runtime_error or any exception that the underlying json parser can throw.
 
-		@throws		std::invalid_argument if any of the configuration options are invalid (negative isrFreq, unsupported cpu or clock resolution).
+		@throws		std::invalid_argument if any of the configuration options are invalid (negative isrFreq or deltaSaves, non positive profileInterval, cpuFrequency out of range, trace with a dispatcher other than switch or cached, unsupported cpu or clock resolution).
 		
 		@return		A unique machine pointer that can be loaded with memory and io controllers.
 	*/
 	DLL_EXP_IMP std::unique_ptr<IMachine> MakeMachine(const char* config = nullptr);
+
+	/** Create a machine farm
+
+		Build a farm which multiplexes many machines onto a fixed pool of worker threads.
+
+		@param		threads		The number of worker threads, 0 (default) will use one worker per hardware thread.
+
+		@param		timeSlice	The number of cpu cycles that a machine runs for before it yields its worker thread.
+
+		@throws		std::invalid_argument if the time slice is not greater than 0.
+
+		@return		A unique machine farm pointer that machines can be run on.
+
+		@since		version 1.7.0
+	*/
+	DLL_EXP_IMP std::unique_ptr<IMachineFarm> MakeMachineFarm(uint32_t threads = 0, int64_t timeSlice = 100000);
 } // namespace MachEmu
 
 #endif // MACHINE_FACTORY_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef MACHINE_FARM_H
+#define MACHINE_FARM_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Machine/IMachineFarm.h"
+
+namespace MachEmu
+{
+	/** MachineFarm
+
+		@see IMachineFarm.h
+	*/
+	class MachineFarm final : public IMachineFarm
+	{
+	private:
+		struct Task
+		{
+			std::shared_ptr<IMachine> machine;
+			uint16_t pc{};
+			//cppcheck-suppress unusedStructMember
+			int64_t cycles{};
+			std::promise<int64_t> promise;
+		};
+
+		// Each worker owns a queue, it takes work from the front and idle workers steal from the back
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<std::unique_ptr<Task>> tasks;
+			std::thread thread;
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+		//cppcheck-suppress unusedStructMember
+		int64_t timeSlice_{};
+
+		// Guards the counters used to put idle workers to sleep and to wait for completion
+		mutable std::mutex mutex_;
+		std::condition_variable cv_;
+		//cppcheck-suppress unusedStructMember
+		int64_t queued_{};
+		//cppcheck-suppress unusedStructMember
+		int64_t active_{};
+		//cppcheck-suppress unusedStructMember
+		bool stop_{};
+		std::chrono::steady_clock::time_point start_{};
+
+		std::atomic<uint32_t> next_{};
+		std::atomic<int64_t> machines_{};
+		std::atomic<int64_t> completed_{};
+		std::atomic<int64_t> slices_{};
+		std::atomic<int64_t> steals_{};
+		std::atomic<int64_t> cycles_{};
+
+		void Push(size_t worker, std::unique_ptr<Task>&& task);
+		std::unique_ptr<Task> Pop(size_t worker);
+		void Complete();
+		void WorkerLoop(size_t worker);
+	public:
+		MachineFarm(uint32_t threads, int64_t timeSlice);
+		~MachineFarm();
+
+		/** Run
+
+			@see IMachineFarm::Run
+		*/
+		std::future<int64_t> Run(const std::shared_ptr<IMachine>& machine, uint16_t pc) final;
+
+		/** WaitForCompletion
+
+			@see IMachineFarm::WaitForCompletion
+		*/
+		void WaitForCompletion() final;
+
+		/** Stats
+
+			@see IMachineFarm::Stats
+		*/
+		std::string Stats() const final;
+	};
+} // namespace MachEmu
+
+#endif // MACHINE_FARM_H
@@ -0,0 +1,71 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace MachEmu
+{
+	/** Profiler
+
+		Accumulates the guest call stacks sampled by the machine, see the profile option.
+
+		The samples are written as collapsed stacks, one line per distinct stack of the form
+		"entry;function;...;function;pc count" as read by flamegraph tools, along with a pc histogram
+		sorted by sample count. Addresses are named by the nearest symbol at or below them.
+	*/
+	class Profiler final
+	{
+	private:
+		// The symbol names keyed by address
+		std::map<uint16_t, std::string> symbols_;
+		// The samples keyed by call stack, the entry point, the functions entered and the pc
+		std::map<std::vector<uint16_t>, uint64_t> stacks_;
+		std::vector<uint64_t> pcs_;
+		//cppcheck-suppress unusedStructMember
+		uint64_t samples_{};
+		//cppcheck-suppress unusedStructMember
+		uint16_t entry_{};
+		std::vector<uint16_t> key_;
+
+		// Load the "address name" lines of a symbol file, throws std::runtime_error when it can't be opened and
+		// std::invalid_argument when a line is malformed
+		void LoadSymbols(const std::string& path);
+		// The symbol at addr, name+0xoffset when addr is past the start of a symbol, the address when there is no symbol
+		std::string Name(uint16_t addr) const;
+	public:
+		// Discard the samples of the last run, the machine starts executing at entry
+		void Start(uint16_t entry, const std::string& symbols);
+		// Count weight samples of the cpu call stack, see ICpu::CallStack
+		void Sample(std::span<const uint16_t> stack, uint64_t weight);
+		// Write the collapsed stacks to path and the pc histogram to path.pcs, throws std::runtime_error when they can't be written
+		void Write(const std::string& path) const;
+	};
+} // namespace MachEmu
+
+#endif // PROFILER_H
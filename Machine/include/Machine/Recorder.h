@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Controller/IController.h"
+
+namespace MachEmu
+{
+	/** Recorder
+
+		Records the values read from the io ports and the interrupts delivered to the cpu keyed
+		by cycle count, and replays them without the io controllers.
+
+		The log is a magic and version header followed by a sequence of records, each record is a
+		type byte followed by its payload: a read holds the port and the value read, the other records
+		hold the cycles elapsed since the previous (non read) record as an unsigned LEB128 followed by
+		the interrupt, the idle cycles skipped (LEB128) or nothing (quit).
+
+		@see IMachine::OnRecord
+	*/
+	class Recorder final : public IController
+	{
+	public:
+		enum class Type : uint8_t
+		{
+			Read,
+			Interrupt,
+			Idle,
+			Quit
+		};
+
+		// A record which is replayed by the machine loop
+		struct Event
+		{
+			int64_t cycles{};
+			Type type{};
+			uint64_t value{};
+		};
+	private:
+		static constexpr std::string_view magic_ = "MEMR";
+		static constexpr uint8_t version_ = 1;
+		// The controllers which own each port while recording
+		const std::array<IController*, 256>* ports_{};
+		std::vector<uint8_t> log_;
+		//cppcheck-suppress unusedStructMember
+		int64_t lastCycles_{};
+		// The parsed replay log
+		std::vector<Event> events_;
+		std::vector<std::pair<uint8_t, uint8_t>> reads_;
+		//cppcheck-suppress unusedStructMember
+		size_t nextEvent_{};
+		//cppcheck-suppress unusedStructMember
+		size_t nextRead_{};
+
+		void Append(Type type, int64_t cycles);
+		void AppendLeb128(uint64_t value);
+	public:
+		// Start a new recording, reads are forwarded to the owner of each port
+		void Record(const std::array<IController*, 256>* ports);
+		// Continue the recording made so far by another recorder (the machine being cloned)
+		void Record(const std::array<IController*, 256>* ports, const Recorder& recorder);
+		void RecordInterrupt(int64_t cycles, ISR isr);
+		void RecordIdle(int64_t cycles, int64_t ticks);
+		void RecordQuit(int64_t cycles);
+		std::span<const uint8_t> Log() const;
+
+		// Parse a recording, throws std::invalid_argument when the log is malformed
+		void Replay(std::span<const uint8_t> log);
+		// Restart the replay from the beginning of the log
+		void Rewind();
+		// The next event to replay, nullptr once the log is exhausted
+		const Event* NextEvent() const
+		{
+			return nextEvent_ < events_.size() ? &events_[nextEvent_] : nullptr;
+		}
+		void PopEvent() { nextEvent_++; }
+
+		/** Read
+
+			Records the value read from the port when recording, returns the next value read from the log when replaying.
+
+			@throws		std::runtime_error when the replay has diverged from the recording.
+		*/
+		uint8_t Read(uint16_t port) final;
+
+		/** Write
+
+			Forwards the write to the owner of the port when recording, discards it when replaying.
+		*/
+		void Write(uint16_t port, uint8_t value) final;
+
+		/** ServiceInterrupts
+
+			The interrupts are recorded and replayed by the machine, always returns ISR::NoInterrupt.
+		*/
+		ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final;
+	};
+} // namespace MachEmu
+
+#endif // RECORDER_H
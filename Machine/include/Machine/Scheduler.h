@@ -0,0 +1,114 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include "Controller/IController.h"
+
+namespace MachEmu
+{
+	/** Scheduler
+
+		A min-heap of the interrupts scheduled by the io controller, ordered by the
+		cycle count at which they are due.
+
+		@see IScheduler
+	*/
+	class Scheduler final : public IScheduler
+	{
+	private:
+		struct Event
+		{
+			int64_t cycles{};
+			// Services events which are due at the same cycle count in the order they were scheduled
+			uint64_t sequence{};
+			ISR isr{};
+
+			bool operator>(const Event& rhs) const
+			{
+				return cycles != rhs.cycles ? cycles > rhs.cycles : sequence > rhs.sequence;
+			}
+		};
+
+		std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+		//cppcheck-suppress unusedStructMember
+		uint64_t sequence_{};
+		std::atomic<bool> raised_{};
+		// The machine loop state used to convert a machine clock time to a cycle count
+		const int64_t& totalTicks_;
+		const std::chrono::nanoseconds& currTime_;
+		//cppcheck-suppress unusedStructMember
+		double ticksPerNs_{};
+	public:
+		Scheduler(const int64_t& totalTicks, const std::chrono::nanoseconds& currTime);
+
+		// Discard all scheduled and raised interrupts
+		void Reset(double cpuFrequency);
+
+		// Replace the scheduled and raised interrupts with those of another scheduler (the machine being cloned)
+		void Copy(const Scheduler& scheduler);
+
+		// The cycle count at which the next interrupt is due, the maximum int64_t value when none are scheduled
+		int64_t Next() const
+		{
+			return events_.empty() == true ? std::numeric_limits<int64_t>::max() : events_.top().cycles;
+		}
+
+		// Remove the next interrupt from the queue
+		ISR Pop();
+
+		// Check and clear the raised flag
+		bool Raised()
+		{
+			return raised_.load(std::memory_order_relaxed) == true && raised_.exchange(false, std::memory_order_acquire) == true;
+		}
+
+		/** ScheduleCycles
+
+			@see IScheduler::ScheduleCycles
+		*/
+		void ScheduleCycles(uint64_t cycles, ISR isr) final;
+
+		/** ScheduleTime
+
+			@see IScheduler::ScheduleTime
+		*/
+		void ScheduleTime(uint64_t time, ISR isr) final;
+
+		/** Raise
+
+			@see IScheduler::Raise
+		*/
+		void Raise() final;
+	};
+} // namespace MachEmu
+
+#endif // SCHEDULER_H
@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Cpu/TraceBuffer.h"
+
+namespace MachEmu
+{
+	/** Tracer
+
+		Drains the instruction records written by the cpu into the trace buffer to a binary file
+		on a background thread, see the trace option.
+
+		The file is a magic, version and record size header followed by the TraceRecords in the
+		order they were executed, decode it with the TraceDecoder.
+	*/
+	class Tracer final
+	{
+	private:
+		static constexpr std::string_view magic_ = "MEMT";
+		static constexpr uint16_t version_ = 1;
+		const int64_t& totalTicks_;
+		// Allocated by the first Start, machines which aren't traced don't pay for the ring
+		std::unique_ptr<TraceBuffer> buffer_;
+		std::ofstream file_;
+		std::thread thread_;
+		std::atomic<bool> stop_{};
+
+		// Write the records in the buffer to file_ until stop_ is set and the buffer is empty
+		void Drain();
+	public:
+		explicit Tracer(const int64_t& totalTicks) : totalTicks_(totalTicks) {}
+		~Tracer();
+
+		// Truncate the file at path and start draining the buffer to it, throws std::runtime_error when the file can't be opened
+		void Start(const std::string& path);
+		// Write out the records remaining in the buffer and close the file, the cpu must not be writing to the buffer
+		void Stop();
+		// The ring the cpu writes to, nullptr until the first Start
+		TraceBuffer* Buffer() { return buffer_.get(); }
+	};
+} // namespace MachEmu
+
+#endif // TRACER_H
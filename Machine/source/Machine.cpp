@@ -20,7 +20,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+#include <bit>
 #include <cinttypes>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
 #include <nlohmann/json.hpp>
 
 #include "CpuClock/CpuClockFactory.h"
@@ -47,10 +53,35 @@ namespace MachEmu
 			SetOptions(R"({"cpu":"i8080"})");
 		}
 
+		// if no dispatcher specified, set the default
+		if(opt_.Dispatcher().empty() == true)
+		{
+			SetOptions(R"({"dispatcher":"switch"})");
+		}
+
 		if(opt_.CpuType() == "i8080")
 		{
-			clock_ = MakeCpuClock(2000000);
-			cpu_ = Make8080(systemBus_, std::bind(&Machine::ProcessControllers, this, std::placeholders::_1));
+			MakeClock();
+			auto dispatcher = Dispatcher::Switch;
+
+			if (opt_.Dispatcher() == "threaded")
+			{
+				dispatcher = Dispatcher::Threaded;
+			}
+			else if (opt_.Dispatcher() == "cached")
+			{
+				dispatcher = Dispatcher::Cached;
+			}
+			else if (opt_.Dispatcher() == "jit")
+			{
+				dispatcher = Dispatcher::Jit;
+			}
+			else if (opt_.Dispatcher() == "aot")
+			{
+				dispatcher = Dispatcher::Aot;
+			}
+
+			cpu_ = Make8080(systemBus_, dispatcher);
 		}
 		else
 		{
@@ -65,7 +96,28 @@ namespace MachEmu
 			throw std::runtime_error("The machine is running");
 		}
 
-		return opt_.SetOptions(options);
+		auto rom = opt_.Rom();
+		auto clock = std::make_tuple(opt_.Clock(), opt_.ClockSpin(), opt_.CpuFrequency());
+		auto err = opt_.SetOptions(options);
+
+		if (opt_.Rom() != rom)
+		{
+			romMd5_.reset();
+		}
+
+		// The clock is created by the constructor once the cpu type is known
+		if (clock_ != nullptr && std::make_tuple(opt_.Clock(), opt_.ClockSpin(), opt_.CpuFrequency()) != clock)
+		{
+			MakeClock();
+		}
+
+		return err;
+	}
+
+	void Machine::MakeClock()
+	{
+		clock_ = MakeCpuClock(opt_.CpuFrequency(), opt_.Clock() == "virtual" ? TimeSource::Virtual : TimeSource::Host, nanoseconds(opt_.ClockSpin()));
+		SetClockResolution(opt_.ClockResolution());
 	}
 
 	ErrorCode Machine::SetClockResolution(int64_t clockResolution)
@@ -92,157 +144,749 @@ namespace MachEmu
 		if (err == ErrorCode::NoError)
 		{
 			ticksPerIsr_ = opt_.ISRFreq() * resInTicks;
+			ticksPerSync_ = resInTicks;
 		}
 
 		return err;
 	}
 
-	void Machine::ProcessControllers(const SystemBus<uint16_t, uint8_t, 8>&& systemBus)
+	void Machine::PowerOn(uint16_t pc)
+	{
+		if (memoryController_ == nullptr)
+		{
+			throw std::runtime_error ("No memory controller has been set");
+		}
+
+		if (ioController_ == nullptr && replaying_ == false)
+		{
+			throw std::runtime_error("No io controller has been set");
+		}
+
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		// Map the memory controller backing store (if any) directly into the cpu address space
+		std::array<PageAccess, 256> pageAccess;
+		pageAccess.fill(PageAccess::ReadWrite);
+		cpu_->SetMemory(memoryController_->Memory(pageAccess), pageAccess);
+		cpu_->Reset(pc);
+		clock_->Reset();
+
+		if (romMd5_.has_value() == false)
+		{
+			romMd5_ = ComputeRomMd5();
+		}
+
+		SetClockResolution(opt_.ClockResolution());
+		currTime_ = nanoseconds::zero();
+		totalTicks_ = 0;
+		lastTicks_ = 0;
+		deltaSequence_ = 0;
+		pendingIsrs_ = 0;
+
+		WireControllers();
+		scheduler_.Reset(opt_.CpuFrequency());
+		scheduled_ = replaying_ == false && ioController_->Schedule(&scheduler_);
+		recording_ = replaying_ == false && onRecord_ != nullptr;
+
+		// Route the io port accesses via the recorder
+		if (recording_ == true || replaying_ == true)
+		{
+			recorderPorts_.fill(&recorder_);
+			cpu_->SetControllers(memoryController_.get(), &recorderPorts_);
+
+			if (recording_ == true)
+			{
+				recorder_.Record(&ioPorts_);
+			}
+			else
+			{
+				recorder_.Rewind();
+			}
+		}
+
+		// Sample the call stack for the profile option until the machine powers off
+		if (opt_.Profile().empty() == false)
+		{
+			profiler_.Start(pc, opt_.ProfileSymbols());
+			cpu_->SetProfiling(true);
+			sampleInterval_ = opt_.ProfileInterval();
+			nextSample_ = sampleInterval_;
+		}
+		else
+		{
+			cpu_->SetProfiling(false);
+			nextSample_ = std::numeric_limits<int64_t>::max();
+		}
+
+		// Trace the instructions to the file named by the trace option until the machine powers off
+		if (opt_.Trace().empty() == false)
+		{
+			tracer_.Start(opt_.Trace());
+			cpu_->SetTrace(tracer_.Buffer());
+		}
+		else
+		{
+			tracer_.Stop();
+			cpu_->SetTrace(nullptr);
+		}
+
+		poweredOn_ = true;
+
+		if constexpr (perfCounters == true)
+		{
+			counters_ = {};
+		}
+	}
+
+	void Machine::WireControllers()
 	{
-		auto controlBus = systemBus.controlBus;
-		auto addressBus = systemBus.addressBus;
-		auto dataBus = systemBus.dataBus;
+		for (size_t port = 0; port < ioPorts_.size(); port++)
+		{
+			ioPorts_[port] = portOwners_[port] == 0 ? ioController_.get() : ioDevices_[portOwners_[port] - 1].get();
+		}
 
-		if (memoryController_ != nullptr)
+		// The cpu calls the owner of each port directly
+		cpu_->SetControllers(memoryController_.get(), &ioPorts_);
+	}
+
+	void Machine::LoadMachineState(std::string&& str)
+	{
+		if (str.empty() == false)
 		{
-			//check the control bus to see if there are any operations pending
-			if (controlBus->Receive(Signal::MemoryRead))
+			try
+			{
+				if (str.starts_with(binaryMagic_) == true)
+				{
+					LoadBinaryState(std::span(reinterpret_cast<const uint8_t*>(str.data()), str.size()));
+					deltaSequence_ = 0;
+					return;
+				}
+
+				// perform checks to make sure that this machine load state is compatible with this machine
+				auto json = nlohmann::json::parse(str);
+				// The memory controllers and the roms must be the same
+				CheckMemoryState(Utils::TxtToBin("base64", "none", 16, json["memory"]["uuid"].get<std::string>()),
+					Utils::TxtToBin("base64", "none", 16, json["memory"]["rom"].get<std::string>()));
+
+				// decode and decompress the ram
+				auto jsonRam = json["memory"]["ram"];
+				auto ram = Utils::TxtToBin(jsonRam["encoder"].get<std::string>(),
+					jsonRam["compressor"].get<std::string>(),
+					jsonRam["size"].get<uint32_t>(),
+					jsonRam["bytes"].get<std::string>());
+				
+				auto ramMetadata = opt_.Ram();
+				size_t ramSize = 0;
+
+				for (const auto& rm : ramMetadata)
+				{
+					ramSize += rm.second;
+				}
+
+				// Make sure the ram size matches the layout
+				if (ram.size() != ramSize)
+				{
+					throw std::runtime_error("Incompatible ram");
+				}
+
+				// Once all checks are complete, restore the cpu and the memory
+				cpu_->Load(json["cpu"].dump());
+				WriteMemory(ramMetadata, ram.data());
+				// The memory no longer matches the last save state, the next delta must have a full save state to apply to
+				deltaSequence_ = 0;
+			}
+			catch (const std::exception& e)
 			{
-				dataBus->Send(memoryController_->Read(addressBus->Receive()));
+				// log the exception - e.what()
+				printf("%s\n", e.what());
 			}
+		}
+	}
+
+	void Machine::CheckMemoryState(std::span<const uint8_t> memUuid, std::span<const uint8_t> romMd5)
+	{
+		auto uuid = memoryController_->Uuid();
+
+		if (uuid == std::array<uint8_t, 16>{})
+		{
+			throw std::runtime_error("Invalid memory controller uuid for load interrupt");
+		}
+
+		// The memory controllers must be the same
+		if (memUuid.size() != uuid.size() || std::equal(memUuid.begin(), memUuid.end(), uuid.begin()) == false)
+		{
+			throw std::runtime_error("Incompatible memory controller");
+		}
+
+		// The rom must be the same, the digest is cached when the machine starts running
+		const auto& md5 = romMd5_.value();
+
+		if (romMd5.size() != md5.size() || std::equal(romMd5.begin(), romMd5.end(), md5.begin()) == false)
+		{
+			throw std::runtime_error("Incompatible rom");
+		}
+	}
+
+	std::array<uint8_t, 16> Machine::ComputeRomMd5() const
+	{
+		auto md5 = memoryController_->RomMd5();
+
+		if (md5 == std::array<uint8_t, 16>{})
+		{
+			std::vector<uint8_t> rom;
+			ReadMemory(opt_.Rom(), rom);
+			md5 = Utils::Md5(rom.data(), rom.size());
+		}
+
+		return md5;
+	}
+
+	void Machine::ReadMemory(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, std::vector<uint8_t>& mem) const
+	{
+		std::array<PageAccess, 256> pageAccess;
+		pageAccess.fill(PageAccess::ReadWrite);
+		auto memory = memoryController_->Memory(pageAccess);
 
-			if (controlBus->Receive(Signal::MemoryWrite))
+		for (const auto& [offset, size] : blocks)
+		{
+			uint32_t end = offset + size;
+
+			// Copy a page at a time, trapped pages must be read via the controller
+			for (uint32_t addr = offset; addr < end;)
 			{
-				memoryController_->Write(addressBus->Receive(), dataBus->Receive());
+				auto pageEnd = std::min((addr | 0xFF) + 1, end);
+
+				if (memory != nullptr && pageAccess[addr >> 8] != PageAccess::Trap)
+				{
+					mem.insert(mem.end(), memory + addr, memory + pageEnd);
+					addr = pageEnd;
+				}
+				else
+				{
+					for (; addr < pageEnd; addr++)
+					{
+						mem.push_back(memoryController_->Read(addr));
+					}
+				}
 			}
 		}
+	}
 
-		if (ioController_ != nullptr)
+	void Machine::WriteMemory(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, const uint8_t* mem)
+	{
+		std::array<PageAccess, 256> pageAccess;
+		pageAccess.fill(PageAccess::ReadWrite);
+		auto memory = memoryController_->Memory(pageAccess);
+
+		for (const auto& [offset, size] : blocks)
 		{
-			if (controlBus->Receive(Signal::IoRead))
+			uint32_t end = offset + size;
+
+			// Copy a page at a time, read only and trapped pages must be written via the controller
+			for (uint32_t addr = offset; addr < end;)
 			{
-				dataBus->Send(ioController_->Read(addressBus->Receive()));
+				auto pageEnd = std::min((addr | 0xFF) + 1, end);
+
+				if (memory != nullptr && pageAccess[addr >> 8] == PageAccess::ReadWrite)
+				{
+					std::copy_n(mem, pageEnd - addr, memory + addr);
+					mem += pageEnd - addr;
+					addr = pageEnd;
+				}
+				else
+				{
+					for (; addr < pageEnd; addr++)
+					{
+						memoryController_->Write(addr, *mem++);
+					}
+				}
 			}
+		}
+	}
+
+	std::vector<std::pair<uint16_t, uint16_t>> Machine::DirtyBlocks(const std::vector<std::pair<uint16_t, uint16_t>>& blocks, const std::array<bool, 256>& dirtyPages)
+	{
+		std::vector<std::pair<uint16_t, uint16_t>> dirtyBlocks;
 
-			if (controlBus->Receive(Signal::IoWrite))
+		for (const auto& [offset, size] : blocks)
+		{
+			uint32_t end = offset + size;
+			// Only merge chunks from the same block so the chunk size can't overflow
+			bool merge = false;
+
+			for (uint32_t addr = offset; addr < end;)
 			{
-				ioController_->Write(addressBus->Receive(), dataBus->Receive());
+				auto pageEnd = std::min((addr | 0xFF) + 1, end);
+
+				if (dirtyPages[addr >> 8] == true)
+				{
+					if (merge == true)
+					{
+						dirtyBlocks.back().second += static_cast<uint16_t>(pageEnd - addr);
+					}
+					else
+					{
+						dirtyBlocks.emplace_back(static_cast<uint16_t>(addr), static_cast<uint16_t>(pageEnd - addr));
+					}
+				}
+
+				merge = dirtyPages[addr >> 8];
+				addr = pageEnd;
 			}
 		}
+
+		return dirtyBlocks;
 	}
 
-	uint64_t Machine::Run(uint16_t pc)
+	std::array<bool, 256> Machine::DirtyPages()
 	{
-		if (memoryController_ == nullptr)
+		auto dirtyPages = cpu_->DirtyPages();
+
+		for (size_t page = 0; page < dirtyPages.size(); page++)
 		{
-			throw std::runtime_error ("No memory controller has been set");
+			snapshot_.dirtyPages[page] |= dirtyPages[page];
 		}
 
-		if (ioController_ == nullptr)
+		return dirtyPages;
+	}
+
+	void Machine::CaptureSaveState(const std::array<uint8_t, 16>& memUuid)
+	{
+		auto& capture = saveCapture_;
+		capture.memUuid = memUuid;
+		capture.romMd5 = romMd5_.value();
+		capture.encoder = opt_.Encoder();
+		capture.compressor = opt_.Compressor();
+		capture.ram.clear();
+
+		if (onSaveBinary_ == nullptr)
 		{
-			throw std::runtime_error("No io controller has been set");
+			capture.cpu = cpu_->Save();
+			ReadMemory(opt_.Ram(), capture.ram);
+			return;
 		}
 
-		if (running_ == true)
+		auto& state = saveState_;
+		auto write16 = [&state](size_t offset, uint16_t value)
 		{
-			throw std::runtime_error("The machine is running");
+			state[offset] = value & 0xFF;
+			state[offset + 1] = value >> 8;
+		};
+
+		// A delta save state only carries the ram pages written to since the previous save state
+		auto dirtyPages = DirtyPages();
+		bool delta = deltaSequence_ > 0;
+		ReadMemory(delta == true ? DirtyBlocks(opt_.Ram(), dirtyPages) : opt_.Ram(), capture.ram);
+		const auto& romMd5 = capture.romMd5;
+
+		// header
+		state.assign(binaryMagic_.begin(), binaryMagic_.end());
+		state.resize(8);
+		write16(4, binaryVersion_);
+		write16(6, delta == true ? 0x01 : 0x00);
+		state.insert(state.end(), memUuid.begin(), memUuid.end());
+		state.insert(state.end(), romMd5.begin(), romMd5.end());
+
+		// cpu
+		auto cpuOffset = state.size();
+		state.resize(cpuOffset + 2);
+		cpu_->Save(state);
+		write16(cpuOffset, static_cast<uint16_t>(state.size() - cpuOffset - 2));
+
+		// delta sequence number and dirty page bitmap
+		if (delta == true)
+		{
+			auto deltaOffset = state.size();
+			state.resize(deltaOffset + 36);
+
+			for (int i = 0; i < 4; i++)
+			{
+				state[deltaOffset + i] = (deltaSequence_ >> (i * 8)) & 0xFF;
+			}
+
+			for (size_t page = 0; page < dirtyPages.size(); page++)
+			{
+				state[deltaOffset + 4 + page / 8] |= dirtyPages[page] << (page % 8);
+			}
 		}
 
-		cpu_->Reset(pc);
-		clock_->Reset();
-		SetClockResolution(opt_.ClockResolution());
-		running_ = true;
-		uint64_t totalTime = 0;
-		auto launchPolicy = opt_.RunAsync() ? std::launch::async : std::launch::deferred;
+		deltaSequence_ = deltaSequence_ < opt_.DeltaSaves() ? deltaSequence_ + 1 : 0;
+	}
+
+	void Machine::EncodeBinaryState()
+	{
+		auto& state = saveState_;
+		const auto& capture = saveCapture_;
+		auto write32 = [&state](size_t offset, uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				state[offset + i] = (value >> (i * 8)) & 0xFF;
+			}
+		};
+
+		// ram
+		auto ramOffset = state.size();
+		state.resize(ramOffset + 9);
+		state[ramOffset] = capture.compressor == "zlib" ? 1 : 0;
+		write32(ramOffset + 1, static_cast<uint32_t>(capture.ram.size()));
+		Utils::Compress(capture.compressor, capture.ram.data(), static_cast<uint32_t>(capture.ram.size()), state);
+		write32(ramOffset + 5, static_cast<uint32_t>(state.size() - ramOffset - 9));
+	}
+
+	std::string Machine::EncodeJsonState() const
+	{
+		const auto& capture = saveCapture_;
+		const auto& romMd5 = capture.romMd5;
+		auto fmtStr = "{\"cpu\":%s,\"memory\":{\"uuid\":\"%s\",\"rom\":\"%s\",\"ram\":{\"encoder\":\"%s\",\"compressor\":\"%s\",\"size\":%d,\"bytes\":\"%s\"}}}";
+		auto memUuid = Utils::BinToTxt("base64", "none", capture.memUuid.data(), capture.memUuid.size());
+		auto md5 = Utils::BinToTxt("base64", "none", romMd5.data(), romMd5.size());
+		auto ram = Utils::BinToTxt(capture.encoder, capture.compressor, capture.ram.data(), capture.ram.size());
+
+		// todo - replace snprintf with std::format
+		auto writeState = [&](char* data, size_t dataSize)
+		{
+			return snprintf(data, dataSize, fmtStr, capture.cpu.c_str(), memUuid.c_str(), md5.c_str(),
+				capture.encoder.c_str(), capture.compressor.c_str(), capture.ram.size(), ram.c_str());
+		};
+
+		auto count = writeState(nullptr, 0) + 1;
+		std::string state(count, '\0');
+		writeState(state.data(), count);
+		// drop the null terminator
+		state.pop_back();
+		return state;
+	}
+
+	void Machine::LoadBinaryState(std::span<const uint8_t> state)
+	{
+		auto check = [&state](size_t offset, size_t size)
+		{
+			if (offset + size > state.size())
+			{
+				throw std::runtime_error("Truncated binary load state");
+			}
+		};
+		auto read = [&state, &check](size_t offset, size_t size)
+		{
+			check(offset, size);
+			uint32_t value = 0;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				value |= state[offset + i] << (i * 8);
+			}
+
+			return value;
+		};
+
+		auto ramMetadata = opt_.Ram();
+		size_t machineRamSize = 0;
+
+		for (const auto& rm : ramMetadata)
+		{
+			machineRamSize += rm.second;
+		}
 
-		auto machineLoop = [this]
+		// The ram is staged in a copy of the address space so the chain of deltas can be applied in
+		// place, the machine is only updated once all the save states in the chain have been checked
+		std::vector<uint8_t> memory(0x10000);
+		std::span<const uint8_t> cpuState;
+		uint32_t sequence = 0;
+
+		// A full save state optionally followed by the delta save states that apply to it
+		for (size_t offset = 0; offset < state.size(); sequence++)
 		{
-			auto dataBus = systemBus_.dataBus;
-			auto controlBus = systemBus_.controlBus;
-			auto currTime = nanoseconds::zero();
-			int64_t totalTicks = 0;
-			int64_t lastTicks = 0;
-			auto loadLaunchPolicy = opt_.LoadAsync() ? std::launch::async : std::launch::deferred;
-			auto saveLaunchPolicy = opt_.SaveAsync() ? std::launch::async : std::launch::deferred;
-			std::future<std::string> onLoad;
-			std::future<std::string> onSave;
+			check(offset, 42);
+
+			if (std::equal(binaryMagic_.begin(), binaryMagic_.end(), state.begin() + offset) == false)
+			{
+				throw std::runtime_error("Invalid binary load state");
+			}
+
+			if (read(offset + 4, 2) != binaryVersion_)
+			{
+				throw std::runtime_error("Unsupported binary load state version");
+			}
 
-			auto loadMachineState = [this](std::string&& str)
+			bool delta = (read(offset + 6, 2) & 0x01) != 0;
+
+			if (sequence == 0)
 			{
-				if (str.empty() == false)
+				if (delta == true)
 				{
-					try
-					{
-						// perform checks to make sure that this machine load state is compatible with this machine
+					throw std::runtime_error("A binary load state must begin with a full save state");
+				}
 
-						auto memUuid = memoryController_->Uuid();
+				// perform checks to make sure that this machine load state is compatible with this machine
+				CheckMemoryState(state.subspan(8, 16), state.subspan(24, 16));
+			}
+			else if (delta == false || std::equal(state.begin() + 8, state.begin() + 40, state.begin() + offset + 8) == false)
+			{
+				throw std::runtime_error("Incompatible binary load state delta");
+			}
 
-						if (memUuid == std::array<uint8_t, 16>{})
-						{
-							throw std::runtime_error("Invalid memory controller uuid for load interrupt");
-						}
+			auto cpuSize = read(offset + 40, 2);
+			check(offset + 42, cpuSize);
+			cpuState = state.subspan(offset + 42, cpuSize);
+			auto ramOffset = offset + 42 + cpuSize;
+			auto blocks = ramMetadata;
 
-						auto json = nlohmann::json::parse(str);
-						// The memory controllers must be the same
-						auto jsonUuid = Utils::TxtToBin("base64", "none", 16, json["memory"]["uuid"].get<std::string>());
+			if (delta == true)
+			{
+				if (read(ramOffset, 4) != sequence)
+				{
+					throw std::runtime_error("Binary load state delta is out of sequence");
+				}
 
-						if (jsonUuid.size() != memUuid.size() || std::equal(jsonUuid.begin(), jsonUuid.end(), memUuid.begin()) == false)
-						{
-							throw std::runtime_error("Incompatible memory controller");
-						}
+				check(ramOffset + 4, 32);
+				std::array<bool, 256> dirtyPages{};
 
-						auto romMetadata = opt_.Rom();
-						std::vector<uint8_t> rom;
+				for (size_t page = 0; page < dirtyPages.size(); page++)
+				{
+					dirtyPages[page] = (state[ramOffset + 4 + page / 8] >> (page % 8)) & 0x01;
+				}
 
-						for (const auto& rm : romMetadata)
-						{
-							for (int addr = rm.first; addr < rm.first + rm.second; addr++)
-							{
-								rom.push_back(memoryController_->Read(addr));
-							}
-						}
+				blocks = DirtyBlocks(ramMetadata, dirtyPages);
+				ramOffset += 36;
+			}
+
+			auto compressor = read(ramOffset, 1);
+			auto ramSize = read(ramOffset + 1, 4);
+			auto bytesSize = read(ramOffset + 5, 4);
+			check(ramOffset + 9, bytesSize);
+
+			if (compressor > 1)
+			{
+				throw std::runtime_error("Unsupported binary load state compressor");
+			}
+
+			size_t blocksSize = 0;
+
+			for (const auto& b : blocks)
+			{
+				blocksSize += b.second;
+			}
+
+			// Make sure the ram size matches the layout
+			if (ramSize != (delta == true ? blocksSize : machineRamSize))
+			{
+				throw std::runtime_error("Incompatible ram");
+			}
+
+			std::vector<uint8_t> ram(ramSize);
+			Utils::Decompress(compressor == 1 ? "zlib" : "none", state.data() + ramOffset + 9, bytesSize, ram.data(), ramSize);
+			auto src = ram.begin();
+
+			for (const auto& [addr, size] : blocks)
+			{
+				src = std::copy_n(src, size, memory.begin() + addr);
+			}
+
+			offset = ramOffset + 9 + bytesSize;
+		}
+
+		std::vector<uint8_t> ram;
+		ram.reserve(machineRamSize);
+
+		for (const auto& [addr, size] : ramMetadata)
+		{
+			ram.insert(ram.end(), memory.begin() + addr, memory.begin() + addr + size);
+		}
+
+		// Once all checks are complete, restore the cpu and the memory
+		cpu_->Load(cpuState);
+		WriteMemory(ramMetadata, ram.data());
+	}
+
+	std::string Machine::CheckHandler(std::future<std::string>& fut)
+	{
+		std::string str;
+
+		if (fut.valid() == true)
+		{
+			auto status = fut.wait_for(nanoseconds::zero());
+
+			if (status == std::future_status::deferred || status == std::future_status::ready)
+			{
+				str = fut.get();
+			}
+		}
+
+		return str;
+	}
+
+	void Machine::ServiceInterrupts()
+	{
+		auto serviced = false;
+
+		if (scheduled_ == false || scheduler_.Raised() == true)
+		{
+			if constexpr (perfCounters == true)
+			{
+				counters_.serviceCalls++;
+			}
+
+			ServiceInterrupt(ioController_->ServiceInterrupts(currTime_.count(), totalTicks_));
+			serviced = true;
+		}
+
+		while (scheduler_.Next() <= totalTicks_)
+		{
+			auto isr = scheduler_.Pop();
+
+			if (isr == ISR::NoInterrupt)
+			{
+				if constexpr (perfCounters == true)
+				{
+					counters_.serviceCalls++;
+				}
+
+				isr = ioController_->ServiceInterrupts(currTime_.count(), totalTicks_);
+			}
+
+			ServiceInterrupt(isr);
+			serviced = true;
+		}
+
+		for (const auto& device : ioDevices_)
+		{
+			if constexpr (perfCounters == true)
+			{
+				counters_.serviceCalls++;
+			}
+
+			ServiceInterrupt(device->ServiceInterrupts(currTime_.count(), totalTicks_));
+			serviced = true;
+		}
+
+		// Complete any outstanding load/save requests
+		if (serviced == false && (loadFut_.valid() == true || saveFut_.valid() == true))
+		{
+			ServiceInterrupt(ISR::NoInterrupt);
+		}
+
+		// Deliver the highest priority pending interrupt once the cpu accepts interrupts
+		if (pendingIsrs_ != 0 && cpu_->InterruptsEnabled() == true)
+		{
+			auto isr = std::countr_zero(pendingIsrs_);
+			pendingIsrs_ &= pendingIsrs_ - 1;
+
+			if (recording_ == true)
+			{
+				recorder_.RecordInterrupt(totalTicks_, static_cast<ISR>(isr));
+			}
+
+			systemBus_.controlBus->Send(Signal::Interrupt);
+			systemBus_.dataBus->Send(static_cast<uint8_t>(isr));
+		}
+	}
 
-						// The rom must be the same
-						auto jsonMd5 = Utils::TxtToBin("base64", "none", 16, json["memory"]["rom"].get<std::string>());
-						auto romMd5 = Utils::Md5(rom.data(), rom.size());
+	void Machine::ServiceInterrupt(ISR isr)
+	{
+		auto controlBus = systemBus_.controlBus;
 
-						if (jsonMd5.size() != romMd5.size() || std::equal(jsonMd5.begin(), jsonMd5.end(), romMd5.begin()) == false)
+		if constexpr (perfCounters == true)
+		{
+			switch (isr)
+			{
+				case ISR::Save: counters_.saveInterrupts++; break;
+				case ISR::Load: counters_.loadInterrupts++; break;
+				case ISR::Quit: counters_.quitInterrupts++; break;
+				case ISR::NoInterrupt: break;
+				default: counters_.cpuInterrupts[static_cast<size_t>(isr) & 0x07]++; break;
+			}
+		}
+
+		switch (isr)
+		{
+			case ISR::Zero:
+			case ISR::One:
+			case ISR::Two:
+			case ISR::Three:
+			case ISR::Four:
+			case ISR::Five:
+			case ISR::Six:
+			case ISR::Seven:
+			{
+				// Hold the interrupt pending until the cpu accepts it
+				pendingIsrs_ |= 1 << static_cast<int>(isr);
+				break;
+			}
+			case ISR::Load:
+			{
+				// If a user defined callback is set and we are not processing a load or save request
+				if (onLoad_ != nullptr && loadFut_.valid() == false && saveFut_.valid() == false)
+				{
+					loadFut_ = std::async(opt_.LoadAsync() ? std::launch::async : std::launch::deferred, [this]
+					{
+						std::string str;
+							
+						// Calling out into user land, make sure we don't leak any exceptions
+						try
 						{
-							throw std::runtime_error("Incompatible rom");
+							str = onLoad_();
 						}
-
-						// decode and decompress the ram
-						auto jsonRam = json["memory"]["ram"];
-						auto ram = Utils::TxtToBin(jsonRam["encoder"].get<std::string>(),
-							jsonRam["compressor"].get<std::string>(),
-							jsonRam["size"].get<uint32_t>(),
-							jsonRam["bytes"].get<std::string>());
-						
-						auto ramMetadata = opt_.Ram();
-						int ramSize = 0;
-						int ramIndex = 0;
-
-						for (const auto& rm : ramMetadata)
+						catch (const std::exception& e)
 						{
-							ramSize += rm.second;
+							// todo: log the exception to a log file
+							printf("%s\n", e.what());
 						}
 
-						// Make sure the ram size matches the layout
-						if (ram.size() != ramSize)
+						return str;
+					});
+
+					LoadMachineState(CheckHandler(loadFut_));
+				}
+				break;
+			}
+			case ISR::Save:
+			{
+				// If a user defined callback is set and we are not processing a save or load request
+				if ((onSave_ != nullptr || onSaveBinary_ != nullptr) && saveFut_.valid() == false && loadFut_.valid() == false)
+				{
+					try
+					{
+						auto memUuid = memoryController_->Uuid();
+
+						if (memUuid == std::array<uint8_t, 16>{})
 						{
-							throw std::runtime_error("Incompatible ram");
+							throw std::runtime_error("Invalid memory controller uuid for save interrupt");
 						}
 
-						// Once all checks are complete, restore the cpu and the memory
-						cpu_->Load(json["cpu"].dump());
-	
-						for (const auto& rm : ramMetadata)
+						// Only capture the machine state on the emulation thread, the ram is compressed and
+						// encoded along with the call to the completion handler by the save future
+						CaptureSaveState(memUuid);
+
+						// saveState_ and saveCapture_ are not touched again until this future has completed
+						saveFut_ = std::async(opt_.SaveAsync() ? std::launch::async : std::launch::deferred, [this]
 						{
-							for (int addr = rm.first; addr < rm.first + rm.second; addr++)
+							// Calling out into user land, make sure we don't leak any exceptions
+							try
+							{
+								if (onSaveBinary_ != nullptr)
+								{
+									EncodeBinaryState();
+									onSaveBinary_(saveState_);
+								}
+								else
+								{
+									onSave_(EncodeJsonState().c_str());
+								}
+							}
+							catch (const std::exception& e)
 							{
-								memoryController_->Write(addr, ram[ramIndex++]);
+								// todo: log the exception to a log file
+								printf("%s\n", e.what());
 							}
-						}
+
+							return std::string("");
+						});
+
+						CheckHandler(saveFut_);
 					}
 					catch (const std::exception& e)
 					{
@@ -250,217 +894,308 @@ namespace MachEmu
 						printf("%s\n", e.what());
 					}
 				}
-			};
+				break;
+			}
+			case ISR::Quit:
+			{
+				// Wait for any outstanding load/save requests to complete
+
+				if (loadFut_.valid() == true)
+				{
+					// we are quitting, wait for the onLoad handler to complete
+					LoadMachineState(loadFut_.get());
+				}
+
+				if (saveFut_.valid() == true)
+				{
+					// we are quitting, wait for the onSave handler to complete
+					saveFut_.get();
+				}
+				controlBus->Send(Signal::PowerOff);
+				break;
+			}
+			case ISR::NoInterrupt:
+			{
+				// no interrupts pending, do any work that is outstanding
+				LoadMachineState(CheckHandler(loadFut_));							
+				CheckHandler(saveFut_);
+				break;
+			}
+			default:
+			{
+				//assert(0);
+				break;
+			}
+		}
+	}
+
+	int64_t Machine::Execute(int64_t cycleBudget)
+	{
+		if (replaying_ == true)
+		{
+			return ExecuteReplay(cycleBudget);
+		}
+
+		auto controlBus = systemBus_.controlBus;
+		int64_t cycles = 0;
+
+		while (cycles < cycleBudget)
+		{
+			// Let the cpu run uninterrupted until it is time to service interrupts, a scheduled interrupt is due or synchronise the clock
+			auto budget = std::min({ cycleBudget - cycles, ticksPerIsr_ - (totalTicks_ - lastTicks_), scheduler_.Next() - totalTicks_, nextSample_ - totalTicks_ });
+
+			if (ticksPerSync_ >= 0)
+			{
+				budget = std::min(budget, ticksPerSync_);
+			}
+
+			auto ticks = cpu_->ExecuteFor(budget);
+
+			if constexpr (perfCounters == true)
+			{
+				auto now = steady_clock::now();
+				currTime_ = clock_->Tick(ticks);
+				counters_.clockTime += steady_clock::now() - now;
+			}
+			else
+			{
+				currTime_ = clock_->Tick(ticks);
+			}
+
+			totalTicks_ += ticks;
+			cycles += ticks;
+
+			// The cpu is halted or spinning, skip the cycles it would spend waiting for an interrupt
+			if (cpu_->Idle() == true)
+			{
+				auto idle = IdleTicks(cycleBudget - cycles);
+
+				if (idle > 0)
+				{
+					if (recording_ == true)
+					{
+						recorder_.RecordIdle(totalTicks_, idle);
+					}
+
+					currTime_ = clock_->Tick(idle);
+					totalTicks_ += idle;
+					cycles += idle;
+
+					if constexpr (perfCounters == true)
+					{
+						counters_.idleCycles += idle;
+					}
+				}
+			}
+
+			if (totalTicks_ >= nextSample_)
+			{
+				SampleProfile();
+			}
+
+			// Check if it is time to service interrupts or a scheduled interrupt is due
+			if (totalTicks_ - lastTicks_ >= ticksPerIsr_ || totalTicks_ >= scheduler_.Next())
+			{
+				if constexpr (perfCounters == true)
+				{
+					auto now = steady_clock::now();
+					ServiceInterrupts();
+					counters_.serviceTime += steady_clock::now() - now;
+				}
+				else
+				{
+					ServiceInterrupts();
+				}
+
+				lastTicks_ = totalTicks_;
+
+				if (controlBus->Receive(Signal::PowerOff) == true)
+				{
+					PowerOff();
+
+					if (recording_ == true)
+					{
+						recorder_.RecordQuit(totalTicks_);
+
+						// Calling out into user land, make sure we don't leak any exceptions
+						try
+						{
+							onRecord_(recorder_.Log());
+						}
+						catch (const std::exception& e)
+						{
+							// todo: log the exception to a log file
+							printf("%s\n", e.what());
+						}
+					}
 
-			auto checkHandler = [](std::future<std::string>& fut)
+					break;
+				}
+			}
+		}
+
+		return cycles;
+	}
+
+	int64_t Machine::ExecuteReplay(int64_t cycleBudget)
+	{
+		int64_t cycles = 0;
+
+		while (cycles < cycleBudget)
+		{
+			auto event = recorder_.NextEvent();
+
+			if (event == nullptr || event->cycles < totalTicks_)
 			{
-				std::string str;
+				throw std::runtime_error("The replay has diverged from the recording");
+			}
+
+			if (event->cycles > totalTicks_)
+			{
+				// The cpu stops at the same instruction boundary as it did when the event was recorded
+				auto ticks = cpu_->ExecuteFor(std::min({ cycleBudget - cycles, event->cycles - totalTicks_, nextSample_ - totalTicks_ }));
+				currTime_ = clock_->Tick(ticks);
+				totalTicks_ += ticks;
+				cycles += ticks;
+
+				if (totalTicks_ >= nextSample_)
+				{
+					SampleProfile();
+				}
+
+				continue;
+			}
 
-				if (fut.valid() == true)
+			recorder_.PopEvent();
+
+			switch (event->type)
+			{
+				case Recorder::Type::Interrupt:
+				{
+					systemBus_.controlBus->Send(Signal::Interrupt);
+					systemBus_.dataBus->Send(static_cast<uint8_t>(event->value));
+					break;
+				}
+				case Recorder::Type::Idle:
+				{
+					auto idle = static_cast<int64_t>(event->value);
+					currTime_ = clock_->Tick(idle);
+					totalTicks_ += idle;
+					cycles += idle;
+					break;
+				}
+				case Recorder::Type::Quit:
 				{
-					auto status = fut.wait_for(nanoseconds::zero());
+					ServiceInterrupt(ISR::Quit);
+					systemBus_.controlBus->Receive(Signal::PowerOff);
+					PowerOff();
+					return cycles;
+				}
+				default:
+				{
+					break;
+				}
+			}
+		}
+
+		return cycles;
+	}
+
+	void Machine::PowerOff()
+	{
+		poweredOn_ = false;
+		tracer_.Stop();
+		cpu_->SetTrace(nullptr);
+
+		if (nextSample_ != std::numeric_limits<int64_t>::max())
+		{
+			nextSample_ = std::numeric_limits<int64_t>::max();
+			cpu_->SetProfiling(false);
+			profiler_.Write(opt_.Profile());
+		}
+	}
+
+	void Machine::SampleProfile()
+	{
+		// An idle cpu may have skipped several intervals, they are all spent at the same pc
+		auto samples = (totalTicks_ - nextSample_) / sampleInterval_ + 1;
+		cpu_->CallStack(callStack_);
+		profiler_.Sample(callStack_, samples);
+		nextSample_ += samples * sampleInterval_;
+	}
+
+	int64_t Machine::IdleTicks(int64_t maxTicks) const
+	{
+		// A pending interrupt is delivered at the next service of interrupts
+		if (maxTicks <= 0 || (pendingIsrs_ != 0 && cpu_->InterruptsEnabled() == true))
+		{
+			return 0;
+		}
 
-					if (status == std::future_status::deferred || status == std::future_status::ready)
-					{
-						str = fut.get();
-					}
-				}
+		// The ticks until interrupts are next serviced, every Execute loop iteration when ticksPerIsr_ isn't positive
+		auto ticks = ticksPerIsr_ > 0 ? std::max<int64_t>(ticksPerIsr_ - (totalTicks_ - lastTicks_), 0) : 0;
+		auto now = static_cast<uint64_t>(currTime_.count());
+		auto deadline = std::numeric_limits<uint64_t>::max();
 
-				return str;
-			};
+		if (scheduled_ == true)
+		{
+			// Skip to the next scheduled interrupt or service of interrupts (which checks for raised interrupts)
+			auto untilNext = std::max<int64_t>(scheduler_.Next() - totalTicks_, 0);
 
-			while (controlBus->Receive(Signal::PowerOff) == false)
+			if (ioDevices_.empty() == true)
 			{
-				//Execute the next instruction
-				auto ticks = cpu_->Execute();
-				currTime = clock_->Tick(ticks);
-				totalTicks += ticks;
+				ticks = ticksPerIsr_ > 0 ? std::min(ticks, untilNext) : (scheduler_.Next() == std::numeric_limits<int64_t>::max() ? 0 : untilNext);
+				return std::min(ticks, maxTicks);
+			}
 
-				// Check if it is time to service interrupts
-				if (totalTicks - lastTicks >= ticksPerIsr_)
-				{
-					auto isr = ioController_->ServiceInterrupts(currTime.count(), totalTicks);
+			maxTicks = std::min(maxTicks, untilNext);
+		}
+		else
+		{
+			deadline = ioController_->NextInterrupt(now, totalTicks_);
+		}
 
-					switch (isr)
-					{
-						case ISR::Zero:
-						case ISR::One:
-						case ISR::Two:
-						case ISR::Three:
-						case ISR::Four:
-						case ISR::Five:
-						case ISR::Six:
-						case ISR::Seven:
-						{
-							controlBus->Send(Signal::Interrupt);
-							dataBus->Send(static_cast<uint8_t>(isr));
-							break;
-						}
-						case ISR::Load:
-						{
-							// If a user defined callback is set and we are not processing a load or save request
-							if (onLoad_ != nullptr && onLoad.valid() == false && onSave.valid() == false)
-							{
-								onLoad = std::async(loadLaunchPolicy, [this]
-								{
-									std::string str;
-										
-									// Calling out into user land, make sure we don't leak any exceptions
-									try
-									{
-										auto json = onLoad_();
-
-										if (json != nullptr)
-										{
-											// return a copy of the json c string as a std::string
-											str = json;
-										}
-										else
-										{
-											throw std::runtime_error("empty json load state");
-										}
-									}
-									catch (const std::exception& e)
-									{
-										// todo: log the exception to a log file
-										printf("%s\n", e.what());
-									}
-
-									return str;
-								});
-
-								loadMachineState(checkHandler(onLoad));
-							}
-							break;
-						}
-						case ISR::Save:
-						{
-							// If a user defined callback is set and we are not processing a save or load request
-							if (onSave_ != nullptr && onSave.valid() == false && onLoad.valid() == false)
-							{
-								try
-								{
-									auto memUuid = memoryController_->Uuid();
-
-									if (memUuid == std::array<uint8_t, 16>{})
-									{
-										throw std::runtime_error("Invalid memory controller uuid for save interrupt");
-									}
-
-									auto rm = [this](std::vector<std::pair<uint16_t, uint16_t>>&& metadata)
-									{
-										std::vector<uint8_t> mem;
-
-										for (const auto& m : metadata)
-										{
-											for (auto addr = m.first; addr < m.first + m.second; addr++)
-											{
-												mem.push_back(memoryController_->Read(addr));
-											}
-										}
-
-										return mem;
-									};
-
-									auto ram = rm(opt_.Ram());
-									auto rom = rm(opt_.Rom());
-									auto fmtStr = "{\"cpu\":%s,\"memory\":{\"uuid\":\"%s\",\"rom\":\"%s\",\"ram\":{\"encoder\":\"%s\",\"compressor\":\"%s\",\"size\":%d,\"bytes\":\"%s\"}}}";
-									auto romMd5 = Utils::Md5(rom.data(), rom.size());
-
-									// todo - replace snprintf with std::format
-									auto writeState = [&](size_t& dataSize)
-									{
-										std::string str;
-										char* data = nullptr;
-
-										if (dataSize > 0)
-										{
-											str.resize(dataSize);
-											data = str.data();
-										}
-
-										//cppcheck-suppress nullPointer
-										dataSize = snprintf(data, dataSize, fmtStr,
-											cpu_->Save().c_str(),
-											Utils::BinToTxt("base64", "none", memUuid.data(), memUuid.size()).c_str(),
-											Utils::BinToTxt("base64", "none", romMd5.data(), romMd5.size()).c_str(),
-											opt_.Encoder().c_str(), opt_.Compressor().c_str(), ram.size(),
-											Utils::BinToTxt(opt_.Encoder(), opt_.Compressor(), ram.data(), ram.size()).c_str()) + 1;
-
-										return str;
-									};
-
-									size_t count = 0;
-									writeState(count);
-
-									onSave = std::async(saveLaunchPolicy, [this, state = writeState(count)]
-									{
-										// Calling out into user land, make sure we don't leak any exceptions
-										try
-										{
-											onSave_(state.c_str());
-										}
-										catch (const std::exception& e)
-										{
-											// todo: log the exception to a log file
-											printf("%s\n", e.what());
-										}
-
-										return std::string("");
-									});
-
-									checkHandler(onSave);
-								}
-								catch (const std::exception& e)
-								{
-									// log the exception - e.what()
-									printf("%s\n", e.what());
-								}
-							}
-							break;
-						}
-						case ISR::Quit:
-						{
-							// Wait for any outstanding load/save requests to complete
+		// The polled io devices must not miss their next interrupt either
+		for (const auto& device : ioDevices_)
+		{
+			deadline = std::min(deadline, device->NextInterrupt(now, totalTicks_));
+		}
 
-							if (onLoad.valid() == true)
-							{
-								// we are quitting, wait for the onLoad handler to complete
-								loadMachineState(onLoad.get());
-							}
+		if (deadline <= now || maxTicks <= 0)
+		{
+			return 0;
+		}
 
-							if (onSave.valid() == true)
-							{
-								// we are quitting, wait for the onSave handler to complete
-								onSave.get();
-							}
-							controlBus->Send(Signal::PowerOff);
-							break;
-						}
-						case ISR::NoInterrupt:
-						{
-							// no interrupts pending, do any work that is outstanding
-							loadMachineState(checkHandler(onLoad));							
-							checkHandler(onSave);
-							break;
-						}
-						default:
-						{
-							//assert(0);
-							break;
-						}
-					}
+		if (deadline != std::numeric_limits<uint64_t>::max())
+		{
+			auto untilDeadline = static_cast<int64_t>(std::min(std::ceil((deadline - now) * (opt_.CpuFrequency() / 1e9)), static_cast<double>(maxTicks)));
 
-					lastTicks = totalTicks;
-				}
+			if (untilDeadline > ticks)
+			{
+				// Round up to the first service of interrupts at or after the deadline
+				ticks = ticksPerIsr_ > 0 ? ticks + (untilDeadline - ticks + ticksPerIsr_ - 1) / ticksPerIsr_ * ticksPerIsr_ : untilDeadline;
 			}
+		}
 
-			return currTime.count();
-		};
+		return std::min(ticks, maxTicks);
+	}
+
+	uint64_t Machine::Run(uint16_t pc)
+	{
+		PowerOn(pc);
+		running_ = true;
+		uint64_t totalTime = 0;
+		auto launchPolicy = opt_.RunAsync() ? std::launch::async : std::launch::deferred;
 
-		fut_ = std::async(launchPolicy, [this, ml = std::move(machineLoop)]
+		fut_ = std::async(launchPolicy, [this]
 		{
-			return ml();
+			// Run until the io controller generates an ISR::Quit interrupt
+			while (poweredOn_ == true)
+			{
+				Execute(std::numeric_limits<int64_t>::max());
+			}
+
+			return currTime_.count();
 		});
 
 		if (launchPolicy == std::launch::deferred)
@@ -472,6 +1207,27 @@ namespace MachEmu
 		return totalTime;
 	}
 
+	int64_t Machine::RunFor(int64_t cycles, uint16_t pc, bool* quit)
+	{
+		if (poweredOn_ == false)
+		{
+			PowerOn(pc);
+		}
+		else if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		auto ticks = Execute(cycles);
+
+		if (quit != nullptr)
+		{
+			*quit = !poweredOn_;
+		}
+
+		return ticks;
+	}
+
 	uint64_t Machine::WaitForCompletion()
 	{
 		uint64_t totalTime = 0;
@@ -498,6 +1254,7 @@ namespace MachEmu
 		}
 
 		memoryController_ = controller;
+		romMd5_.reset();
 	}
 
 	void Machine::SetIoController(const std::shared_ptr<IController>& controller)
@@ -515,6 +1272,47 @@ namespace MachEmu
 		ioController_ = controller;
 	}
 
+	void Machine::AddIoController(const std::shared_ptr<IController>& controller, uint8_t firstPort, uint8_t lastPort)
+	{
+		if (controller == nullptr)
+		{
+			throw std::invalid_argument("Argument 'controller' can not be nullptr");
+		}
+
+		if (firstPort > lastPort)
+		{
+			throw std::invalid_argument("Argument 'firstPort' can not be greater than 'lastPort'");
+		}
+
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		auto it = std::find(ioDevices_.begin(), ioDevices_.end(), controller);
+		auto owner = static_cast<uint8_t>(it - ioDevices_.begin() + 1);
+
+		for (int port = firstPort; port <= lastPort; port++)
+		{
+			if (portOwners_[port] != 0 && portOwners_[port] != owner)
+			{
+				throw std::invalid_argument("The port range has already been claimed by another io controller");
+			}
+		}
+
+		if (it == ioDevices_.end())
+		{
+			if (ioDevices_.size() == 255)
+			{
+				throw std::invalid_argument("Too many io controllers");
+			}
+
+			ioDevices_.push_back(controller);
+		}
+
+		std::fill(portOwners_.begin() + firstPort, portOwners_.begin() + lastPort + 1, owner);
+	}
+
 	void Machine::OnSave(std::function<void(const char* json)>&& onSave)
 	{
 		if (running_ == true)
@@ -523,6 +1321,45 @@ namespace MachEmu
 		}
 
 		onSave_ = std::move(onSave);
+		onSaveBinary_ = nullptr;
+	}
+
+	void Machine::OnSave(std::function<void(std::span<const uint8_t> state)>&& onSave)
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		onSaveBinary_ = std::move(onSave);
+		onSave_ = nullptr;
+	}
+
+	void Machine::OnRecord(std::function<void(std::span<const uint8_t> log)>&& onRecord)
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		onRecord_ = std::move(onRecord);
+	}
+
+	void Machine::Replay(std::span<const uint8_t> log)
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		if (log.empty() == true)
+		{
+			replaying_ = false;
+			return;
+		}
+
+		recorder_.Replay(log);
+		replaying_ = true;
 	}
 
 	void Machine::OnLoad(std::function<const char*()>&& onLoad)
@@ -532,7 +1369,49 @@ namespace MachEmu
 			throw std::runtime_error("The machine is running");
 		}
 
-		onLoad_ = std::move(onLoad);
+		onLoad_ = nullptr;
+
+		if (onLoad != nullptr)
+		{
+			onLoad_ = [onLoad = std::move(onLoad)]
+			{
+				auto json = onLoad();
+
+				if (json == nullptr)
+				{
+					throw std::runtime_error("empty json load state");
+				}
+
+				// return a copy of the json c string as a std::string
+				return std::string(json);
+			};
+		}
+	}
+
+	void Machine::OnLoad(std::function<std::span<const uint8_t>()>&& onLoad)
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		onLoad_ = nullptr;
+
+		if (onLoad != nullptr)
+		{
+			onLoad_ = [onLoad = std::move(onLoad)]
+			{
+				auto state = onLoad();
+
+				if (state.empty() == true)
+				{
+					throw std::runtime_error("empty binary load state");
+				}
+
+				// return a copy of the binary state, it is identified by its magic bytes
+				return std::string(reinterpret_cast<const char*>(state.data()), state.size());
+			};
+		}
 	}
 
 	std::string Machine::Save() const
@@ -562,11 +1441,11 @@ namespace MachEmu
 			return mem;
 		};
 
-		auto rom = rm(opt_.Rom());
 		auto ram = rm(opt_.Ram());
 		auto fmtStr = "{\"cpu\":%s,\"memory\":{\"uuid\":\"%s\",\"rom\":\"%s\",\"ram\":{\"encoder\":\"%s\",\"compressor\":\"%s\",\"size\":%d,\"bytes\":\"%s\"}}}";
 		auto memUuid = memoryController_->Uuid();
-		auto romMd5 = Utils::Md5(rom.data(), rom.size());
+		// Use the cached digest when the machine has run with this memory controller and rom option
+		auto romMd5 = romMd5_.has_value() == true ? romMd5_.value() : ComputeRomMd5();
 		auto writeState = [&](char* data, size_t dataSize)
 		{
 			auto count = snprintf(data, dataSize, fmtStr,
@@ -593,4 +1472,234 @@ namespace MachEmu
 
 		return cpu_->GetState(size);
 	}
-} // namespace MachEmu
\ No newline at end of file
+
+	std::string Machine::GetPerfCounters() const
+	{
+		if constexpr (perfCounters == false)
+		{
+			throw std::runtime_error("Performance counters are not enabled, rebuild with enablePerfCounters");
+		}
+
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		const auto& cpuCounters = cpu_->Counters();
+		nlohmann::json counters;
+
+		counters["cpu"]["instructions"] = cpuCounters.instructions;
+		counters["cpu"]["cycles"] = cpuCounters.cycles;
+		counters["cpu"]["memoryReads"] = cpuCounters.memoryReads;
+		counters["cpu"]["memoryWrites"] = cpuCounters.memoryWrites;
+		counters["cpu"]["ioReads"] = cpuCounters.ioReads;
+		counters["cpu"]["ioWrites"] = cpuCounters.ioWrites;
+		counters["cpu"]["compiledBlocks"] = cpuCounters.compiledBlocks;
+		counters["interrupts"]["cpu"] = counters_.cpuInterrupts;
+		counters["interrupts"]["save"] = counters_.saveInterrupts;
+		counters["interrupts"]["load"] = counters_.loadInterrupts;
+		counters["interrupts"]["quit"] = counters_.quitInterrupts;
+		counters["serviceInterrupts"]["calls"] = counters_.serviceCalls;
+		counters["serviceInterrupts"]["nanoseconds"] = counters_.serviceTime.count();
+		counters["idle"]["cycles"] = counters_.idleCycles;
+		counters["clock"]["nanoseconds"] = counters_.clockTime.count();
+
+		return counters.dump();
+	}
+
+	std::string Machine::GetClockTelemetry() const
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		const auto& clockTelemetry = clock_->Telemetry();
+		nlohmann::json telemetry;
+
+		telemetry["slices"] = clockTelemetry.slices;
+		telemetry["overshoot"] = clockTelemetry.overshoot;
+		telemetry["undershoot"] = clockTelemetry.undershoot;
+		telemetry["drift"] = clockTelemetry.drift.count();
+		telemetry["cpuTime"] = clockTelemetry.cpuTime.count();
+
+		return telemetry.dump();
+	}
+
+	std::unique_ptr<IMachine> Machine::Clone() const
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		if (memoryController_ == nullptr || ioController_ == nullptr)
+		{
+			throw std::runtime_error("No memory or io controller has been set");
+		}
+
+		auto cloneController = [](const std::shared_ptr<IController>& controller)
+		{
+			auto clone = controller->Clone();
+
+			if (clone == nullptr)
+			{
+				throw std::runtime_error("The controller does not support cloning");
+			}
+
+			return clone;
+		};
+
+		auto machine = std::make_unique<Machine>(opt_.Options().c_str());
+		machine->memoryController_ = cloneController(memoryController_);
+		machine->ioController_ = cloneController(ioController_);
+
+		for (const auto& device : ioDevices_)
+		{
+			machine->ioDevices_.push_back(cloneController(device));
+		}
+
+		machine->portOwners_ = portOwners_;
+		machine->onLoad_ = onLoad_;
+		machine->onSave_ = onSave_;
+		machine->onSaveBinary_ = onSaveBinary_;
+		machine->onRecord_ = onRecord_;
+		machine->romMd5_ = romMd5_;
+
+		if (poweredOn_ == true)
+		{
+			// Power on the clone as it would be after the calls to RunFor made on this machine
+			std::array<PageAccess, 256> pageAccess;
+			pageAccess.fill(PageAccess::ReadWrite);
+			machine->cpu_->SetMemory(machine->memoryController_->Memory(pageAccess), pageAccess);
+			machine->cpu_->CopyState(*cpu_);
+			machine->clock_->Reset(totalTicks_);
+			machine->currTime_ = currTime_;
+			machine->totalTicks_ = totalTicks_;
+			machine->lastTicks_ = lastTicks_;
+			machine->pendingIsrs_ = pendingIsrs_;
+
+			machine->WireControllers();
+			machine->scheduler_.Reset(opt_.CpuFrequency());
+			machine->scheduled_ = machine->ioController_->Schedule(&machine->scheduler_);
+			// The cloned io controller expects the interrupts which are pending on this machine
+			machine->scheduler_.Copy(scheduler_);
+			machine->recording_ = recording_;
+
+			// The clone's recording continues this machine's recording
+			if (recording_ == true)
+			{
+				machine->recorderPorts_.fill(&machine->recorder_);
+				machine->cpu_->SetControllers(machine->memoryController_.get(), &machine->recorderPorts_);
+				machine->recorder_.Record(&machine->ioPorts_, recorder_);
+			}
+
+			machine->poweredOn_ = true;
+		}
+
+		return machine;
+	}
+
+	void Machine::Snapshot()
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		if (poweredOn_ == false)
+		{
+			throw std::runtime_error("The machine has not been powered on");
+		}
+
+		// The snapshot is the baseline of the pages written to before the next restore
+		cpu_->DirtyPages();
+		snapshot_.dirtyPages.fill(false);
+		cpu_->Snapshot();
+		snapshot_.memory.clear();
+		ReadMemory({ { 0x0000, 0x8000 }, { 0x8000, 0x8000 } }, snapshot_.memory);
+		snapshot_.currTime = currTime_;
+		snapshot_.totalTicks = totalTicks_;
+		snapshot_.lastTicks = lastTicks_;
+		snapshot_.pendingIsrs = pendingIsrs_;
+		// The dirty pages no longer track the writes since the last save state
+		deltaSequence_ = 0;
+	}
+
+	void Machine::Restore()
+	{
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		if (snapshot_.memory.empty() == true)
+		{
+			throw std::runtime_error("No snapshot has been taken");
+		}
+
+		std::array<PageAccess, 256> pageAccess;
+		pageAccess.fill(PageAccess::ReadWrite);
+		auto memory = memoryController_->Memory(pageAccess);
+		DirtyPages();
+		auto dirtyPages = std::exchange(snapshot_.dirtyPages, {});
+
+		// Only copy back the pages written to since the snapshot, read only and trapped pages must be written via the controller
+		for (size_t page = 0; page < dirtyPages.size(); page++)
+		{
+			if (dirtyPages[page] == true)
+			{
+				auto addr = static_cast<uint16_t>(page << 8);
+				auto src = snapshot_.memory.data() + addr;
+
+				if (memory != nullptr && pageAccess[page] == PageAccess::ReadWrite)
+				{
+					std::copy_n(src, 0x100, memory + addr);
+				}
+				else
+				{
+					for (int i = 0; i < 0x100; i++)
+					{
+						memoryController_->Write(addr + i, src[i]);
+					}
+				}
+			}
+		}
+
+		cpu_->Restore(dirtyPages);
+		clock_->Reset(snapshot_.totalTicks);
+		currTime_ = snapshot_.currTime;
+		totalTicks_ = snapshot_.totalTicks;
+		lastTicks_ = snapshot_.lastTicks;
+		pendingIsrs_ = snapshot_.pendingIsrs;
+		deltaSequence_ = 0;
+
+		if (scheduled_ == true)
+		{
+			scheduler_.Reset(opt_.CpuFrequency());
+			scheduled_ = ioController_->Schedule(&scheduler_);
+		}
+
+		if constexpr (coverage == true)
+		{
+			std::ranges::fill(cpu_->Coverage(), 0);
+		}
+
+		poweredOn_ = true;
+	}
+
+	std::span<const uint8_t> Machine::GetCoverage() const
+	{
+		if constexpr (coverage == false)
+		{
+			throw std::runtime_error("Branch coverage is not enabled, rebuild with enableCoverage");
+		}
+
+		if (running_ == true)
+		{
+			throw std::runtime_error("The machine is running");
+		}
+
+		return cpu_->Coverage();
+	}
+} // namespace MachEmu
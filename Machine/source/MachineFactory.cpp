@@ -21,6 +21,7 @@ SOFTWARE.
 */
 
 #include "Machine/Machine.h"
+#include "Machine/MachineFarm.h"
 #include "Machine/MachineFactory.h"
 
 namespace MachEmu
@@ -40,4 +41,9 @@ namespace MachEmu
 	{
 		return std::make_unique<Machine>(json);
 	}
+
+	std::unique_ptr<IMachineFarm> MakeMachineFarm(uint32_t threads, int64_t timeSlice)
+	{
+		return std::make_unique<MachineFarm>(threads, timeSlice);
+	}
 } // namespace MachEmu
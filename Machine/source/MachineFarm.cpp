@@ -0,0 +1,255 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Machine/MachineFarm.h"
+
+using namespace std::chrono;
+
+namespace MachEmu
+{
+	MachineFarm::MachineFarm(uint32_t threads, int64_t timeSlice)
+		: timeSlice_(timeSlice)
+	{
+		if (timeSlice <= 0)
+		{
+			throw std::invalid_argument("The time slice must be greater than 0");
+		}
+
+		if (threads == 0)
+		{
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		for (uint32_t i = 0; i < threads; i++)
+		{
+			workers_.push_back(std::make_unique<Worker>());
+		}
+
+		// Only launch the threads once all the workers exist as they steal from each other
+		for (size_t i = 0; i < workers_.size(); i++)
+		{
+			workers_[i]->thread = std::thread(&MachineFarm::WorkerLoop, this, i);
+		}
+	}
+
+	MachineFarm::~MachineFarm()
+	{
+		{
+			std::scoped_lock lock(mutex_);
+			stop_ = true;
+		}
+
+		cv_.notify_all();
+
+		for (auto& worker : workers_)
+		{
+			worker->thread.join();
+		}
+	}
+
+	void MachineFarm::Push(size_t worker, std::unique_ptr<Task>&& task)
+	{
+		{
+			std::scoped_lock lock(workers_[worker]->mutex);
+			workers_[worker]->tasks.push_back(std::move(task));
+		}
+
+		{
+			std::scoped_lock lock(mutex_);
+			queued_++;
+		}
+
+		cv_.notify_one();
+	}
+
+	std::unique_ptr<MachineFarm::Task> MachineFarm::Pop(size_t worker)
+	{
+		std::unique_ptr<Task> task;
+
+		// Try our own queue first
+		{
+			std::scoped_lock lock(workers_[worker]->mutex);
+
+			if (workers_[worker]->tasks.empty() == false)
+			{
+				task = std::move(workers_[worker]->tasks.front());
+				workers_[worker]->tasks.pop_front();
+			}
+		}
+
+		// Steal from the back of the other worker queues
+		for (size_t i = 1; task == nullptr && i < workers_.size(); i++)
+		{
+			auto& victim = workers_[(worker + i) % workers_.size()];
+			std::scoped_lock lock(victim->mutex);
+
+			if (victim->tasks.empty() == false)
+			{
+				task = std::move(victim->tasks.back());
+				victim->tasks.pop_back();
+				steals_++;
+			}
+		}
+
+		if (task != nullptr)
+		{
+			std::scoped_lock lock(mutex_);
+			queued_--;
+		}
+
+		return task;
+	}
+
+	void MachineFarm::Complete()
+	{
+		completed_++;
+
+		{
+			std::scoped_lock lock(mutex_);
+			active_--;
+		}
+
+		cv_.notify_all();
+	}
+
+	void MachineFarm::WorkerLoop(size_t worker)
+	{
+		while (true)
+		{
+			auto task = Pop(worker);
+
+			if (task == nullptr)
+			{
+				std::unique_lock lock(mutex_);
+				cv_.wait(lock, [this] { return stop_ == true || queued_ > 0; });
+
+				if (stop_ == true)
+				{
+					return;
+				}
+
+				continue;
+			}
+
+			try
+			{
+				bool quit = false;
+				auto ticks = task->machine->RunFor(timeSlice_, task->pc, &quit);
+				task->cycles += ticks;
+				cycles_ += ticks;
+				slices_++;
+
+				if (quit == true)
+				{
+					task->promise.set_value(task->cycles);
+					Complete();
+				}
+				else
+				{
+					// Not done yet, requeue it behind the rest of our work
+					Push(worker, std::move(task));
+				}
+			}
+			catch (...)
+			{
+				task->promise.set_exception(std::current_exception());
+				Complete();
+			}
+
+			std::scoped_lock lock(mutex_);
+
+			if (stop_ == true)
+			{
+				return;
+			}
+		}
+	}
+
+	std::future<int64_t> MachineFarm::Run(const std::shared_ptr<IMachine>& machine, uint16_t pc)
+	{
+		if (machine == nullptr)
+		{
+			throw std::invalid_argument("Argument 'machine' can not be nullptr");
+		}
+
+		auto task = std::make_unique<Task>();
+		task->machine = machine;
+		task->pc = pc;
+		auto future = task->promise.get_future();
+
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (machines_ == 0)
+			{
+				start_ = steady_clock::now();
+			}
+
+			active_++;
+		}
+
+		machines_++;
+		// Distribute new machines round robin, stealing will balance any uneven loads
+		Push(next_++ % workers_.size(), std::move(task));
+		return future;
+	}
+
+	void MachineFarm::WaitForCompletion()
+	{
+		std::unique_lock lock(mutex_);
+		cv_.wait(lock, [this] { return active_ == 0; });
+	}
+
+	std::string MachineFarm::Stats() const
+	{
+		double seconds = 0;
+
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (machines_ > 0)
+			{
+				seconds = duration_cast<duration<double>>(steady_clock::now() - start_).count();
+			}
+		}
+
+		int64_t cycles = cycles_;
+		auto fmtStr = "{\"threads\":%zu,\"machines\":%" PRIi64 ",\"completed\":%" PRIi64 ",\"slices\":%" PRIi64 ",\"steals\":%" PRIi64 ",\"cycles\":%" PRIi64 ",\"seconds\":%f,\"cyclesPerSecond\":%f}";
+		auto writeStats = [&](char* data, size_t dataSize)
+		{
+			return snprintf(data, dataSize, fmtStr, workers_.size(), machines_.load(), completed_.load(), slices_.load(), steals_.load(), cycles, seconds, seconds > 0 ? cycles / seconds : 0.0);
+		};
+
+		auto count = writeStats(nullptr, 0) + 1;
+		std::string stats(count, '\0');
+		writeStats(stats.data(), count);
+		// remove the null terminator
+		stats.pop_back();
+		return stats;
+	}
+} // namespace MachEmu
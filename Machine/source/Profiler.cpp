@@ -0,0 +1,198 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Machine/Profiler.h"
+
+namespace MachEmu
+{
+	// A hex address, optionally prefixed by 0x or $ or suffixed by h
+	static bool ParseAddress(std::string str, uint16_t& addr)
+	{
+		if (str.starts_with("0x") == true || str.starts_with("0X") == true)
+		{
+			str.erase(0, 2);
+		}
+		else if (str.starts_with("$") == true)
+		{
+			str.erase(0, 1);
+		}
+		else if (str.ends_with("h") == true || str.ends_with("H") == true)
+		{
+			str.pop_back();
+		}
+
+		if (str.empty() == true || str.size() > 4 || std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isxdigit(c) != 0; }) == false)
+		{
+			return false;
+		}
+
+		addr = static_cast<uint16_t>(std::stoul(str, nullptr, 16));
+		return true;
+	}
+
+	void Profiler::LoadSymbols(const std::string& path)
+	{
+		std::ifstream fin(path);
+
+		if (fin.is_open() == false)
+		{
+			throw std::runtime_error("Failed to open the symbol file " + path);
+		}
+
+		std::string line;
+		int lineNumber = 0;
+
+		while (std::getline(fin, line))
+		{
+			lineNumber++;
+			std::istringstream tokens(line);
+			std::string first;
+
+			// Blank lines and comments
+			if (!(tokens >> first) || first.starts_with(";") == true || first.starts_with("#") == true)
+			{
+				continue;
+			}
+
+			uint16_t addr = 0;
+			std::string second;
+			std::string third;
+			tokens >> second >> third;
+
+			// name = address, name equ address or address name
+			auto equ = second == "=" || second == "equ" || second == "EQU";
+
+			if (equ == true ? ParseAddress(third, addr) == false : ParseAddress(first, addr) == false || second.empty() == true)
+			{
+				throw std::invalid_argument(path + ":" + std::to_string(lineNumber) + " is not an address and a name");
+			}
+
+			if (equ == false)
+			{
+				first = second;
+			}
+
+			if (first.ends_with(":") == true)
+			{
+				first.pop_back();
+			}
+
+			// A collapsed stack is split on ; and terminated by a space
+			std::replace(first.begin(), first.end(), ';', '_');
+			symbols_[addr] = first;
+		}
+	}
+
+	std::string Profiler::Name(uint16_t addr) const
+	{
+		char buf[16];
+		auto symbol = symbols_.upper_bound(addr);
+
+		if (symbol == symbols_.begin())
+		{
+			snprintf(buf, sizeof(buf), "0x%04X", addr);
+			return buf;
+		}
+
+		symbol--;
+
+		if (symbol->first == addr)
+		{
+			return symbol->second;
+		}
+
+		snprintf(buf, sizeof(buf), "+0x%X", addr - symbol->first);
+		return symbol->second + buf;
+	}
+
+	void Profiler::Start(uint16_t entry, const std::string& symbols)
+	{
+		symbols_.clear();
+
+		if (symbols.empty() == false)
+		{
+			LoadSymbols(symbols);
+		}
+
+		stacks_.clear();
+		pcs_.assign(0x10000, 0);
+		samples_ = 0;
+		entry_ = entry;
+	}
+
+	void Profiler::Sample(std::span<const uint16_t> stack, uint64_t weight)
+	{
+		key_.assign(1, entry_);
+		key_.insert(key_.end(), stack.begin(), stack.end());
+		stacks_[key_] += weight;
+		pcs_[stack.back()] += weight;
+		samples_ += weight;
+	}
+
+	void Profiler::Write(const std::string& path) const
+	{
+		std::ofstream stacks(path);
+		std::ofstream pcs(path + ".pcs");
+
+		if (stacks.is_open() == false || pcs.is_open() == false)
+		{
+			throw std::runtime_error("Failed to open the profile file " + path);
+		}
+
+		for (const auto& [stack, count] : stacks_)
+		{
+			for (size_t i = 0; i < stack.size(); i++)
+			{
+				stacks << (i > 0 ? ";" : "") << Name(stack[i]);
+			}
+
+			stacks << " " << count << "\n";
+		}
+
+		std::vector<std::pair<uint64_t, uint16_t>> histogram;
+
+		for (size_t pc = 0; pc < pcs_.size(); pc++)
+		{
+			if (pcs_[pc] != 0)
+			{
+				histogram.emplace_back(pcs_[pc], static_cast<uint16_t>(pc));
+			}
+		}
+
+		// Hottest first, then by address
+		std::sort(histogram.begin(), histogram.end(), [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+
+		for (const auto& [count, pc] : histogram)
+		{
+			char buf[64];
+			snprintf(buf, sizeof(buf), "0x%04X %12llu %6.2f%% ", pc, static_cast<unsigned long long>(count), 100.0 * count / samples_);
+			pcs << buf << Name(pc) << "\n";
+		}
+	}
+} // namespace MachEmu
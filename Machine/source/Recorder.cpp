@@ -0,0 +1,202 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdexcept>
+
+#include "Machine/Recorder.h"
+
+namespace MachEmu
+{
+	void Recorder::AppendLeb128(uint64_t value)
+	{
+		do
+		{
+			auto byte = static_cast<uint8_t>(value & 0x7F);
+			value >>= 7;
+			log_.push_back(value != 0 ? byte | 0x80 : byte);
+		} while (value != 0);
+	}
+
+	void Recorder::Append(Type type, int64_t cycles)
+	{
+		log_.push_back(static_cast<uint8_t>(type));
+		AppendLeb128(cycles - lastCycles_);
+		lastCycles_ = cycles;
+	}
+
+	void Recorder::Record(const std::array<IController*, 256>* ports)
+	{
+		ports_ = ports;
+		log_.assign(magic_.begin(), magic_.end());
+		log_.push_back(version_);
+		lastCycles_ = 0;
+	}
+
+	void Recorder::Record(const std::array<IController*, 256>* ports, const Recorder& recorder)
+	{
+		ports_ = ports;
+		log_ = recorder.log_;
+		lastCycles_ = recorder.lastCycles_;
+	}
+
+	void Recorder::RecordInterrupt(int64_t cycles, ISR isr)
+	{
+		Append(Type::Interrupt, cycles);
+		log_.push_back(static_cast<uint8_t>(isr));
+	}
+
+	void Recorder::RecordIdle(int64_t cycles, int64_t ticks)
+	{
+		Append(Type::Idle, cycles);
+		AppendLeb128(ticks);
+	}
+
+	void Recorder::RecordQuit(int64_t cycles)
+	{
+		Append(Type::Quit, cycles);
+	}
+
+	std::span<const uint8_t> Recorder::Log() const
+	{
+		return log_;
+	}
+
+	void Recorder::Replay(std::span<const uint8_t> log)
+	{
+		if (log.size() < magic_.size() + 1 || std::string_view(reinterpret_cast<const char*>(log.data()), magic_.size()) != magic_ || log[magic_.size()] != version_)
+		{
+			throw std::invalid_argument("Invalid recording");
+		}
+
+		size_t pos = magic_.size() + 1;
+
+		auto byte = [&]
+		{
+			if (pos == log.size())
+			{
+				throw std::invalid_argument("Truncated recording");
+			}
+
+			return log[pos++];
+		};
+
+		auto leb128 = [&]
+		{
+			uint64_t value = 0;
+
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				auto b = byte();
+				value |= static_cast<uint64_t>(b & 0x7F) << shift;
+
+				if ((b & 0x80) == 0)
+				{
+					return value;
+				}
+			}
+
+			throw std::invalid_argument("Invalid recording");
+		};
+
+		std::vector<Event> events;
+		std::vector<std::pair<uint8_t, uint8_t>> reads;
+		int64_t cycles = 0;
+
+		while (pos < log.size())
+		{
+			auto type = static_cast<Type>(byte());
+
+			switch (type)
+			{
+				case Type::Read:
+				{
+					auto port = byte();
+					reads.emplace_back(port, byte());
+					break;
+				}
+				case Type::Interrupt:
+				{
+					cycles += leb128();
+					events.push_back({ cycles, type, byte() });
+					break;
+				}
+				case Type::Idle:
+				{
+					cycles += leb128();
+					events.push_back({ cycles, type, leb128() });
+					break;
+				}
+				case Type::Quit:
+				{
+					cycles += leb128();
+					events.push_back({ cycles, type, 0 });
+					break;
+				}
+				default:
+				{
+					throw std::invalid_argument("Invalid recording");
+				}
+			}
+		}
+
+		ports_ = nullptr;
+		events_ = std::move(events);
+		reads_ = std::move(reads);
+		Rewind();
+	}
+
+	void Recorder::Rewind()
+	{
+		nextEvent_ = 0;
+		nextRead_ = 0;
+	}
+
+	uint8_t Recorder::Read(uint16_t port)
+	{
+		if (ports_ != nullptr)
+		{
+			auto value = (*ports_)[port & 0xFF]->Read(port);
+			log_.insert(log_.end(), { static_cast<uint8_t>(Type::Read), static_cast<uint8_t>(port), value });
+			return value;
+		}
+
+		if (nextRead_ == reads_.size() || reads_[nextRead_].first != static_cast<uint8_t>(port))
+		{
+			throw std::runtime_error("The replay has diverged from the recording");
+		}
+
+		return reads_[nextRead_++].second;
+	}
+
+	void Recorder::Write(uint16_t port, uint8_t value)
+	{
+		if (ports_ != nullptr)
+		{
+			(*ports_)[port & 0xFF]->Write(port, value);
+		}
+	}
+
+	ISR Recorder::ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles)
+	{
+		return ISR::NoInterrupt;
+	}
+} // namespace MachEmu
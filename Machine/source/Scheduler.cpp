@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "Machine/Scheduler.h"
+
+namespace MachEmu
+{
+	Scheduler::Scheduler(const int64_t& totalTicks, const std::chrono::nanoseconds& currTime)
+		: totalTicks_(totalTicks), currTime_(currTime)
+	{
+
+	}
+
+	void Scheduler::Reset(double cpuFrequency)
+	{
+		events_ = {};
+		sequence_ = 0;
+		raised_ = false;
+		ticksPerNs_ = cpuFrequency / 1e9;
+	}
+
+	void Scheduler::Copy(const Scheduler& scheduler)
+	{
+		events_ = scheduler.events_;
+		sequence_ = scheduler.sequence_;
+		raised_ = scheduler.raised_.load();
+		ticksPerNs_ = scheduler.ticksPerNs_;
+	}
+
+	ISR Scheduler::Pop()
+	{
+		auto isr = events_.top().isr;
+		events_.pop();
+		return isr;
+	}
+
+	void Scheduler::ScheduleCycles(uint64_t cycles, ISR isr)
+	{
+		auto due = static_cast<int64_t>(std::min<uint64_t>(cycles, std::numeric_limits<int64_t>::max()));
+		events_.push({ due, sequence_++, isr });
+	}
+
+	void Scheduler::ScheduleTime(uint64_t time, ISR isr)
+	{
+		auto now = static_cast<uint64_t>(currTime_.count());
+		// The time is in the past, it is due now
+		auto cycles = static_cast<uint64_t>(totalTicks_);
+
+		if (time > now)
+		{
+			auto ticks = std::ceil((time - now) * ticksPerNs_);
+			cycles = ticks >= static_cast<double>(std::numeric_limits<int64_t>::max() - totalTicks_) ? std::numeric_limits<int64_t>::max() : cycles + static_cast<uint64_t>(ticks);
+		}
+
+		ScheduleCycles(cycles, isr);
+	}
+
+	void Scheduler::Raise()
+	{
+		raised_.store(true, std::memory_order_release);
+	}
+} // namespace MachEmu
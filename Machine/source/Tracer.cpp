@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <chrono>
+#include <stdexcept>
+
+#include "Machine/Tracer.h"
+
+namespace MachEmu
+{
+	Tracer::~Tracer()
+	{
+		Stop();
+	}
+
+	void Tracer::Start(const std::string& path)
+	{
+		Stop();
+
+		file_.open(path, std::ios::binary | std::ios::trunc);
+
+		if (file_.is_open() == false)
+		{
+			throw std::runtime_error("Failed to open the trace file " + path);
+		}
+
+		uint16_t header[2] = { version_, sizeof(TraceRecord) };
+		file_.write(magic_.data(), magic_.size());
+		file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+		if (buffer_ == nullptr)
+		{
+			buffer_ = std::make_unique<TraceBuffer>(totalTicks_);
+		}
+
+		buffer_->Reset();
+		stop_ = false;
+		thread_ = std::thread([this] { Drain(); });
+	}
+
+	void Tracer::Stop()
+	{
+		if (thread_.joinable() == true)
+		{
+			stop_ = true;
+			thread_.join();
+			file_.close();
+		}
+	}
+
+	void Tracer::Drain()
+	{
+		auto write = [this](std::span<const TraceRecord> records)
+		{
+			file_.write(reinterpret_cast<const char*>(records.data()), records.size_bytes());
+		};
+
+		while (stop_ == false)
+		{
+			// Back off while the cpu is idle, the ring holds enough records for the wait
+			if (buffer_->Drain(write) == 0)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		}
+
+		// The cpu has stopped, write out what remains
+		buffer_->Drain(write);
+	}
+} // namespace MachEmu
@@ -11,6 +11,9 @@ namespace MachEmu
         void Write(uint16_t address, uint8_t value) final;
         MachEmu::ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final;
         std::array<uint8_t, 16> Uuid() const final;
+        std::array<uint8_t, 16> RomMd5() const final;
+        uint64_t NextInterrupt(uint64_t currTime, uint64_t cycles) const final;
+        bool Schedule(MachEmu::IScheduler* scheduler) final;
     };
 } // namespace MachEmu
 
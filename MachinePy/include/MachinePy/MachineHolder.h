@@ -17,10 +17,13 @@ namespace MachEmu
 
         void OnLoad(std::function<std::string()>&& onLoad);
         void OnSave(std::function<void(std::string&&)>&& onSave);
+        std::string GetPerfCounters() const;
+        std::string GetClockTelemetry() const;
         uint64_t Run(uint16_t offset);
         std::string Save() const;
         ErrorCode SetClockResolution(int64_t clockResolution);
         void SetIoController(MachEmu::IController* controller);
+        void AddIoController(MachEmu::IController* controller, uint8_t firstPort, uint8_t lastPort);
         void SetMemoryController(MachEmu::IController* controller);
         ErrorCode SetOptions(const char* options);
         uint64_t WaitForCompletion();
@@ -47,4 +47,36 @@ namespace MachEmu
             Uuid                /* Name of function in C++ (must match Python name) */
         );
     }
+
+    std::array<uint8_t, 16> ControllerPy::RomMd5() const
+    {
+        using Uint8Array16 = std::array<uint8_t, 16>;
+
+        PYBIND11_OVERRIDE(
+            Uint8Array16,       /* Return type */
+            IController,        /* Parent class */
+            RomMd5              /* Name of function in C++ (must match Python name) */
+        );
+    }
+
+    uint64_t ControllerPy::NextInterrupt(uint64_t currTime, uint64_t cycles) const
+    {
+        PYBIND11_OVERRIDE(
+            uint64_t,           /* Return type */
+            IController,        /* Parent class */
+            NextInterrupt,      /* Name of function in C++ (must match Python name) */
+            currTime,           /* Argument(s) */
+            cycles
+        );
+    }
+
+    bool ControllerPy::Schedule(MachEmu::IScheduler* scheduler)
+    {
+        PYBIND11_OVERRIDE(
+            bool,               /* Return type */
+            IController,        /* Parent class */
+            Schedule,           /* Name of function in C++ (must match Python name) */
+            scheduler           /* Argument(s) */
+        );
+    }
 }
\ No newline at end of file
@@ -46,6 +46,16 @@ namespace MachEmu
 		return machine_->Save();
 	}
 
+	std::string MachineHolder::GetPerfCounters() const
+	{
+		return machine_->GetPerfCounters();
+	}
+
+	std::string MachineHolder::GetClockTelemetry() const
+	{
+		return machine_->GetClockTelemetry();
+	}
+
 	uint64_t MachineHolder::Run(uint16_t offset)
 	{
 		return machine_->Run(offset);
@@ -57,6 +67,11 @@ namespace MachEmu
 		machine_->SetIoController(std::shared_ptr<MachEmu::IController>(controller, [](MachEmu::IController*) {}));
 	}
 
+	void MachineHolder::AddIoController(MachEmu::IController* controller, uint8_t firstPort, uint8_t lastPort)
+	{
+		machine_->AddIoController(std::shared_ptr<MachEmu::IController>(controller, [](MachEmu::IController*) {}), firstPort, lastPort);
+	}
+
 	void MachineHolder::SetMemoryController(MachEmu::IController* controller)
 	{
 		machine_->SetMemoryController(std::shared_ptr<MachEmu::IController>(controller, [](MachEmu::IController*) {}));
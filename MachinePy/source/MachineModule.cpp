@@ -43,12 +43,15 @@ PYBIND11_MODULE(mach_emuPy, MachEmu)
     py::class_<MachEmu::MachineHolder>(MachEmu, "MakeMachine")
         .def(py::init<>())
         .def(py::init<const char*>())
+        .def("GetClockTelemetry", &MachEmu::MachineHolder::GetClockTelemetry)
+        .def("GetPerfCounters", &MachEmu::MachineHolder::GetPerfCounters)
         .def("OnLoad", &MachEmu::MachineHolder::OnLoad)
         .def("OnSave", &MachEmu::MachineHolder::OnSave)
         .def("Run", &MachEmu::MachineHolder::Run)
         .def("Save", &MachEmu::MachineHolder::Save)
         .def("SetClockResolution", &MachEmu::MachineHolder::SetClockResolution)
         .def("SetIoController", &MachEmu::MachineHolder::SetIoController)
+        .def("AddIoController", &MachEmu::MachineHolder::AddIoController)
         .def("SetMemoryController", &MachEmu::MachineHolder::SetMemoryController)
         .def("SetOptions", &MachEmu::MachineHolder::SetOptions)
         .def("WaitForCompletion", &MachEmu::MachineHolder::WaitForCompletion);
@@ -64,10 +67,18 @@ PYBIND11_MODULE(mach_emuPy, MachEmu)
         .def("WaitForCompletion", &MachEmu::IMachine::WaitForCompletion);
 #endif
 
+    py::class_<MachEmu::IScheduler>(MachEmu, "Scheduler")
+        .def("ScheduleCycles", &MachEmu::IScheduler::ScheduleCycles)
+        .def("ScheduleTime", &MachEmu::IScheduler::ScheduleTime)
+        .def("Raise", &MachEmu::IScheduler::Raise);
+
     py::class_<MachEmu::IController, MachEmu::ControllerPy>(MachEmu, "Controller")
         .def(py::init<>())
         .def("Read", &MachEmu::IController::Read)
         .def("Write", &MachEmu::IController::Write)
         .def("ServiceInterrupts", &MachEmu::IController::ServiceInterrupts)
-        .def("Uuid", &MachEmu::IController::Uuid);
+        .def("Uuid", &MachEmu::IController::Uuid)
+        .def("RomMd5", &MachEmu::IController::RomMd5)
+        .def("NextInterrupt", &MachEmu::IController::NextInterrupt)
+        .def("Schedule", &MachEmu::IController::Schedule);
 }
@@ -72,16 +72,35 @@ namespace MachEmu
 
 				@throws		std::runtime_error if the cpu option is specified.
 
-				@throws		std::invalid_argument if the interrupt service routine frequency is negative.
+				@throws		std::invalid_argument if the interrupt service routine frequency, the clock spin or the number of delta saves
+							is negative, the cpu frequency or the profile interval is not positive or the clock is not supported.
 			*/
 			ErrorCode SetOptions(const char* json);
 
+			/** All options
+
+				The current options as a json string, it can be passed to SetOptions.
+			*/
+			std::string Options() const;
+
+			/** Clock time source
+
+				Supported time sources, "host" (steady clock) and "virtual" (derived from the elapsed cpu cycles).
+			*/
+			std::string Clock() const;
+
 			/**	Clock resolution
 
 				The frequency at which the internal clock ticks.
 			*/
 			int64_t ClockResolution() const;
 
+			/** Clock spin
+
+				The maximum time in nanoseconds the clock spins at the end of each resolution slice.
+			*/
+			int64_t ClockSpin() const;
+
 			/** Compressor
 
 				Supported compressors, currently only zlib is supported.
@@ -94,6 +113,25 @@ namespace MachEmu
 			*/
 			std::string CpuType() const;
 
+			/** Cpu frequency
+
+				The cpu clock speed in ticks per second.
+			*/
+			uint64_t CpuFrequency() const;
+
+			/** Delta saves
+
+				The number of binary delta save states to write between full binary save states,
+				0 disables delta save states.
+			*/
+			uint32_t DeltaSaves() const;
+
+			/** Instruction dispatcher
+
+				Supported dispatchers, "switch" (portable) and "threaded" (labels as values).
+			*/
+			std::string Dispatcher() const;
+
 			/** Text to binary encoder
 
 				Supported encoders, currently only base64 is supported.
@@ -113,6 +151,24 @@ namespace MachEmu
 			*/
 			bool LoadAsync() const;
 
+			/** Guest profile file
+
+				The file the collapsed call stacks sampled while the machine runs are written to, empty when profiling is disabled.
+			*/
+			std::string Profile() const;
+
+			/** Guest profile sample interval
+
+				The number of cpu cycles between samples of the guest call stack.
+			*/
+			int64_t ProfileInterval() const;
+
+			/** Guest profile symbols
+
+				The file mapping guest addresses to function names, empty when the profile names the addresses.
+			*/
+			std::string ProfileSymbols() const;
+
 			/** Ram metadata
 			
 				This vector defines blocks of ram.
@@ -142,6 +198,12 @@ namespace MachEmu
 				True for asynchronous, false for synchronous.
 			*/
 			bool SaveAsync() const;
+
+			/** Instruction trace file
+
+				The file the instruction trace is written to when the machine runs, empty when tracing is disabled.
+			*/
+			std::string Trace() const;
 	};
 } // namespace MachEmu
 
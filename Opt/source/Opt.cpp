@@ -50,13 +50,13 @@ namespace MachEmu
 
 	constexpr std::string Opt::DefaultOpts()
 	{
-		std::string defaults =	R"({"clockResolution":-1,"compressor":")"
+		std::string defaults =	R"({"clock":"host","clockResolution":-1,"clockSpin":50000,"compressor":")"
 #ifdef ENABLE_ZLIB
 								"zlib"
 #else
 								"none"
 #endif
-								R"(","encoder":"base64","isrFreq":0,"loadAsync":false,"rom":{"file":[{"offset":0,"size":0}]},"ram":{"block":[{"offset":0,"size":0}]},"runAsync":false,"saveAsync":false})";
+								R"(","cpuFrequency":2000000,"deltaSaves":0,"encoder":"base64","isrFreq":0,"loadAsync":false,"profile":"","profileInterval":10000,"profileSymbols":"","rom":{"file":[{"offset":0,"size":0}]},"ram":{"block":[{"offset":0,"size":0}]},"runAsync":false,"saveAsync":false,"trace":""})";
 		return defaults;
 	}
 
@@ -90,11 +90,56 @@ namespace MachEmu
 				throw std::runtime_error("cpu type has already been set");
 			}
 
+			if (json_->contains("dispatcher") == true && json.contains("dispatcher") == true)
+			{
+				throw std::runtime_error("dispatcher has already been set");
+			}
+
+			if (json.contains("dispatcher") == true && json["dispatcher"].get<std::string>() != "switch" && json["dispatcher"].get<std::string>() != "threaded" && json["dispatcher"].get<std::string>() != "cached" && json["dispatcher"].get<std::string>() != "jit" && json["dispatcher"].get<std::string>() != "aot")
+			{
+				throw std::invalid_argument("dispatcher must be switch, threaded, cached, jit or aot");
+			}
+
+			// The other dispatchers don't execute one instruction at a time where a trace record can be written
+			auto dispatcher = json.contains("dispatcher") == true ? json["dispatcher"].get<std::string>() : json_->value("dispatcher", "");
+			auto trace = json.contains("trace") == true ? json["trace"].get<std::string>() : json_->value("trace", "");
+
+			if (trace.empty() == false && dispatcher.empty() == false && dispatcher != "switch" && dispatcher != "cached")
+			{
+				throw std::invalid_argument("trace is only supported by the switch and cached dispatchers");
+			}
+
+			if (json.contains("clock") == true && json["clock"].get<std::string>() != "host" && json["clock"].get<std::string>() != "virtual")
+			{
+				throw std::invalid_argument("clock must be host or virtual");
+			}
+
+			if (json.contains("clockSpin") == true && json["clockSpin"].get<int64_t>() < 0)
+			{
+				throw std::invalid_argument("clockSpin must be >= 0");
+			}
+
+			// bounded so the clock's tick to nanosecond conversions can't overflow
+			if (json.contains("cpuFrequency") == true && (json["cpuFrequency"].get<int64_t>() <= 0 || json["cpuFrequency"].get<int64_t>() > 10000000000))
+			{
+				throw std::invalid_argument("cpuFrequency must be > 0 and <= 10000000000");
+			}
+
+			if (json.contains("deltaSaves") == true && json["deltaSaves"].get<int64_t>() < 0)
+			{
+				throw std::invalid_argument("deltaSaves must be >= 0");
+			}
+
 			if (json.contains("isrFreq") == true && json["isrFreq"].get<double>() < 0)
 			{
 				throw std::invalid_argument("isrFreq must be >= 0");
 			}
 
+			if (json.contains("profileInterval") == true && json["profileInterval"].get<int64_t>() <= 0)
+			{
+				throw std::invalid_argument("profileInterval must be > 0");
+			}
+
 #ifndef ENABLE_ZLIB
 			if (json.contains("compressor") == true && json["compressor"].get<std::string>() == "zlib")
 			{
@@ -147,11 +192,26 @@ namespace MachEmu
 		return err;
 	}
 
+	std::string Opt::Options() const
+	{
+		return json_->dump();
+	}
+
+	std::string Opt::Clock() const
+	{
+		return (*json_)["clock"].get<std::string>();
+	}
+
 	int64_t Opt::ClockResolution() const
 	{
 		return (*json_)["clockResolution"].get<int64_t>();
 	}
 
+	int64_t Opt::ClockSpin() const
+	{
+		return (*json_)["clockSpin"].get<int64_t>();
+	}
+
 	std::string Opt::Compressor() const
 	{
 		return (*json_)["compressor"].get<std::string>();
@@ -169,6 +229,28 @@ namespace MachEmu
 		}
 	}
 
+	uint64_t Opt::CpuFrequency() const
+	{
+		return (*json_)["cpuFrequency"].get<uint64_t>();
+	}
+
+	uint32_t Opt::DeltaSaves() const
+	{
+		return (*json_)["deltaSaves"].get<uint32_t>();
+	}
+
+	std::string Opt::Dispatcher() const
+	{
+		if (json_->contains("dispatcher") == true)
+		{
+			return (*json_)["dispatcher"].get<std::string>();
+		}
+		else
+		{
+			return "";
+		}
+	}
+
 	std::string Opt::Encoder() const
 	{
 		return (*json_)["encoder"].get<std::string>();
@@ -184,6 +266,21 @@ namespace MachEmu
 		return (*json_)["loadAsync"].get<bool>();
 	}
 
+	std::string Opt::Profile() const
+	{
+		return (*json_)["profile"].get<std::string>();
+	}
+
+	int64_t Opt::ProfileInterval() const
+	{
+		return (*json_)["profileInterval"].get<int64_t>();
+	}
+
+	std::string Opt::ProfileSymbols() const
+	{
+		return (*json_)["profileSymbols"].get<std::string>();
+	}
+
 	std::vector<std::pair<uint16_t, uint16_t>> Opt::Ram() const
 	{
 		std::vector<std::pair<uint16_t, uint16_t>> ram;
@@ -219,4 +316,9 @@ namespace MachEmu
 	{
 		return (*json_)["saveAsync"].get<bool>();
 	}
+
+	std::string Opt::Trace() const
+	{
+		return (*json_)["trace"].get<std::string>();
+	}
 } // namespace MachEmu
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef RECOMPILER_H
+#define RECOMPILER_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace MachEmu
+{
+	/** 8080 static recompiler
+
+		Translates the code of a fixed image (a rom or a cp/m utility) into C++ ahead of time.
+		The control flow is recovered by following the jumps, calls and restarts from each
+		entry point, every address which can start a basic block is decoded into a block with
+		the same boundaries as the blocks of the cached dispatchers (see 8080Opcodes.h).
+
+		Each block is emitted as an initialiser of Intel8080::RecompiledBlock which calls the
+		instruction handlers of the interpreter, so the recompiled code has the same bus and
+		controller semantics and cycle counts. Code reached via an indirect jump (pchl) or a
+		return which isn't preceded by a call isn't discovered and is left to the interpreter.
+	*/
+	class Recompiler final
+	{
+	private:
+		struct Op
+		{
+			uint8_t opcode;
+			uint16_t operand;
+		};
+
+		struct Block
+		{
+			std::vector<Op> ops;
+			//The address following the last instruction.
+			uint32_t end;
+		};
+
+		std::vector<uint8_t> image_;
+		uint16_t loadAddress_{};
+		std::map<uint16_t, Block> blocks_;
+
+		//true when the instruction at addr lies wholly within the image.
+		bool Contains(uint32_t addr, uint8_t length) const;
+		//Decode the block starting at pc, the block is empty when pc isn't in the image.
+		Block Decode(uint16_t pc) const;
+
+	public:
+		/** Load an image
+
+			@param	image			The contents of the image.
+			@param	loadAddress		The address the image is loaded at.
+
+			@throws	std::invalid_argument if the image is empty or doesn't fit in the address space.
+		*/
+		Recompiler(std::vector<uint8_t>&& image, uint16_t loadAddress);
+
+		/** Recover the control flow
+
+			@param	entryPoints		The addresses execution starts at, usually the load address.
+
+			@throws	std::invalid_argument if an entry point doesn't address the image.
+		*/
+		void Analyse(const std::vector<uint16_t>& entryPoints);
+
+		/** The number of blocks discovered by Analyse
+		*/
+		size_t Blocks() const { return blocks_.size(); }
+
+		/** Write the recompiled blocks
+
+			@param	os		The stream to write the C++ initialisers to.
+			@param	name	The name of the image, written to the header comment.
+		*/
+		void Emit(std::ostream& os, std::string_view name) const;
+	};
+} // namespace MachEmu
+
+#endif // RECOMPILER_H
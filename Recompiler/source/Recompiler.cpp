@@ -0,0 +1,200 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "Cpu/8080Opcodes.h"
+#include "Recompiler/Recompiler.h"
+
+namespace MachEmu
+{
+	static std::string Hex(uint32_t value, int digits)
+	{
+		char hex[8]{};
+		snprintf(hex, sizeof(hex), "0x%0*X", digits, value);
+		return hex;
+	}
+
+	Recompiler::Recompiler(std::vector<uint8_t>&& image, uint16_t loadAddress)
+		: image_(std::move(image)),
+		loadAddress_(loadAddress)
+	{
+		if (image_.empty() == true || loadAddress_ + image_.size() > 0x10000)
+		{
+			throw std::invalid_argument("The image must not be empty and must fit in the address space");
+		}
+	}
+
+	bool Recompiler::Contains(uint32_t addr, uint8_t length) const
+	{
+		return addr >= loadAddress_ && addr + length <= loadAddress_ + image_.size();
+	}
+
+	Recompiler::Block Recompiler::Decode(uint16_t pc) const
+	{
+		Block block{ {}, pc };
+
+		// The same rules as Intel8080::DecodeBlock, although a block is cut short at the end of the image
+		while (block.ops.size() < Opcodes8080::maxBlockOps && Contains(block.end, 1) == true)
+		{
+			auto opcode = image_[block.end - loadAddress_];
+			auto length = Opcodes8080::length[opcode];
+
+			if (Contains(block.end, length) == false)
+			{
+				break;
+			}
+
+			uint16_t operand = 0;
+
+			if (length == 2)
+			{
+				operand = image_[block.end + 1 - loadAddress_];
+			}
+			else if (length == 3)
+			{
+				operand = (image_[block.end + 2 - loadAddress_] << 8) | image_[block.end + 1 - loadAddress_];
+			}
+
+			block.ops.push_back({ opcode, operand });
+			block.end += length;
+
+			if (Opcodes8080::endsBlock[opcode] == true)
+			{
+				break;
+			}
+		}
+
+		return block;
+	}
+
+	void Recompiler::Analyse(const std::vector<uint16_t>& entryPoints)
+	{
+		std::vector<uint32_t> pending;
+
+		for (auto entryPoint : entryPoints)
+		{
+			if (Contains(entryPoint, 1) == false)
+			{
+				throw std::invalid_argument("The entry point " + Hex(entryPoint, 4) + " doesn't address the image");
+			}
+
+			pending.push_back(entryPoint);
+		}
+
+		while (pending.empty() == false)
+		{
+			auto pc = pending.back();
+			pending.pop_back();
+
+			if (Contains(pc, 1) == false || blocks_.contains(pc) == true)
+			{
+				continue;
+			}
+
+			auto block = Decode(pc);
+
+			if (block.ops.empty() == true)
+			{
+				continue;
+			}
+
+			auto [opcode, operand] = block.ops.back();
+
+			if (Opcodes8080::endsBlock[opcode] == false)
+			{
+				// Cut short by the maximum block size
+				pending.push_back(block.end);
+			}
+			else if (opcode == 0xC3 || (opcode & 0xC7) == 0xC2)
+			{
+				// jmp, jcc
+				pending.push_back(operand);
+
+				if (opcode != 0xC3)
+				{
+					pending.push_back(block.end);
+				}
+			}
+			else if (opcode == 0xCD || (opcode & 0xC7) == 0xC4)
+			{
+				// call, ccc, execution resumes after the call when it returns
+				pending.push_back(operand);
+				pending.push_back(block.end);
+			}
+			else if ((opcode & 0xC7) == 0xC7)
+			{
+				// rst
+				pending.push_back(opcode & 0x38);
+				pending.push_back(block.end);
+			}
+			else if ((opcode & 0xC7) == 0xC0 || opcode == 0x76 || opcode == 0xD3 || opcode == 0xDB || opcode == 0xF3 || opcode == 0xFB)
+			{
+				// rcc, hlt, io and interrupt enable/disable continue with the next instruction
+				pending.push_back(block.end);
+			}
+
+			// The targets of ret and pchl aren't known, the undocumented opcodes are left to the interpreter
+			blocks_.emplace(pc, std::move(block));
+		}
+	}
+
+	void Recompiler::Emit(std::ostream& os, std::string_view name) const
+	{
+		os << "// " << blocks_.size() << " blocks recompiled from " << name << ", generated by the Recompiler, do not edit.\n";
+
+		for (const auto& [pc, block] : blocks_)
+		{
+			os << "{ " << Hex(pc, 4) << ", {";
+
+			for (uint32_t addr = pc; addr < block.end; addr++)
+			{
+				os << (addr == pc ? " " : ", ") << Hex(image_[addr - loadAddress_], 2);
+			}
+
+			os << " }, " << block.ops.size() << ", [](Intel8080* cpu) -> int64_t\n";
+			os << "\t{\n";
+			os << "\t\tint64_t ticks = 0;\n";
+
+			for (size_t i = 0; i < block.ops.size(); i++)
+			{
+				const auto& op = block.ops[i];
+				os << "\t\tticks += cpu->RecompiledOp<" << Hex(op.opcode, 2) << ">(" << Hex(op.operand, 4) << ");\n";
+
+				// Self modifying code, the rest of the block may no longer be valid
+				if (Opcodes8080::writesMemory[op.opcode] == true && i + 1 < block.ops.size())
+				{
+					os << "\n\t\tif (cpu->jitBlock_->valid == false)\n";
+					os << "\t\t{\n";
+					os << "\t\t\treturn ticks;\n";
+					os << "\t\t}\n\n";
+				}
+			}
+
+			os << "\t\treturn ticks;\n";
+			os << "\t}\n";
+			os << "},\n";
+		}
+	}
+} // namespace MachEmu
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdio>
+#include <stdexcept>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Recompiler/Recompiler.h"
+
+// Recompiler <image> <output> <load address> [entry point...]
+//
+// Translate the code of an 8080 image to the C++ blocks executed by the aot dispatcher,
+// execution starts at the load address when no entry points are given.
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		fprintf(stderr, "usage: %s <image> <output> <load address> [entry point...]\n", argv[0]);
+		return 1;
+	}
+
+	try
+	{
+		std::ifstream fin(argv[1], std::ios::binary);
+
+		if (fin.is_open() == false)
+		{
+			throw std::runtime_error(std::string("Failed to open ") + argv[1]);
+		}
+
+		std::vector<uint8_t> image{ std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>() };
+		auto loadAddress = static_cast<uint16_t>(std::stoul(argv[3], nullptr, 0));
+		std::vector<uint16_t> entryPoints;
+
+		for (int i = 4; i < argc; i++)
+		{
+			entryPoints.push_back(static_cast<uint16_t>(std::stoul(argv[i], nullptr, 0)));
+		}
+
+		if (entryPoints.empty() == true)
+		{
+			entryPoints.push_back(loadAddress);
+		}
+
+		MachEmu::Recompiler recompiler(std::move(image), loadAddress);
+		recompiler.Analyse(entryPoints);
+
+		std::ofstream fout(argv[2]);
+
+		if (fout.is_open() == false)
+		{
+			throw std::runtime_error(std::string("Failed to open ") + argv[2]);
+		}
+
+		std::string name = argv[1];
+		recompiler.Emit(fout, name.substr(name.find_last_of("/\\") + 1));
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s: %s\n", argv[0], e.what());
+		return 1;
+	}
+
+	return 0;
+}
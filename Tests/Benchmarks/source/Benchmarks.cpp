@@ -0,0 +1,444 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "Controller/IController.h"
+#include "Machine/IMachine.h"
+#include "Machine/MachineFactory.h"
+#include "TestControllers/CpmIoController.h"
+#include "TestControllers/MemoryController.h"
+#include "TestControllers/TestIoController.h"
+
+namespace MachEmu::Benchmarks
+{
+	static std::string programsDir = PROGRAMS_DIR;
+
+	/** Save load io controller
+
+		Requests a machine save (or load) every other time interrupts are serviced,
+		the machine completes the outstanding request on the service period in between.
+	*/
+	class SaveLoadIoController final : public IController
+	{
+	private:
+		ISR isr_;
+		//cppcheck-suppress unusedStructMember
+		bool request_{};
+	public:
+		explicit SaveLoadIoController(ISR isr) : isr_(isr) {}
+
+		uint8_t Read([[maybe_unused]] uint16_t port) final { return 0; }
+		void Write([[maybe_unused]] uint16_t port, [[maybe_unused]] uint8_t value) final {}
+
+		ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final
+		{
+			request_ = !request_;
+			return request_ == true ? isr_ : ISR::NoInterrupt;
+		}
+
+		std::array<uint8_t, 16> Uuid() const final
+		{
+			return{ 0x6B, 0x0E, 0x2C, 0x51, 0x93, 0x7F, 0x4A, 0x3D, 0xB1, 0x58, 0x0C, 0xE4, 0x27, 0x9A, 0xD6, 0x15 };
+		}
+	};
+
+	// Load a program at 0x100 along with the CP/M warm boot (exitTest) and BDOS print message (bdosMsg) subroutines.
+	static std::shared_ptr<MemoryController> LoadProgram(const std::string& name)
+	{
+		auto memoryController = std::make_shared<MemoryController>();
+		memoryController->Load((programsDir + "exitTest.bin").c_str(), 0x00);
+		memoryController->Load((programsDir + "bdosMsg.bin").c_str(), 0x05);
+		memoryController->Load((programsDir + name).c_str(), 0x100);
+		return memoryController;
+	}
+
+	// Run the machine until the io controller powers it off, returns the number of cycles executed.
+	static int64_t RunToCompletion(IMachine& machine, uint16_t pc)
+	{
+		bool quit = false;
+		int64_t cycles = 0;
+
+		while (quit == false)
+		{
+			cycles += machine.RunFor(std::numeric_limits<int64_t>::max(), pc, &quit);
+		}
+
+		return cycles;
+	}
+
+	// The number of instructions executed by the last run, only available when the library is built with performance counters.
+	static uint64_t Instructions([[maybe_unused]] const IMachine& machine)
+	{
+		uint64_t instructions = 0;
+#ifdef ENABLE_PERF_COUNTERS
+		auto counters = nlohmann::json::parse(machine.GetPerfCounters());
+
+		for (const auto& count : counters["cpu"]["instructions"])
+		{
+			instructions += count.get<uint64_t>();
+		}
+#endif
+		return instructions;
+	}
+
+	static void SetRateCounters(benchmark::State& state, int64_t cycles, uint64_t instructions)
+	{
+		state.counters["cyclesPerSecond"] = benchmark::Counter(static_cast<double>(cycles), benchmark::Counter::kIsRate);
+#ifdef ENABLE_PERF_COUNTERS
+		state.counters["MIPS"] = benchmark::Counter(instructions / 1e6, benchmark::Counter::kIsRate);
+#else
+		static_cast<void>(instructions);
+#endif
+	}
+
+	/** CP/M program benchmark
+
+		Runs one of the cpu test suite programs to completion, the program is reloaded between iterations
+		as the test suites are free to modify themselves. The machine is made with the given options, if any.
+	*/
+	static void CpmProgram(benchmark::State& state, const std::string& name, const std::string& options)
+	{
+		auto machine = MakeMachine(options.empty() == true ? nullptr : options.c_str());
+		auto memoryController = LoadProgram(name);
+		auto ioController = std::make_shared<CpmIoController>(static_pointer_cast<IController>(memoryController));
+		int64_t cycles = 0;
+		uint64_t instructions = 0;
+
+		machine->SetMemoryController(memoryController);
+		machine->SetIoController(ioController);
+
+		for (auto _ : state)
+		{
+			cycles += RunToCompletion(*machine, 0x100);
+
+			state.PauseTiming();
+			instructions += Instructions(*machine);
+			ioController->Message();
+			memoryController->Clear();
+			memoryController->Load((programsDir + "exitTest.bin").c_str(), 0x00);
+			memoryController->Load((programsDir + "bdosMsg.bin").c_str(), 0x05);
+			memoryController->Load((programsDir + name).c_str(), 0x100);
+			state.ResumeTiming();
+		}
+
+		SetRateCounters(state, cycles, instructions);
+	}
+
+	/** Opcode class benchmark
+
+		Runs each of the single instruction programs that belong to an opcode class to completion,
+		an item is one program run (including restoring the program bytes).
+	*/
+	static void OpcodeClass(benchmark::State& state, const std::vector<std::string>& programs)
+	{
+		auto machine = MakeMachine();
+		std::vector<std::pair<std::shared_ptr<MemoryController>, std::vector<uint8_t>>> memoryControllers;
+		int64_t cycles = 0;
+		uint64_t instructions = 0;
+
+		for (const auto& program : programs)
+		{
+			std::ifstream file(programsDir + program + ".bin", std::ios::binary);
+			memoryControllers.emplace_back(LoadProgram(program + ".bin"), std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {}));
+		}
+
+		machine->SetIoController(std::make_shared<TestIoController>());
+
+		for (auto _ : state)
+		{
+			for (const auto& [memoryController, program] : memoryControllers)
+			{
+				// Some of the programs modify themselves (inrm for example), restore them before each run
+				for (size_t i = 0; i < program.size(); i++)
+				{
+					memoryController->Write(static_cast<uint16_t>(0x100 + i), program[i]);
+				}
+
+				machine->SetMemoryController(memoryController);
+				cycles += RunToCompletion(*machine, 0x100);
+				instructions += Instructions(*machine);
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * memoryControllers.size());
+		SetRateCounters(state, cycles, instructions);
+	}
+
+	/** Io access benchmark
+
+		Runs an in, out, jmp loop for 30000 cycles (1000 loops) per iteration, each in and out is
+		a direct call on the io controller which owns the port. Items processed is the number of
+		io accesses, every one of them also returns control to the machine.
+	*/
+	static void IoAccess(benchmark::State& state)
+	{
+		auto machine = MakeMachine();
+		auto memoryController = std::make_shared<MemoryController>();
+		int64_t cycles = 0;
+
+		// 0x100: in 0x00, out 0x00, jmp 0x100
+		for (uint16_t addr = 0x100; const auto byte : { 0xDB, 0x00, 0xD3, 0x00, 0xC3, 0x00, 0x01 })
+		{
+			memoryController->Write(addr++, byte);
+		}
+
+		machine->SetMemoryController(memoryController);
+		machine->SetIoController(std::make_shared<TestIoController>());
+
+		for (auto _ : state)
+		{
+			cycles += machine->RunFor(30000, 0x100, nullptr);
+		}
+
+		state.SetItemsProcessed(cycles / 15);
+		SetRateCounters(state, cycles, 0);
+	}
+
+	static std::string RamOptions(int64_t ramSize)
+	{
+		return R"({"rom":{"file":[{"offset":0,"size":256}]},"ram":{"block":[{"offset":32768,"size":)" + std::to_string(ramSize) + "}]}}";
+	}
+
+	/** OnSave benchmark
+
+		Measures the latency of a machine save, from the io controller request until the OnSave handler
+		receives the json (or binary) state, with a ram size of state.range(0) bytes. Bytes processed is
+		the size of the state.
+	*/
+	static void OnSave(benchmark::State& state, bool binary)
+	{
+		auto machine = MakeMachine(RamOptions(state.range(0)).c_str());
+		size_t bytes = 0;
+
+		machine->SetMemoryController(LoadProgram("nopStart.bin"));
+		machine->SetIoController(std::make_shared<SaveLoadIoController>(ISR::Save));
+
+		if (binary == true)
+		{
+			machine->OnSave([&bytes](std::span<const uint8_t> state) { bytes += state.size(); });
+		}
+		else
+		{
+			machine->OnSave([&bytes](const char* json) { bytes += strlen(json); });
+		}
+
+		for (auto _ : state)
+		{
+			// Each nop services interrupts once, the first issues the save request, the second completes it
+			machine->RunFor(8, 0x100, nullptr);
+		}
+
+		state.SetBytesProcessed(bytes);
+	}
+
+	/** OnLoad benchmark
+
+		Measures the latency of a machine load, from the io controller request until the state returned by
+		the OnLoad handler has been loaded, with a ram size of state.range(0) bytes. Bytes processed is the
+		size of the json (or binary) state.
+	*/
+	static void OnLoad(benchmark::State& state, bool binary)
+	{
+		auto memoryController = LoadProgram("nopStart.bin");
+		auto machine = MakeMachine(RamOptions(state.range(0)).c_str());
+		std::string json;
+		std::vector<uint8_t> bin;
+		size_t bytes = 0;
+
+		// Capture a machine state to load
+		machine->SetMemoryController(memoryController);
+		machine->SetIoController(std::make_shared<SaveLoadIoController>(ISR::Save));
+		machine->OnSave([&json](const char* state) { json = state; });
+		machine->RunFor(8, 0x100, nullptr);
+		machine->OnSave([&bin](std::span<const uint8_t> state) { bin.assign(state.begin(), state.end()); });
+		machine->RunFor(8, 0x100, nullptr);
+
+		machine = MakeMachine(RamOptions(state.range(0)).c_str());
+		machine->SetMemoryController(memoryController);
+		machine->SetIoController(std::make_shared<SaveLoadIoController>(ISR::Load));
+
+		if (binary == true)
+		{
+			machine->OnLoad([&bin, &bytes]
+			{
+				bytes += bin.size();
+				return std::span<const uint8_t>(bin);
+			});
+		}
+		else
+		{
+			machine->OnLoad([&json, &bytes]
+			{
+				bytes += json.size();
+				return json.c_str();
+			});
+		}
+
+		for (auto _ : state)
+		{
+			// Each nop services interrupts once, the first issues the load request, the second completes it
+			machine->RunFor(8, 0x100, nullptr);
+		}
+
+		state.SetBytesProcessed(bytes);
+	}
+
+	// Expand a mnemonic prefix with each of the given operand suffixes, ie: add + {b, c} = {addb, addc}
+	static std::vector<std::string> Expand(const std::vector<std::string>& prefixes, const std::vector<std::string>& suffixes)
+	{
+		std::vector<std::string> programs;
+
+		for (const auto& prefix : prefixes)
+		{
+			for (const auto& suffix : suffixes)
+			{
+				programs.push_back(prefix + suffix);
+			}
+		}
+
+		return programs;
+	}
+
+	static void RegisterBenchmarks()
+	{
+		const std::vector<std::string> registers = { "a", "b", "c", "d", "e", "h", "l", "m" };
+		const std::vector<std::string> registerPairs = { "b", "d", "h", "sp" };
+
+		// The cpu test suites
+		for (const auto& program : { "TST8080.COM", "8080PRE.COM", "CPUTEST.COM", "8080EXM.COM" })
+		{
+			auto benchmark = benchmark::RegisterBenchmark((std::string("Program/") + program).c_str(), CpmProgram, std::string(program), std::string());
+			benchmark->Unit(benchmark::kMillisecond);
+
+			// The longer running suites are only run once
+			if (strcmp(program, "CPUTEST.COM") == 0 || strcmp(program, "8080EXM.COM") == 0)
+			{
+				benchmark->Iterations(1);
+			}
+		}
+
+		// The instruction dispatchers, each long running suite is run once by each of them. Only CPUTEST.COM
+		// is recompiled ahead of time for the tests, aot runs 8080EXM.COM as cached does.
+		for (const std::string dispatcher : { "switch", "threaded", "cached", "jit", "aot" })
+		{
+			auto options = nlohmann::json({ { "dispatcher", dispatcher } }).dump();
+
+			for (const auto& program : { "CPUTEST.COM", "8080EXM.COM" })
+			{
+				benchmark::RegisterBenchmark(("Dispatcher/" + dispatcher + "/" + program).c_str(), CpmProgram, std::string(program), options)->Unit(benchmark::kMillisecond)->Iterations(1);
+			}
+		}
+
+		// The instruction trace overhead of each traced dispatcher, compare with Dispatcher/<dispatcher>/CPUTEST.COM
+		for (const std::string dispatcher : { "switch", "cached" })
+		{
+			auto trace = nlohmann::json({ { "dispatcher", dispatcher }, { "trace", (std::filesystem::temp_directory_path() / "Benchmarks.trace").string() } }).dump();
+			benchmark::RegisterBenchmark(("Trace/" + dispatcher + "/CPUTEST.COM").c_str(), CpmProgram, std::string("CPUTEST.COM"), trace)->Unit(benchmark::kMillisecond)->Iterations(1);
+		}
+
+		// The single instruction programs grouped by opcode class, the rst programs are
+		// excluded as they require a restart routine (rst.bin) at each restart address
+		auto dataTransfer = Expand({ "mova", "movb", "movc", "movd", "move", "movh", "movl" }, registers);
+		auto movm = Expand({ "movm" }, { "a", "b", "c", "d", "e", "h", "l" });
+		dataTransfer.insert(dataTransfer.end(), movm.begin(), movm.end());
+		auto mvi = Expand({ "mvi" }, registers);
+		dataTransfer.insert(dataTransfer.end(), mvi.begin(), mvi.end());
+		auto lxi = Expand({ "lxi" }, registerPairs);
+		dataTransfer.insert(dataTransfer.end(), lxi.begin(), lxi.end());
+		dataTransfer.insert(dataTransfer.end(), { "lda", "sta", "lhld", "shld", "ldaxb", "ldaxd", "staxb", "staxd", "xchg" });
+
+		auto arithmetic = Expand({ "add", "adc", "sub", "sbb", "inr", "dcr" }, registers);
+		auto pairs = Expand({ "inx", "dcx", "dad" }, registerPairs);
+		arithmetic.insert(arithmetic.end(), pairs.begin(), pairs.end());
+		arithmetic.insert(arithmetic.end(), { "adi1", "adi2", "aci1", "aci2", "sui", "sbi", "daa" });
+
+		auto logical = Expand({ "ana", "xra", "ora", "cmp" }, registers);
+		logical.insert(logical.end(), { "ani", "xri", "ori", "cpi", "cpi0", "rlc", "rrc", "ral", "rar", "cma", "cmc", "stc" });
+
+		const std::vector<std::string> branch = { "jmp", "jc", "jnc", "jz", "jnz", "jp", "jm", "jpe", "jpo",
+			"call", "cc", "cnc", "cz", "cnz", "cp", "cm", "cpe", "cpo",
+			"ret", "rc", "rnc", "rz", "rnz", "rp", "rm", "rpe", "rpo",
+			"pchl" };
+
+		const std::vector<std::string> stackIo = { "pushpopb", "pushpopd", "pushpoph", "pushpoppsw", "xthl", "sphl", "in", "out" };
+
+		for (const auto& [name, programs] : std::vector<std::pair<std::string, std::vector<std::string>>>{
+			{ "DataTransfer", dataTransfer }, { "Arithmetic", arithmetic }, { "Logical", logical }, { "Branch", branch }, { "StackIo", stackIo } })
+		{
+			benchmark::RegisterBenchmark(("OpcodeClass/" + name).c_str(), OpcodeClass, programs)->Unit(benchmark::kMicrosecond);
+		}
+
+		// The cost of an io access, from the cpu to the owning controller and back to the machine
+		benchmark::RegisterBenchmark("IoAccess", IoAccess)->Unit(benchmark::kMicrosecond);
+
+		// Machine state save and load latency and throughput for various ram sizes
+		for (auto binary : { false, true })
+		{
+			benchmark::RegisterBenchmark(binary ? "OnSave/binary" : "OnSave/json", OnSave, binary)->Arg(256)->Arg(4096)->Arg(32767)->Unit(benchmark::kMicrosecond);
+			benchmark::RegisterBenchmark(binary ? "OnLoad/binary" : "OnLoad/json", OnLoad, binary)->Arg(256)->Arg(4096)->Arg(32767)->Unit(benchmark::kMicrosecond);
+		}
+	}
+} // namespace MachEmu::Benchmarks
+
+/*
+	Usage: Benchmarks [benchmark options] [programs directory]
+
+	The results are written to stdout as json unless a --benchmark_format is specified,
+	use --benchmark_filter to select a subset of the benchmarks, for example
+	--benchmark_filter=-8080EXM skips the long running exerciser.
+*/
+int main(int argc, char** argv)
+{
+	std::vector<char*> args(argv, argv + argc);
+	std::string format = "--benchmark_format=json";
+
+	if (std::none_of(args.begin(), args.end(), [](const char* arg) { return strncmp(arg, "--benchmark_format", 18) == 0; }))
+	{
+		args.insert(args.begin() + 1, format.data());
+	}
+
+	auto count = static_cast<int>(args.size());
+	benchmark::Initialize(&count, args.data());
+
+	// The remaining argument (if any) is the programs directory
+	if (count > 1)
+	{
+		MachEmu::Benchmarks::programsDir = args[1];
+	}
+
+	MachEmu::Benchmarks::RegisterBenchmarks();
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,309 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Machine/IMachine.h"
+#include "Machine/MachineFactory.h"
+#include "TestControllers/MemoryController.h"
+#include "TestControllers/ScriptedIoController.h"
+
+/** Persistent mode fuzzing harness
+
+	Runs a guest program against a mutated input stream (read from io port 0) on a single machine which is
+	rewound to a snapshot taken before the first instruction between each input, the guest branch coverage
+	(see IMachine::GetCoverage) is the feedback. A guest write to io port 0xFE is reported as a crash.
+
+	When built with clang the harness is linked with libFuzzer (-fsanitize=fuzzer) which supplies main, otherwise
+	the main below drives a minimal coverage guided mutation loop. Both accept the following flags:
+
+	-image=path@offset		The guest program and its (hex) load and start address, a built-in guest which overflows
+							a buffer when fed a "MEMU" header followed by a length greater than 16 is run by default.
+	-dispatcher=name		The cpu dispatcher, "cached" by default.
+	-max_cycles=n			The cycle budget of each input, 1000000 by default.
+
+	The standalone driver also accepts -runs=n (1000000 by default) and a list of input files to run once each.
+*/
+namespace MachEmu::Fuzz
+{
+	// The guest run when no image is given, it reads a "MEMU" header, a length and then copies that many
+	// bytes into a 16 byte buffer at 0x0300 followed by a canary at 0x0310 which faults the guest when it is overwritten
+	static constexpr uint8_t builtInGuest[] =
+	{
+		0x31, 0x00, 0x02,	// 0x0100 LXI SP, 0x0200
+		0xDB, 0x00,			// 0x0103 IN 0
+		0xFE, 0x4D,			// 0x0105 CPI 'M'
+		0xC2, 0x40, 0x01,	// 0x0107 JNZ 0x0140
+		0xDB, 0x00,			// 0x010A IN 0
+		0xFE, 0x45,			// 0x010C CPI 'E'
+		0xC2, 0x40, 0x01,	// 0x010E JNZ 0x0140
+		0xDB, 0x00,			// 0x0111 IN 0
+		0xFE, 0x4D,			// 0x0113 CPI 'M'
+		0xC2, 0x40, 0x01,	// 0x0115 JNZ 0x0140
+		0xDB, 0x00,			// 0x0118 IN 0
+		0xFE, 0x55,			// 0x011A CPI 'U'
+		0xC2, 0x40, 0x01,	// 0x011C JNZ 0x0140
+		0xDB, 0x00,			// 0x011F IN 0
+		0x47,				// 0x0121 MOV B, A
+		0x21, 0x00, 0x03,	// 0x0122 LXI H, 0x0300
+		0x78,				// 0x0125 MOV A, B
+		0xB7,				// 0x0126 ORA A
+		0xCA, 0x33, 0x01,	// 0x0127 JZ 0x0133
+		0xDB, 0x00,			// 0x012A IN 0
+		0x77,				// 0x012C MOV M, A
+		0x23,				// 0x012D INX H
+		0x05,				// 0x012E DCR B
+		0xC3, 0x25, 0x01,	// 0x012F JMP 0x0125
+		0x00,				// 0x0132 NOP
+		0x3A, 0x10, 0x03,	// 0x0133 LDA 0x0310
+		0xFE, 0xA5,			// 0x0136 CPI 0xA5
+		0xCA, 0x40, 0x01,	// 0x0138 JZ 0x0140
+		0xD3, 0xFE,			// 0x013B OUT 0xFE
+		0x00, 0x00, 0x00,	// 0x013D NOP
+		0xD3, 0xFF			// 0x0140 OUT 0xFF
+	};
+
+	struct Harness
+	{
+		std::unique_ptr<IMachine> machine;
+		std::shared_ptr<MemoryController> memoryController = std::make_shared<MemoryController>();
+		std::shared_ptr<ScriptedIoController> ioController = std::make_shared<ScriptedIoController>();
+		int64_t maxCycles = 1000000;
+	};
+
+	static Harness harness;
+
+	// The value of a -name=value flag, nullptr when arg is not that flag
+	static const char* Flag(const char* arg, std::string_view name)
+	{
+		std::string_view flag(arg);
+
+		if (flag.starts_with('-') == false || flag.substr(1).starts_with(name) == false || flag.substr(1 + name.size()).starts_with('=') == false)
+		{
+			return nullptr;
+		}
+
+		return arg + name.size() + 2;
+	}
+
+	// Build the machine, load the guest and snapshot it before its first instruction
+	static void Initialise(int argc, char** argv)
+	{
+		std::string image;
+		std::string dispatcher = "cached";
+
+		for (int i = 1; i < argc; i++)
+		{
+			if (auto value = Flag(argv[i], "image"); value != nullptr)
+			{
+				image = value;
+			}
+			else if (auto value = Flag(argv[i], "dispatcher"); value != nullptr)
+			{
+				dispatcher = value;
+			}
+			else if (auto value = Flag(argv[i], "max_cycles"); value != nullptr)
+			{
+				harness.maxCycles = std::strtoll(value, nullptr, 10);
+			}
+		}
+
+		// Interrupts are serviced once per second of the virtual clock, the guest is powered off via the scheduler as soon as it requests it
+		auto options = R"({"cpu":"i8080","dispatcher":")" + dispatcher + R"(","clock":"virtual","clockResolution":1000000000,"isrFreq":1})";
+		harness.machine = MakeMachine(options.c_str());
+		harness.machine->SetMemoryController(harness.memoryController);
+		harness.machine->SetIoController(harness.ioController);
+		uint16_t pc = 0x0100;
+
+		if (image.empty() == false)
+		{
+			auto at = image.rfind('@');
+
+			if (at != std::string::npos)
+			{
+				pc = static_cast<uint16_t>(std::strtoul(image.c_str() + at + 1, nullptr, 16));
+				image.resize(at);
+			}
+
+			harness.memoryController->Load(image.c_str(), pc);
+		}
+		else
+		{
+			for (size_t i = 0; i < std::size(builtInGuest); i++)
+			{
+				harness.memoryController->Write(static_cast<uint16_t>(0x0100 + i), builtInGuest[i]);
+			}
+
+			// The canary following the buffer
+			harness.memoryController->Write(0x0310, 0xA5);
+		}
+
+		// Power on without executing any instructions
+		harness.machine->RunFor(0, pc);
+		harness.machine->Snapshot();
+	}
+
+	// Rewind the machine and run the guest against the input, returns true when the guest faulted
+	static bool Run(const uint8_t* data, size_t size)
+	{
+		harness.ioController->SetInput({ data, size });
+		harness.machine->Restore();
+		harness.machine->RunFor(harness.maxCycles);
+		return harness.ioController->Faulted();
+	}
+} // namespace MachEmu::Fuzz
+
+using namespace MachEmu::Fuzz;
+
+#ifdef LIBFUZZER
+// libFuzzer treats these counters as coverage, the harness itself isn't instrumented so the guest edges are the only feedback
+__attribute__((section("__libfuzzer_extra_counters"))) static uint8_t extraCounters[65536];
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv)
+{
+	Initialise(*argc, *argv);
+	return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	auto faulted = Run(data, size);
+	auto coverage = harness.machine->GetCoverage();
+	std::memcpy(extraCounters, coverage.data(), std::min(coverage.size(), sizeof(extraCounters)));
+
+	if (faulted == true)
+	{
+		std::abort();
+	}
+
+	return 0;
+}
+#else
+int main(int argc, char** argv)
+{
+	Initialise(argc, argv);
+	uint64_t runs = 1000000;
+	std::vector<std::vector<uint8_t>> inputs;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (auto value = Flag(argv[i], "runs"); value != nullptr)
+		{
+			runs = std::strtoull(value, nullptr, 10);
+		}
+		else if (argv[i][0] != '-')
+		{
+			std::ifstream fin(argv[i], std::ios::binary);
+			inputs.emplace_back(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+		}
+	}
+
+	// Reproduce the given inputs
+	if (inputs.empty() == false)
+	{
+		int faults = 0;
+
+		for (const auto& input : inputs)
+		{
+			faults += Run(input.data(), input.size());
+		}
+
+		printf("%zu inputs, %d faults\n", inputs.size(), faults);
+		return faults > 0;
+	}
+
+	// Keep the inputs which reach a counter bucket (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+) not seen before and mutate them at random
+	std::vector<std::vector<uint8_t>> corpus{ {} };
+	std::vector<uint8_t> seen(harness.machine->GetCoverage().size());
+	std::mt19937 rng{ std::random_device{}() };
+	uint64_t faults = 0;
+	size_t edges = 0;
+	auto bucket = [](uint8_t count) { return static_cast<uint8_t>(1 << (count < 4 ? count - 1 : std::bit_width(count) - (count >= 64))); };
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t run = 0; run < runs; run++)
+	{
+		auto input = corpus[rng() % corpus.size()];
+
+		for (auto mutations = 1 + rng() % 4; mutations > 0; mutations--)
+		{
+			auto pos = input.empty() == true ? 0 : rng() % input.size();
+
+			switch (input.empty() == true ? 2 : rng() % 5)
+			{
+				case 0: input[pos] ^= 1 << (rng() % 8); break;
+				case 1: input[pos] = static_cast<uint8_t>(rng()); break;
+				case 2: input.insert(input.begin() + pos, static_cast<uint8_t>(rng())); break;
+				case 3: input.insert(input.begin() + pos, 1 + rng() % 16, static_cast<uint8_t>(rng())); break;
+				default: input.erase(input.begin() + pos); break;
+			}
+		}
+
+		if (Run(input.data(), input.size()) == true)
+		{
+			faults++;
+		}
+
+		auto coverage = harness.machine->GetCoverage();
+		bool interesting = false;
+
+		// The coverage is sparse, skip 8 zero counters at a time
+		for (size_t word = 0; word < coverage.size(); word += 8)
+		{
+			uint64_t counters;
+			std::memcpy(&counters, coverage.data() + word, sizeof(counters));
+
+			for (auto i = word; counters != 0 && i < word + 8; i++)
+			{
+				if (coverage[i] != 0 && (seen[i] & bucket(coverage[i])) == 0)
+				{
+					edges += seen[i] == 0;
+					seen[i] |= bucket(coverage[i]);
+					interesting = true;
+				}
+			}
+		}
+
+		if (interesting == true)
+		{
+			corpus.push_back(std::move(input));
+		}
+	}
+
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%llu runs in %.2fs (%.0f exec/s), %zu edges, %zu corpus inputs, %llu faults\n", static_cast<unsigned long long>(runs), seconds,
+		runs / seconds, edges, corpus.size(), static_cast<unsigned long long>(faults));
+	return 0;
+}
+#endif
@@ -20,14 +20,20 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <random>
 
 #include "Controller/IController.h"
+#include "Cpu/TraceBuffer.h"
 #include "Machine/IMachine.h"
 #include "Machine/MachineFactory.h"
 #include "TestControllers/MemoryController.h"
+#include "TestControllers/ScriptedIoController.h"
 #include "TestControllers/TestIoController.h"
 #include "TestControllers/CpmIoController.h"
 
@@ -41,9 +47,27 @@ namespace MachEmu::Tests
 		static std::shared_ptr<IController> testIoController_;
 		static std::unique_ptr<IMachine> machine_;
 
+		//The offsets of the binary save state fields, see IMachine::OnSave. The i8080 cpu state is
+		//its unique identifier followed by the registers a, b, c, d, e, h, l, s, pc and sp.
+		static constexpr size_t flagsOffset = 6;
+		static constexpr size_t cpuStateSizeOffset = 40;
+		static constexpr size_t cpuStateOffset = 42;
+		static constexpr size_t cpuStateSize = 16 + 12;
+		static constexpr size_t registersOffset = cpuStateOffset + 16;
+		static constexpr size_t ramOffset = cpuStateOffset + cpuStateSize;
+		//A full save state, the ram compressor is followed by the uncompressed ram size.
+		static constexpr size_t ramSizeOffset = ramOffset + 1;
+		//A delta save state, the sequence number and dirty page bitmap precede the ram section.
+		static constexpr size_t deltaSequenceOffset = ramOffset;
+		static constexpr size_t deltaRamSizeOffset = ramOffset + 4 + 32 + 1;
+
 		static void LoadAndRun(const char* name, const char* expected);
 		static void Run(bool runAsync);
 		static void Load(bool runAsync);
+		//Read a little endian value of the given size from a binary save state.
+		static uint32_t ReadLe(const std::vector<uint8_t>& state, size_t offset, size_t size);
+		//Run exitTest.bin, which saves the machine and quits, returning the json save state.
+		static std::string SaveJson();
 	public:
 		static std::string programsDir_;
 
@@ -133,6 +157,24 @@ namespace MachEmu::Tests
 		);
 	}
 
+	TEST_F(MachineTest, SetDispatcherAfterConstruction)
+	{
+		EXPECT_ANY_THROW
+		(
+			//cppcheck-suppress unknownMacro
+			machine_->SetOptions(R"({"dispatcher":"threaded"})");
+		);
+	}
+
+	TEST_F(MachineTest, InvalidDispatcher)
+	{
+		EXPECT_ANY_THROW
+		(
+			//cppcheck-suppress unknownMacro
+			MakeMachine(R"({"dispatcher":"indirect"})");
+		);
+	}
+
 	TEST_F(MachineTest, NegativeISRFrequency)
 	{
 		EXPECT_ANY_THROW
@@ -168,6 +210,11 @@ namespace MachEmu::Tests
 			machine_->Run(0x100);
 		);
 
+		EXPECT_ANY_THROW
+		(
+			machine_->RunFor(1000, 0x100);
+		);
+
 		EXPECT_ANY_THROW
 		(
 			machine_->SetOptions(R"({"isrFreq":1})");
@@ -281,6 +328,104 @@ namespace MachEmu::Tests
 		Run(true);
 	}
 
+	TEST_F(MachineTest, RunVirtualClock)
+	{
+		// Realtime resolution, the virtual clock does not slow the machine down
+		auto err = machine_->SetOptions(R"({"clock":"virtual","clockResolution":0})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		memoryController_->Load((programsDir_ + "nopStart.bin").c_str(), 0x04);
+		memoryController_->Load((programsDir_ + "nopEnd.bin").c_str(), 0xC353);
+
+		auto start = std::chrono::steady_clock::now();
+
+		// The machine time is exactly 2000067 ticks (2000047 plus the exitTest.bin out instructions) at 2Mhz on every run
+		for (int i = 0; i < 2; i++)
+		{
+			EXPECT_EQ(1000033500, machine_->Run(0x04));
+		}
+
+		EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+		EXPECT_ANY_THROW(machine_->SetOptions(R"({"clock":"wall"})"));
+
+		// Doubling the cpu frequency halves the machine time
+		err = machine_->SetOptions(R"({"cpuFrequency":4000000})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		EXPECT_EQ(500016750, machine_->Run(0x04));
+		EXPECT_ANY_THROW(machine_->SetOptions(R"({"cpuFrequency":0})"));
+	}
+
+	TEST_F(MachineTest, LargeCpuFrequency)
+	{
+		memoryController_->Load((programsDir_ + "nopStart.bin").c_str(), 0x04);
+		memoryController_->Load((programsDir_ + "nopEnd.bin").c_str(), 0xC353);
+
+		// A clock period below one nanosecond, 1 millisecond is 2000000 ticks
+		auto err = machine_->SetOptions(R"({"clock":"virtual","clockResolution":1000000,"cpuFrequency":2000000000})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		// 2000067 ticks at 2Ghz
+		EXPECT_EQ(1000033, machine_->Run(0x04));
+
+		err = machine_->SetOptions(R"({"clock":"host","clockResolution":1000000,"cpuFrequency":2000000000})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		EXPECT_GE(machine_->Run(0x04), 1000033);
+
+		// 2000067 ticks paced in a single slice
+		auto telemetry = nlohmann::json::parse(machine_->GetClockTelemetry());
+		EXPECT_EQ(1, telemetry["slices"].get<uint64_t>());
+		EXPECT_ANY_THROW(machine_->SetOptions(R"({"cpuFrequency":10000000001})"));
+	}
+
+	TEST_F(MachineTest, ClockTelemetry)
+	{
+		// Pace the machine in 1 millisecond slices
+		auto err = machine_->SetOptions(R"({"clockResolution":1000000})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		memoryController_->Load((programsDir_ + "nopStart.bin").c_str(), 0x04);
+		memoryController_->Load((programsDir_ + "nopEnd.bin").c_str(), 0xC353);
+		machine_->Run(0x04);
+
+		auto telemetry = nlohmann::json::parse(machine_->GetClockTelemetry());
+		// 2000067 ticks in slices of 2000 ticks
+		EXPECT_EQ(1000, telemetry["slices"].get<uint64_t>());
+
+		uint64_t slices = 0;
+
+		for (const auto& count : telemetry["overshoot"])
+		{
+			slices += count.get<uint64_t>();
+		}
+
+		for (const auto& count : telemetry["undershoot"])
+		{
+			slices += count.get<uint64_t>();
+		}
+
+		EXPECT_EQ(1000, slices);
+		// The clock sleeps for most of each slice rather than spinning
+		EXPECT_LT(telemetry["cpuTime"].get<int64_t>(), 500000000);
+		EXPECT_ANY_THROW(machine_->SetOptions(R"({"clockSpin":-1})"));
+	}
+
+	uint32_t MachineTest::ReadLe(const std::vector<uint8_t>& state, size_t offset, size_t size)
+	{
+		uint32_t value = 0;
+
+		for (size_t i = 0; i < size; i++)
+		{
+			value |= static_cast<uint32_t>(state[offset + i]) << (i * 8);
+		}
+
+		return value;
+	}
+
+	std::string MachineTest::SaveJson()
+	{
+		std::string json;
+		machine_->OnSave([&json](const char* state) { json = state; });
+		machine_->Run(0x00);
+		return json;
+	}
+
 	void MachineTest::Load(bool runAsync)
 	{
 		EXPECT_NO_THROW
@@ -388,6 +533,1352 @@ namespace MachEmu::Tests
 		}
 	}
 
+	TEST_F(MachineTest, OnLoadBinary)
+	{
+		std::vector<std::vector<uint8_t>> saveStates;
+		auto cpmIoController = static_pointer_cast<CpmIoController>(cpmIoController_);
+		// Trigger a save when the 3000th cycle has executed.
+		cpmIoController->SaveStateOn(3000);
+		// Call the out instruction
+		memoryController_->Write(0x00FE, 0xD3);
+		// The data to write to the controller that will trigger the ISR::Load interrupt
+		memoryController_->Write(0x00FF, 0xFD);
+		memoryController_->Load((programsDir_ + "/TST8080.COM").c_str(), 0x100);
+		auto err = machine_->SetOptions(R"({"rom":{"file":[{"offset":0,"size":1727}]},"ram":{"block":[{"offset":1727,"size":256}]}})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		machine_->SetIoController(cpmIoController_);
+		machine_->OnSave([&](std::span<const uint8_t> state) { saveStates.emplace_back(state.begin(), state.end()); });
+		machine_->OnLoad([&] { return std::span<const uint8_t>(saveStates[0]); });
+		machine_->Run(0x0100);
+		EXPECT_EQ(74, cpmIoController->Message().find("CPU IS OPERATIONAL"));
+		cpmIoController->SaveStateOn(-1);
+
+		// run it again, but this time trigger the load interrupt, the tests resume mid program
+		machine_->Run(0x00FE);
+		EXPECT_EQ(3, cpmIoController->Message().find("CPU IS OPERATIONAL"));
+
+		const auto& state = saveStates[0];
+		ASSERT_GT(state.size(), ramSizeOffset + 4);
+		// magic and version
+		EXPECT_EQ(0, memcmp(state.data(), "MEMU\x01\x00", 6));
+		ASSERT_EQ(cpuStateSize, ReadLe(state, cpuStateSizeOffset, 2));
+		EXPECT_EQ((std::vector<uint8_t>{ 19, 19, 0, 19, 0, 19, 0, 86, 0x04, 0xD4, 0x07, 0xBD }), std::vector<uint8_t>(state.begin() + registersOffset, state.begin() + ramOffset));
+		EXPECT_EQ(256, ReadLe(state, ramSizeOffset, 4));
+
+		// the end of program states of both runs are identical
+		ASSERT_EQ(3, saveStates.size());
+		EXPECT_EQ(saveStates[1], saveStates[2]);
+	}
+
+	TEST_F(MachineTest, OnLoadBinaryDelta)
+	{
+		std::vector<std::vector<uint8_t>> saveStates;
+		std::vector<uint8_t> chain;
+		auto cpmIoController = static_pointer_cast<CpmIoController>(cpmIoController_);
+		// Trigger a (full) save when the 3000th cycle has executed, the end of program save will be a delta
+		cpmIoController->SaveStateOn(3000);
+		memoryController_->Write(0x00FE, 0xD3);
+		memoryController_->Write(0x00FF, 0xFD);
+		memoryController_->Load((programsDir_ + "/TST8080.COM").c_str(), 0x100);
+		// The second ram block is never written to by the program, the delta will not carry it
+		auto err = machine_->SetOptions(R"({"deltaSaves":1,"rom":{"file":[{"offset":0,"size":1727}]},"ram":{"block":[{"offset":1727,"size":256},{"offset":8192,"size":4096}]}})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		machine_->SetIoController(cpmIoController_);
+		machine_->OnSave([&](std::span<const uint8_t> state) { saveStates.emplace_back(state.begin(), state.end()); });
+		machine_->OnLoad([&] { return std::span<const uint8_t>(chain); });
+		machine_->Run(0x0100);
+		EXPECT_EQ(74, cpmIoController->Message().find("CPU IS OPERATIONAL"));
+		cpmIoController->SaveStateOn(-1);
+
+		ASSERT_EQ(2, saveStates.size());
+		// full save state followed by a delta with sequence number 1 which only carries the tst8080 ram
+		EXPECT_EQ(0, ReadLe(saveStates[0], flagsOffset, 2));
+		EXPECT_EQ(4352, ReadLe(saveStates[0], ramSizeOffset, 4));
+		EXPECT_EQ(1, ReadLe(saveStates[1], flagsOffset, 2));
+		EXPECT_EQ(1, ReadLe(saveStates[1], deltaSequenceOffset, 4));
+		EXPECT_EQ(256, ReadLe(saveStates[1], deltaRamSizeOffset, 4));
+
+		// the end of program state
+		auto expected = SaveJson();
+		ASSERT_FALSE(expected.empty());
+
+		// a delta on its own can't be loaded, the machine resumes at the program start and writes its preamble
+		chain = saveStates[1];
+		machine_->OnSave(nullptr);
+		machine_->Run(0x00FE);
+		EXPECT_EQ(74, cpmIoController->Message().find("CPU IS OPERATIONAL"));
+
+		// clobber the ram, the full save state plus the delta restore the end of program state
+		for (uint16_t addr = 1727; addr < 1727 + 256; addr++)
+		{
+			memoryController_->Write(addr, 0x00);
+		}
+
+		chain = saveStates[0];
+		chain.insert(chain.end(), saveStates[1].begin(), saveStates[1].end());
+		machine_->Run(0x00FE);
+		EXPECT_TRUE(cpmIoController->Message().empty());
+		EXPECT_EQ(expected, SaveJson());
+	}
+
+	TEST_F(MachineTest, RomMd5)
+	{
+		// Wraps the test memory controller, supplying a precomputed rom digest
+		struct RomMd5MemoryController final : public IController
+		{
+			std::shared_ptr<MemoryController> memory;
+			mutable int romMd5Calls{};
+
+			explicit RomMd5MemoryController(const std::shared_ptr<MemoryController>& mem) : memory(mem) {}
+			uint8_t Read(uint16_t address) final { return memory->Read(address); }
+			void Write(uint16_t address, uint8_t value) final { memory->Write(address, value); }
+			ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final { return memory->ServiceInterrupts(currTime, cycles); }
+			std::array<uint8_t, 16> Uuid() const final { return memory->Uuid(); }
+			uint8_t* Memory(std::array<PageAccess, 256>& pageAccess) final { return memory->Memory(pageAccess); }
+			std::array<uint8_t, 16> RomMd5() const final { romMd5Calls++; return { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }; }
+		};
+
+		std::vector<uint8_t> saveState;
+		auto romMd5MemoryController = std::make_shared<RomMd5MemoryController>(memoryController_);
+		auto err = machine_->SetOptions(R"({"rom":{"file":[{"offset":0,"size":16}]},"ram":{"block":[{"offset":256,"size":16}]}})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		machine_->SetMemoryController(romMd5MemoryController);
+		machine_->SetIoController(cpmIoController_);
+		machine_->OnSave([&](std::span<const uint8_t> state) { saveState.assign(state.begin(), state.end()); });
+
+		// exitTest.bin saves and quits, the digest is only requested once across both runs
+		machine_->Run(0x00);
+		machine_->Run(0x00);
+		EXPECT_EQ(1, romMd5MemoryController->romMd5Calls);
+		ASSERT_GT(saveState.size(), 40);
+		EXPECT_EQ((std::vector<uint8_t>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }), std::vector<uint8_t>(saveState.begin() + 24, saveState.begin() + 40));
+
+		// changing the rom option or the memory controller discards the cached digest
+		err = machine_->SetOptions(R"({"rom":{"file":[{"offset":0,"size":32}]}})");
+		EXPECT_EQ(ErrorCode::NoError, err);
+		machine_->Run(0x00);
+		EXPECT_EQ(2, romMd5MemoryController->romMd5Calls);
+		machine_->SetMemoryController(romMd5MemoryController);
+		machine_->Run(0x00);
+		EXPECT_EQ(3, romMd5MemoryController->romMd5Calls);
+		EXPECT_TRUE(static_pointer_cast<CpmIoController>(cpmIoController_)->Message().empty());
+	}
+
+	TEST_F(MachineTest, TrappedMemoryPages)
+	{
+		// Wraps the test memory controller, trapping the first page of the program and making the
+		// tst8080 stack page read only so these accesses are routed through Read and Write
+		struct TrapMemoryController final : public IController
+		{
+			std::shared_ptr<MemoryController> memory;
+			int reads{};
+			int writes{};
+
+			explicit TrapMemoryController(const std::shared_ptr<MemoryController>& mem) : memory(mem) {}
+			uint8_t Read(uint16_t address) final { reads++; return memory->Read(address); }
+			void Write(uint16_t address, uint8_t value) final { writes++; memory->Write(address, value); }
+			ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final { return memory->ServiceInterrupts(currTime, cycles); }
+
+			uint8_t* Memory(std::array<PageAccess, 256>& pageAccess) final
+			{
+				pageAccess[0x01] = PageAccess::Trap;
+				pageAccess[0x07] = PageAccess::ReadOnly;
+				return memory->Memory(pageAccess);
+			}
+		};
+
+		auto trapMemoryController = std::make_shared<TrapMemoryController>(memoryController_);
+		machine_->SetMemoryController(trapMemoryController);
+		machine_->SetIoController(cpmIoController_);
+		LoadAndRun("TST8080.COM", R"({"uuid":"O+hPH516S3ClRdnzSRL8rQ==","registers":{"a":170,"b":170,"c":9,"d":170,"e":170,"h":170,"l":170,"s":86},"pc":2,"sp":1981})");
+		EXPECT_EQ(74, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("CPU IS OPERATIONAL"));
+		EXPECT_GT(trapMemoryController->reads, 0);
+		EXPECT_GT(trapMemoryController->writes, 0);
+	}
+
+	TEST_F(MachineTest, RunFor)
+	{
+		machine_->SetIoController(cpmIoController_);
+		machine_->OnSave([](const char* actual)
+		{
+			auto actualJson = nlohmann::json::parse(actual);
+			auto expectedJson = nlohmann::json::parse(R"({"uuid":"O+hPH516S3ClRdnzSRL8rQ==","registers":{"a":170,"b":170,"c":9,"d":170,"e":170,"h":170,"l":170,"s":86},"pc":2,"sp":1981})");
+			EXPECT_STREQ(expectedJson.dump().c_str(), actualJson["cpu"].dump().c_str());
+		});
+
+		memoryController_->Load((programsDir_ + "TST8080.COM").c_str(), 0x100);
+
+		bool quit = false;
+		int64_t cycles = 0;
+
+		while (quit == false)
+		{
+			auto ticks = machine_->RunFor(1000, 0x100, &quit);
+
+			// The budget can only be short when the machine quits
+			if (quit == false)
+			{
+				EXPECT_GE(ticks, 1000);
+			}
+
+			cycles += ticks;
+		}
+
+		EXPECT_GT(cycles, 0);
+		EXPECT_EQ(74, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("CPU IS OPERATIONAL"));
+	}
+
+	TEST_F(MachineTest, RunForBatched)
+	{
+		// Service interrupts once every clock synchronisation, 1 millisecond (2000 cycles)
+		machine_->SetOptions(R"({"clockResolution":1000000,"isrFreq":1})");
+		machine_->SetIoController(cpmIoController_);
+		memoryController_->Load((programsDir_ + "8080PRE.COM").c_str(), 0x100);
+
+		bool quit = false;
+
+		while (quit == false)
+		{
+			machine_->RunFor(100000, 0x100, &quit);
+		}
+
+		EXPECT_EQ(0, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("8080 Preliminary tests complete"));
+	}
+
+	TEST_F(MachineTest, PerfCounters)
+	{
+#ifdef ENABLE_PERF_COUNTERS
+		machine_->SetIoController(cpmIoController_);
+		memoryController_->Load((programsDir_ + "TST8080.COM").c_str(), 0x100);
+
+		bool quit = false;
+		int64_t cycles = 0;
+
+		while (quit == false)
+		{
+			cycles += machine_->RunFor(1000, 0x100, &quit);
+		}
+
+		auto counters = nlohmann::json::parse(machine_->GetPerfCounters());
+		uint64_t instructions = 0;
+		int64_t opcodeCycles = 0;
+
+		for (int i = 0; i < 256; i++)
+		{
+			instructions += counters["cpu"]["instructions"][i].get<uint64_t>();
+			opcodeCycles += counters["cpu"]["cycles"][i].get<int64_t>();
+		}
+
+		EXPECT_EQ(cycles, opcodeCycles);
+		EXPECT_GE(counters["cpu"]["memoryReads"].get<uint64_t>(), instructions);
+		EXPECT_GT(counters["cpu"]["memoryWrites"].get<uint64_t>(), 0);
+		EXPECT_EQ(1, counters["interrupts"]["quit"].get<int>());
+		EXPECT_GT(counters["serviceInterrupts"]["calls"].get<uint64_t>(), 0);
+		EXPECT_EQ(74, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("CPU IS OPERATIONAL"));
+#else
+		EXPECT_ANY_THROW(machine_->GetPerfCounters());
+#endif
+	}
+
+	TEST_F(MachineTest, MachineFarm)
+	{
+		constexpr int nbMachines = 16;
+		std::vector<std::shared_ptr<CpmIoController>> ioControllers;
+		std::vector<std::future<int64_t>> futures;
+		auto farm = MakeMachineFarm(2, 1000);
+
+		for (int i = 0; i < nbMachines; i++)
+		{
+			std::shared_ptr<IMachine> machine = MakeMachine();
+			auto memoryController = std::make_shared<MemoryController>();
+			auto ioController = std::make_shared<CpmIoController>(static_pointer_cast<IController>(memoryController));
+			memoryController->Load((programsDir_ + "/exitTest.bin").c_str(), 0x00);
+			memoryController->Load((programsDir_ + "/bdosMsg.bin").c_str(), 0x05);
+			memoryController->Load((programsDir_ + "TST8080.COM").c_str(), 0x100);
+			machine->SetMemoryController(memoryController);
+			machine->SetIoController(ioController);
+			ioControllers.push_back(ioController);
+			futures.push_back(farm->Run(machine, 0x100));
+		}
+
+		farm->WaitForCompletion();
+		int64_t cycles = 0;
+
+		for (int i = 0; i < nbMachines; i++)
+		{
+			cycles += futures[i].get();
+			EXPECT_EQ(74, ioControllers[i]->Message().find("CPU IS OPERATIONAL"));
+		}
+
+		auto stats = nlohmann::json::parse(farm->Stats());
+		EXPECT_EQ(2, stats["threads"].get<int>());
+		EXPECT_EQ(nbMachines, stats["machines"].get<int>());
+		EXPECT_EQ(nbMachines, stats["completed"].get<int>());
+		EXPECT_EQ(cycles, stats["cycles"].get<int64_t>());
+		EXPECT_GE(stats["slices"].get<int64_t>(), nbMachines);
+	}
+
+	class DispatcherTest : public MachineTest, public testing::WithParamInterface<const char*>
+	{
+	};
+
+	TEST_P(DispatcherTest, TestSuites)
+	{
+		// With a cycle budget both out instructions of exitTest.bin execute before the io controller is serviced
+		// and the save request is lost, halt after the save request instead and quit once the save has completed
+		struct SaveOnHaltIoController final : public IController
+		{
+			std::shared_ptr<IController> io;
+			bool saved{};
+
+			explicit SaveOnHaltIoController(const std::shared_ptr<IController>& controller) : io(controller) {}
+			uint8_t Read(uint16_t port) final { return io->Read(port); }
+			void Write(uint16_t port, uint8_t value) final { io->Write(port, value); }
+			std::array<uint8_t, 16> Uuid() const final { return io->Uuid(); }
+
+			ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final
+			{
+				auto isr = io->ServiceInterrupts(currTime, cycles);
+
+				if (isr == ISR::NoInterrupt && saved == true)
+				{
+					saved = false;
+					return ISR::Quit;
+				}
+
+				saved = isr == ISR::Save;
+				return isr;
+			}
+		};
+
+		// The cpu must run for a cycle budget for blocks to be executed from the cache (and compiled)
+		auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", GetParam() }, { "clock", "virtual" }, { "clockResolution", 1000000 }, { "isrFreq", 1 } }).dump().c_str());
+		machine->SetMemoryController(memoryController_);
+		machine->SetIoController(std::make_shared<SaveOnHaltIoController>(cpmIoController_));
+		// exitTest.bin: out 0xFE, hlt
+		memoryController_->Write(0x02, 0x76);
+
+		// The registers at the end of the program
+		bool saved = false;
+		machine->OnSave([&saved](const char* actual)
+		{
+			saved = true;
+			auto actualJson = nlohmann::json::parse(actual);
+			auto expectedJson = nlohmann::json::parse(R"({"uuid":"O+hPH516S3ClRdnzSRL8rQ==","registers":{"a":0,"b":0,"c":9,"d":3,"e":50,"h":1,"l":0,"s":86},"pc":3,"sp":1280})");
+			EXPECT_STREQ(expectedJson.dump().c_str(), actualJson["cpu"].dump().c_str());
+		});
+
+		auto run = [&machine]
+		{
+			bool quit = false;
+			int64_t cycles = 0;
+
+			while (quit == false)
+			{
+				cycles += machine->RunFor(std::numeric_limits<int64_t>::max(), 0x100, &quit);
+			}
+
+			return cycles;
+		};
+
+		// Every dispatcher must take exactly the same number of cycles as the interpreter, including
+		// the instructions which the jit emits inline (mov b, b executes as a nop)
+		const std::vector<uint8_t> loop
+		{
+			0x0E, 0x00,			// 0x0100 MVI C, 0
+			0x40,				// 0x0102 MOV B, B
+			0xEB,				// 0x0103 XCHG
+			0x0D,				// 0x0104 DCR C
+			0xC2, 0x02, 0x01,	// 0x0105 JNZ 0x0102
+			0xD3, 0xFF,			// 0x0108 OUT 0xFF
+			0x76				// 0x010A HLT
+		};
+
+		for (size_t i = 0; i < loop.size(); i++)
+		{
+			memoryController_->Write(0x0100 + i, loop[i]);
+		}
+
+		EXPECT_EQ(6009, run());
+
+		memoryController_->Load((programsDir_ + "8080PRE.COM").c_str(), 0x100);
+		EXPECT_EQ(10017, run());
+		EXPECT_EQ(0, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("8080 Preliminary tests complete"));
+		EXPECT_TRUE(saved);
+
+		machine->OnSave([](const char*) {});
+		memoryController_->Load((programsDir_ + "TST8080.COM").c_str(), 0x100);
+		EXPECT_EQ(8001, run());
+		EXPECT_EQ(74, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("CPU IS OPERATIONAL"));
+
+		memoryController_->Load((programsDir_ + "CPUTEST.COM").c_str(), 0x100);
+		EXPECT_EQ(255667769, run());
+		EXPECT_EQ(168, static_pointer_cast<CpmIoController>(cpmIoController_)->Message().find("CPU TESTS OK"));
+#ifdef ENABLE_PERF_COUNTERS
+		// CPUTEST.COM is recompiled ahead of time for the tests, its blocks must run as native code
+		auto compiledBlocks = nlohmann::json::parse(machine->GetPerfCounters())["cpu"]["compiledBlocks"].get<uint64_t>();
+
+		if (std::string(GetParam()) == "aot")
+		{
+			EXPECT_GT(compiledBlocks, 0);
+		}
+		else if (std::string(GetParam()) != "jit")
+		{
+			EXPECT_EQ(0, compiledBlocks);
+		}
+#endif
+	}
+
+	INSTANTIATE_TEST_SUITE_P(MachineTest, DispatcherTest, testing::Values("switch", "threaded", "cached", "jit", "aot"), [](const auto& info) { return std::string(info.param); });
+
+	TEST_F(MachineTest, SelfModifyingCode)
+	{
+		// The subroutine at 0x0140 is run (and cached/compiled) before its first instruction is rewritten from inr c
+		// to inr d and it is run again. Then a store rewrites a nop ahead of it in the same block with inr e. Finally
+		// the subroutine at 0x0250 fills 0x01F0 to 0x020F, its stores reach its own page once it has been compiled.
+		const std::vector<std::pair<uint16_t, std::vector<uint8_t>>> program
+		{
+			{ 0x0100, { 0x31, 0x00, 0x03 } },	// LXI SP, 0x0300
+			{ 0x0103, { 0x06, 0x28 } },			// MVI B, 40
+			{ 0x0105, { 0xCD, 0x40, 0x01 } },	// CALL 0x0140
+			{ 0x0108, { 0x3E, 0x14 } },			// MVI A, 0x14 (INR D)
+			{ 0x010A, { 0x32, 0x40, 0x01 } },	// STA 0x0140
+			{ 0x010D, { 0x06, 0x28 } },			// MVI B, 40
+			{ 0x010F, { 0xCD, 0x40, 0x01 } },	// CALL 0x0140
+			{ 0x0112, { 0x3E, 0x1C } },			// MVI A, 0x1C (INR E)
+			{ 0x0114, { 0x32, 0x18, 0x01 } },	// STA 0x0118
+			{ 0x0117, { 0x00 } },				// NOP
+			{ 0x0118, { 0x00 } },				// NOP, becomes INR E
+			{ 0x0119, { 0x79 } },				// MOV A, C
+			{ 0x011A, { 0x32, 0x00, 0x03 } },	// STA 0x0300
+			{ 0x011D, { 0x7A } },				// MOV A, D
+			{ 0x011E, { 0x32, 0x01, 0x03 } },	// STA 0x0301
+			{ 0x0121, { 0x7B } },				// MOV A, E
+			{ 0x0122, { 0x32, 0x02, 0x03 } },	// STA 0x0302
+			{ 0x0125, { 0x21, 0xF0, 0x01 } },	// LXI H, 0x01F0
+			{ 0x0128, { 0x06, 0x20 } },			// MVI B, 32
+			{ 0x012A, { 0x3E, 0xAA } },			// MVI A, 0xAA
+			{ 0x012C, { 0xCD, 0x50, 0x02 } },	// CALL 0x0250
+			{ 0x012F, { 0xD3, 0xFF } },			// OUT 0xFF (quit)
+			{ 0x0131, { 0xC3, 0x31, 0x01 } },	// JMP 0x0131
+			{ 0x0140, { 0x0C } },				// INR C, becomes INR D
+			{ 0x0141, { 0x05 } },				// DCR B
+			{ 0x0142, { 0xC2, 0x40, 0x01 } },	// JNZ 0x0140
+			{ 0x0145, { 0xC9 } },				// RET
+			{ 0x0250, { 0x77 } },				// MOV M, A
+			{ 0x0251, { 0x23 } },				// INX H
+			{ 0x0252, { 0x05 } },				// DCR B
+			{ 0x0253, { 0xC2, 0x50, 0x02 } },	// JNZ 0x0250
+			{ 0x0256, { 0xC9 } }				// RET
+		};
+
+		for (auto dispatcher : { "cached", "jit", "aot" })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", 1000000 }, { "isrFreq", 1 } }).dump().c_str());
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(testIoController_);
+
+			for (uint16_t addr = 0x0100; addr < 0x0400; addr++)
+			{
+				memoryController_->Write(addr, 0x00);
+			}
+
+			for (const auto& [addr, bytes] : program)
+			{
+				for (size_t i = 0; i < bytes.size(); i++)
+				{
+					memoryController_->Write(addr + i, bytes[i]);
+				}
+			}
+
+			EXPECT_NO_THROW(machine->Run(0x100));
+			EXPECT_EQ(40, memoryController_->Read(0x0300)) << dispatcher;
+			EXPECT_EQ(40, memoryController_->Read(0x0301)) << dispatcher;
+			EXPECT_EQ(1, memoryController_->Read(0x0302)) << dispatcher;
+
+			for (uint16_t addr = 0x01F0; addr < 0x0210; addr++)
+			{
+				EXPECT_EQ(0xAA, memoryController_->Read(addr)) << dispatcher;
+			}
+
+			EXPECT_EQ(0x00, memoryController_->Read(0x0210)) << dispatcher;
+		}
+	}
+
+	// Fires ISR::One every second of machine time and declares it via NextInterrupt, quits on a write to port 0xFF
+	struct TimerIoController final : public IController
+	{
+		uint64_t lastTime{};
+		uint64_t serviceCalls{};
+		bool quit{};
+
+		uint8_t Read([[maybe_unused]] uint16_t port) final { return 0; }
+		void Write(uint16_t port, [[maybe_unused]] uint8_t value) final { quit = port == 0xFF; }
+
+		ISR ServiceInterrupts(uint64_t currTime, [[maybe_unused]] uint64_t cycles) final
+		{
+			serviceCalls++;
+
+			if (quit == true)
+			{
+				return ISR::Quit;
+			}
+
+			if (currTime >= lastTime + 1000000000)
+			{
+				lastTime = currTime;
+				return ISR::One;
+			}
+
+			return ISR::NoInterrupt;
+		}
+
+		uint64_t NextInterrupt(uint64_t currTime, [[maybe_unused]] uint64_t cycles) const final
+		{
+			return quit == true ? currTime : lastTime + 1000000000;
+		}
+	};
+
+	// Run a program which waits for three interrupts (rst 1 increments b), servicing interrupts
+	// every instruction and every millisecond. An idle cpu skips to each interrupt so only a
+	// handful of calls are made to ServiceInterrupts.
+	static void RunUntilThirdInterrupt(const std::shared_ptr<MemoryController>& memoryController, const std::vector<uint8_t>& program, const std::vector<const char*>& dispatchers)
+	{
+		for (auto dispatcher : dispatchers)
+		{
+			for (auto isrFreq : { 0, 1 })
+			{
+				auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", isrFreq == 0 ? -1 : 1000000 }, { "isrFreq", isrFreq } }).dump().c_str());
+				auto ioController = std::make_shared<TimerIoController>();
+				machine->SetMemoryController(memoryController);
+				machine->SetIoController(ioController);
+
+				// rst 1: EI, INR B, RET
+				for (auto [addr, value] : std::vector<std::pair<uint16_t, uint8_t>>{ { 0x0008, 0xFB }, { 0x0009, 0x04 }, { 0x000A, 0xC9 }, { 0x0200, 0x00 } })
+				{
+					memoryController->Write(addr, value);
+				}
+
+				for (size_t i = 0; i < program.size(); i++)
+				{
+					memoryController->Write(0x0100 + i, program[i]);
+				}
+
+				uint64_t time = 0;
+				EXPECT_NO_THROW(time = machine->Run(0x0100));
+				EXPECT_EQ(3, memoryController->Read(0x0200)) << dispatcher << " " << isrFreq;
+				EXPECT_LE(3000000000, time) << dispatcher << " " << isrFreq;
+				EXPECT_GT(100, ioController->serviceCalls) << dispatcher << " " << isrFreq;
+			}
+		}
+	}
+
+	TEST_F(MachineTest, HaltUntilInterrupt)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x03,	// LXI SP, 0x0300
+			0xFB,				// EI
+			0x76,				// HLT
+			0x78,				// MOV A, B
+			0xFE, 0x03,			// CPI 3
+			0xC2, 0x03, 0x01,	// JNZ 0x0103
+			0x32, 0x00, 0x02,	// STA 0x0200
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		RunUntilThirdInterrupt(memoryController_, program, { "switch", "cached" });
+	}
+
+	TEST_F(MachineTest, SpinUntilInterrupt)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x03,	// LXI SP, 0x0300
+			0xFB,				// EI
+			0x78,				// MOV A, B
+			0xFE, 0x03,			// CPI 3
+			0xC2, 0x04, 0x01,	// JNZ 0x0104
+			0x32, 0x00, 0x02,	// STA 0x0200
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		RunUntilThirdInterrupt(memoryController_, program, { "switch", "threaded", "cached", "jit", "aot" });
+	}
+
+	// Schedules three ISR::One interrupts (the last one via ServiceInterrupts) a second of machine time apart
+	// and raises ISR::Quit on a write to port 0xFF, ServiceInterrupts is never polled
+	struct ScheduledIoController final : public IController
+	{
+		IScheduler* scheduler{};
+		uint64_t serviceCalls{};
+		bool quit{};
+
+		uint8_t Read([[maybe_unused]] uint16_t port) final { return 0; }
+
+		void Write(uint16_t port, [[maybe_unused]] uint8_t value) final
+		{
+			if (port == 0xFF)
+			{
+				quit = true;
+				scheduler->Raise();
+			}
+		}
+
+		ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final
+		{
+			serviceCalls++;
+			return quit == true ? ISR::Quit : ISR::One;
+		}
+
+		bool Schedule(IScheduler* s) final
+		{
+			scheduler = s;
+			scheduler->ScheduleTime(3000000000, ISR::NoInterrupt);
+			scheduler->ScheduleTime(2000000000, ISR::One);
+			scheduler->ScheduleCycles(2000000, ISR::One);
+			return true;
+		}
+	};
+
+	TEST_F(MachineTest, ScheduledInterrupts)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x03,	// LXI SP, 0x0300
+			0xFB,				// EI
+			0x76,				// HLT
+			0x78,				// MOV A, B
+			0xFE, 0x03,			// CPI 3
+			0xC2, 0x03, 0x01,	// JNZ 0x0103
+			0x32, 0x00, 0x02,	// STA 0x0200
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		for (auto dispatcher : { "switch", "cached" })
+		{
+			for (auto isrFreq : { 0, 1 })
+			{
+				auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", isrFreq == 0 ? -1 : 1000000 }, { "isrFreq", isrFreq }, { "cpuFrequency", 2000000 } }).dump().c_str());
+				auto ioController = std::make_shared<ScheduledIoController>();
+				machine->SetMemoryController(memoryController_);
+				machine->SetIoController(ioController);
+
+				// rst 1: EI, INR B, RET
+				for (auto [addr, value] : std::vector<std::pair<uint16_t, uint8_t>>{ { 0x0008, 0xFB }, { 0x0009, 0x04 }, { 0x000A, 0xC9 }, { 0x0200, 0x00 } })
+				{
+					memoryController_->Write(addr, value);
+				}
+
+				for (size_t i = 0; i < program.size(); i++)
+				{
+					memoryController_->Write(0x0100 + i, program[i]);
+				}
+
+				uint64_t time = 0;
+				EXPECT_NO_THROW(time = machine->Run(0x0100));
+				EXPECT_EQ(3, memoryController_->Read(0x0200)) << dispatcher << " " << isrFreq;
+				EXPECT_LE(3000000000, time) << dispatcher << " " << isrFreq;
+				// One call for the third interrupt and one for the quit
+				EXPECT_EQ(2, ioController->serviceCalls) << dispatcher << " " << isrFreq;
+			}
+		}
+	}
+
+	// Records the port accesses, returns its interrupt from the first call to ServiceInterrupts and quits after a write to quitPort
+	struct PortDevice final : public IController
+	{
+		ISR isr{ ISR::NoInterrupt };
+		uint8_t value{};
+		uint16_t quitPort{ 0x100 };
+		uint64_t reads{};
+		std::vector<std::pair<uint16_t, uint8_t>> writes;
+
+		explicit PortDevice(ISR interrupt = ISR::NoInterrupt, uint8_t data = 0) : isr(interrupt), value(data) {}
+
+		uint8_t Read([[maybe_unused]] uint16_t port) final { reads++; return value; }
+		void Write(uint16_t port, uint8_t data) final { writes.emplace_back(port, data); }
+
+		ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final
+		{
+			if (writes.empty() == false && writes.back().first == quitPort)
+			{
+				return ISR::Quit;
+			}
+
+			return std::exchange(isr, ISR::NoInterrupt);
+		}
+	};
+
+	TEST_F(MachineTest, IoDevices)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x03,	// LXI SP, 0x0300
+			0x21, 0x00, 0x02,	// LXI H, 0x0200
+			0xFB,				// EI
+			0x7D,				// MOV A, L
+			0xFE, 0x02,			// CPI 2
+			0xC2, 0x07, 0x01,	// JNZ 0x0107
+			0xD3, 0x10,			// OUT 0x10
+			0xDB, 0x20,			// IN 0x20
+			0x32, 0x10, 0x02,	// STA 0x0210
+			0xD3, 0x05			// OUT 0x05
+		};
+
+		for (auto isrFreq : { 0, 1 })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "clock", "virtual" }, { "clockResolution", isrFreq == 0 ? -1 : 1000000 }, { "isrFreq", isrFreq } }).dump().c_str());
+			auto ioController = std::make_shared<PortDevice>();
+			// Both devices interrupt at once, rst 1 must be serviced before rst 2
+			auto deviceA = std::make_shared<PortDevice>(ISR::Two);
+			auto deviceB = std::make_shared<PortDevice>(ISR::One, 0x5A);
+			ioController->quitPort = 0x05;
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(ioController);
+
+			EXPECT_THROW(machine->AddIoController(nullptr, 0x10, 0x1F), std::invalid_argument);
+			EXPECT_THROW(machine->AddIoController(deviceA, 0x1F, 0x10), std::invalid_argument);
+			EXPECT_NO_THROW(machine->AddIoController(deviceA, 0x10, 0x1F));
+			EXPECT_THROW(machine->AddIoController(deviceB, 0x1F, 0x20), std::invalid_argument);
+			EXPECT_NO_THROW(machine->AddIoController(deviceA, 0x30, 0x30));
+			EXPECT_NO_THROW(machine->AddIoController(deviceB, 0x20, 0x20));
+
+			// rst 1: MVI M, 1; INX H; EI; RET, rst 2: MVI M, 2; INX H; EI; RET
+			const std::vector<uint8_t> rst{ 0x36, 0x01, 0x23, 0xFB, 0xC9, 0x00, 0x00, 0x00, 0x36, 0x02, 0x23, 0xFB, 0xC9 };
+
+			for (size_t i = 0; i < rst.size(); i++)
+			{
+				memoryController_->Write(0x0008 + i, rst[i]);
+			}
+
+			for (size_t i = 0; i < program.size(); i++)
+			{
+				memoryController_->Write(0x0100 + i, program[i]);
+			}
+
+			EXPECT_NO_THROW(machine->Run(0x0100));
+			EXPECT_EQ(1, memoryController_->Read(0x0200)) << isrFreq;
+			EXPECT_EQ(2, memoryController_->Read(0x0201)) << isrFreq;
+			EXPECT_EQ(0x5A, memoryController_->Read(0x0210)) << isrFreq;
+			EXPECT_EQ((std::vector<std::pair<uint16_t, uint8_t>>{ { 0x10, 0x02 } }), deviceA->writes) << isrFreq;
+			EXPECT_EQ(1, deviceB->reads) << isrFreq;
+			EXPECT_EQ((std::vector<std::pair<uint16_t, uint8_t>>{ { 0x05, 0x5A } }), ioController->writes) << isrFreq;
+			EXPECT_EQ(0, ioController->reads) << isrFreq;
+		}
+	}
+
+	// A memory controller which keeps track of its clones
+	struct CloneableMemory final : public IController
+	{
+		std::vector<uint8_t> memory = std::vector<uint8_t>(0x10000);
+		std::shared_ptr<std::vector<std::shared_ptr<CloneableMemory>>> clones = std::make_shared<std::vector<std::shared_ptr<CloneableMemory>>>();
+
+		uint8_t Read(uint16_t address) final { return memory[address]; }
+		void Write(uint16_t address, uint8_t value) final { memory[address] = value; }
+		ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final { return ISR::NoInterrupt; }
+		uint8_t* Memory([[maybe_unused]] std::array<PageAccess, 256>& pageAccess) final { return memory.data(); }
+
+		std::shared_ptr<IController> Clone() const final
+		{
+			clones->push_back(std::make_shared<CloneableMemory>(*this));
+			return clones->back();
+		}
+	};
+
+	TEST_F(MachineTest, Clone)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x06, 0x00,			// MVI B, 0
+			0x21, 0x00, 0x02,	// LXI H, 0x0200
+			0x70,				// MOV M, B
+			0x23,				// INX H
+			0x04,				// INR B
+			0x78,				// MOV A, B
+			0xFE, 0xC8,			// CPI 200
+			0xC2, 0x05, 0x01,	// JNZ 0x0105
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		for (auto dispatcher : { "switch", "cached" })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" } }).dump().c_str());
+			auto memory = std::make_shared<CloneableMemory>();
+			std::copy(program.begin(), program.end(), memory->memory.begin() + 0x0100);
+			machine->SetMemoryController(memory);
+			// The io controller must support cloning
+			machine->SetIoController(std::make_shared<PortDevice>());
+			EXPECT_THROW(machine->Clone(), std::runtime_error) << dispatcher;
+			machine->SetIoController(std::make_shared<TestIoController>());
+
+			bool quit = false;
+			EXPECT_LE(1000, machine->RunFor(1000, 0x0100, &quit)) << dispatcher;
+			EXPECT_FALSE(quit) << dispatcher;
+
+			std::unique_ptr<IMachine> clone;
+			EXPECT_NO_THROW(clone = machine->Clone()) << dispatcher;
+			// The failed clone cloned the memory controller before the io controller
+			ASSERT_EQ(2, memory->clones->size()) << dispatcher;
+			auto cloneMemory = memory->clones->back();
+			EXPECT_EQ(memory->memory, cloneMemory->memory) << dispatcher;
+
+			// The clone and this machine are independent
+			memory->memory[0x0300] = 0xEE;
+			EXPECT_EQ(0x00, cloneMemory->memory[0x0300]) << dispatcher;
+
+			auto ticks = machine->RunFor(1000000, 0x0100, &quit);
+			EXPECT_TRUE(quit) << dispatcher;
+			EXPECT_EQ(ticks, clone->RunFor(1000000, 0x0100, &quit)) << dispatcher;
+			EXPECT_TRUE(quit) << dispatcher;
+
+			for (int i = 0; i < 200; i++)
+			{
+				EXPECT_EQ(i, memory->memory[0x0200 + i]) << dispatcher;
+				EXPECT_EQ(i, cloneMemory->memory[0x0200 + i]) << dispatcher;
+			}
+		}
+	}
+
+	TEST_F(MachineTest, CloneScheduled)
+	{
+		// Returns an incrementing value from each read, a write to port 0x01 schedules a quit at cycle 3000
+		struct ScheduledIoController final : public IController
+		{
+			IScheduler* scheduler{};
+			uint8_t value{};
+
+			uint8_t Read([[maybe_unused]] uint16_t port) final { return value++; }
+
+			void Write(uint16_t port, [[maybe_unused]] uint8_t value) final
+			{
+				if ((port & 0xFF) == 0x01)
+				{
+					scheduler->ScheduleCycles(3000, ISR::Quit);
+				}
+			}
+
+			ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final { return ISR::NoInterrupt; }
+			std::shared_ptr<IController> Clone() const final { return std::make_shared<ScheduledIoController>(*this); }
+
+			bool Schedule(IScheduler* s) final
+			{
+				scheduler = s;
+				return true;
+			}
+		};
+
+		const std::vector<uint8_t> program
+		{
+			0xD3, 0x01,			// 0x0100 OUT 0x01
+			0xDB, 0x00,			// 0x0102 IN 0
+			0x32, 0x00, 0x03,	// 0x0104 STA 0x0300
+			0xC3, 0x02, 0x01	// 0x0107 JMP 0x0102
+		};
+
+		for (auto dispatcher : { "switch", "cached" })
+		{
+			auto options = nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" } }).dump();
+			auto machine = MakeMachine(options.c_str());
+			auto memory = std::make_shared<CloneableMemory>();
+			std::copy(program.begin(), program.end(), memory->memory.begin() + 0x0100);
+			machine->SetMemoryController(memory);
+			machine->SetIoController(std::make_shared<ScheduledIoController>());
+			std::vector<std::vector<uint8_t>> logs;
+			machine->OnRecord([&logs](std::span<const uint8_t> log) { logs.emplace_back(log.begin(), log.end()); });
+
+			bool quit = false;
+			machine->RunFor(1000, 0x0100, &quit);
+			EXPECT_FALSE(quit) << dispatcher;
+
+			// The clone quits at the interrupt scheduled before it was cloned
+			auto clone = machine->Clone();
+			auto cloneMemory = memory->clones->back();
+			auto ticks = machine->RunFor(1000000, 0x0100, &quit);
+			EXPECT_TRUE(quit) << dispatcher;
+			EXPECT_GT(10000, ticks) << dispatcher;
+			EXPECT_EQ(ticks, clone->RunFor(1000000, 0x0100, &quit)) << dispatcher;
+			EXPECT_TRUE(quit) << dispatcher;
+			EXPECT_EQ(memory->memory[0x0300], cloneMemory->memory[0x0300]) << dispatcher;
+
+			// The clone carried on recording, its recording replays the whole run
+			ASSERT_EQ(2, logs.size()) << dispatcher;
+			EXPECT_EQ(logs[0], logs[1]) << dispatcher;
+			auto replay = MakeMachine(options.c_str());
+			auto replayMemory = std::make_shared<CloneableMemory>();
+			std::copy(program.begin(), program.end(), replayMemory->memory.begin() + 0x0100);
+			replay->SetMemoryController(replayMemory);
+			replay->Replay(logs[1]);
+			EXPECT_NO_THROW(replay->Run(0x0100)) << dispatcher;
+			EXPECT_EQ(cloneMemory->memory[0x0300], replayMemory->memory[0x0300]) << dispatcher;
+		}
+	}
+
+	// Reads random values and fires ISR::One at random times (declared via NextInterrupt), quits on a write to port 0xFF
+	struct RandomIoController final : public IController
+	{
+		std::mt19937 rng{ std::random_device{}() };
+		uint64_t next{};
+		bool quit{};
+
+		uint8_t Read([[maybe_unused]] uint16_t port) final { return rng() & 0xFF; }
+		void Write(uint16_t port, [[maybe_unused]] uint8_t value) final { quit = port == 0xFF; }
+
+		ISR ServiceInterrupts(uint64_t currTime, [[maybe_unused]] uint64_t cycles) final
+		{
+			if (quit == true)
+			{
+				return ISR::Quit;
+			}
+
+			if (currTime >= next)
+			{
+				next = currTime + rng() % 1000000;
+				return ISR::One;
+			}
+
+			return ISR::NoInterrupt;
+		}
+
+		uint64_t NextInterrupt(uint64_t currTime, [[maybe_unused]] uint64_t cycles) const final
+		{
+			return quit == true ? currTime : next;
+		}
+	};
+
+	TEST_F(MachineTest, RecordReplay)
+	{
+		// Stores 256 random io reads at 0x0200 and the number of interrupts (rst 1) at 0x0310, waiting for an interrupt once
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x03,	// LXI SP, 0x0300
+			0x21, 0x00, 0x02,	// LXI H, 0x0200
+			0xFB,				// EI
+			0x76,				// HLT
+			0xDB, 0x01,			// IN 0x01
+			0x77,				// MOV M, A
+			0x23,				// INX H
+			0x7C,				// MOV A, H
+			0xFE, 0x03,			// CPI 3
+			0xC2, 0x08, 0x01,	// JNZ 0x0108
+			0x79,				// MOV A, C
+			0x32, 0x10, 0x03,	// STA 0x0310
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		auto loadProgram = [&](const std::vector<uint8_t>& code)
+		{
+			memoryController_->Clear();
+
+			// rst 1: INR C, EI, RET
+			for (auto [addr, value] : std::vector<std::pair<uint16_t, uint8_t>>{ { 0x0008, 0x0C }, { 0x0009, 0xFB }, { 0x000A, 0xC9 } })
+			{
+				memoryController_->Write(addr, value);
+			}
+
+			for (size_t i = 0; i < code.size(); i++)
+			{
+				memoryController_->Write(0x0100 + i, code[i]);
+			}
+		};
+
+		auto readMemory = [&]
+		{
+			std::vector<uint8_t> mem;
+
+			for (uint16_t addr = 0x0200; addr <= 0x0310; addr++)
+			{
+				mem.push_back(memoryController_->Read(addr));
+			}
+
+			return mem;
+		};
+
+		for (auto dispatcher : { "switch", "cached", "jit" })
+		{
+			std::vector<uint8_t> log;
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" } }).dump().c_str());
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(std::make_shared<RandomIoController>());
+			machine->OnRecord([&](std::span<const uint8_t> recording) { log.assign(recording.begin(), recording.end()); });
+			loadProgram(program);
+
+			uint64_t time = 0;
+			EXPECT_NO_THROW(time = machine->Run(0x0100)) << dispatcher;
+			auto recorded = readMemory();
+			EXPECT_LT(0, recorded.back()) << dispatcher;
+			ASSERT_FALSE(log.empty()) << dispatcher;
+
+			// Replay the recording without an io controller
+			auto replay = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" } }).dump().c_str());
+			replay->SetMemoryController(memoryController_);
+			EXPECT_THROW(replay->Replay(std::vector<uint8_t>{ 'M', 'E', 'M', 'U' }), std::invalid_argument) << dispatcher;
+			EXPECT_NO_THROW(replay->Replay(log)) << dispatcher;
+			loadProgram(program);
+			EXPECT_EQ(time, replay->Run(0x0100)) << dispatcher;
+			EXPECT_EQ(recorded, readMemory()) << dispatcher;
+
+			// A different program diverges from the recording
+			auto modified = program;
+			modified[9] = 0x02;
+			loadProgram(modified);
+			EXPECT_THROW(replay->Run(0x0100), std::runtime_error) << dispatcher;
+		}
+	}
+
+	TEST_F(MachineTest, SnapshotRestore)
+	{
+		// Copies the input up to the first 0 to 0x0300, patching the last byte copied into the MVI operand at 0x0115 (self modifying code)
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x02,	// LXI SP, 0x0200
+			0x21, 0x00, 0x03,	// LXI H, 0x0300
+			0xDB, 0x00,			// IN 0
+			0xB7,				// ORA A
+			0xCA, 0x14, 0x01,	// JZ 0x0114
+			0x77,				// MOV M, A
+			0x23,				// INX H
+			0x32, 0x15, 0x01,	// STA 0x0115
+			0xC3, 0x06, 0x01,	// JMP 0x0106
+			0x3E, 0x00,			// MVI A, 0
+			0x32, 0x10, 0x03,	// STA 0x0310
+			0xD3, 0xFF			// OUT 0xFF
+		};
+
+		for (auto dispatcher : { "switch", "cached", "jit" })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", 1000000 }, { "isrFreq", 1 } }).dump().c_str());
+			auto ioController = std::make_shared<ScriptedIoController>();
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(ioController);
+			memoryController_->Clear();
+
+			for (size_t i = 0; i < program.size(); i++)
+			{
+				memoryController_->Write(0x0100 + i, program[i]);
+			}
+
+			EXPECT_THROW(machine->Snapshot(), std::runtime_error) << dispatcher;
+			EXPECT_THROW(machine->Restore(), std::runtime_error) << dispatcher;
+			machine->RunFor(0, 0x0100);
+			machine->Snapshot();
+
+			auto run = [&](const std::vector<uint8_t>& input)
+			{
+				bool quit = false;
+				ioController->SetInput(input);
+				machine->Restore();
+				auto cycles = machine->RunFor(1000000, 0x0100, &quit);
+				EXPECT_TRUE(quit) << dispatcher;
+				return cycles;
+			};
+
+			auto cycles = run({ 0x01, 0x02, 0x03, 0x00 });
+			EXPECT_EQ(0x03, memoryController_->Read(0x0302)) << dispatcher;
+			EXPECT_EQ(0x03, memoryController_->Read(0x0310)) << dispatcher;
+
+#ifdef ENABLE_COVERAGE
+			// The jmp back to the in instruction was taken three times
+			EXPECT_EQ(3, machine->GetCoverage()[(0x0111 >> 1) ^ 0x0106]) << dispatcher;
+#else
+			EXPECT_ANY_THROW(machine->GetCoverage());
+#endif
+
+			// The written pages, including the patched code, are rewound
+			run({ 0x07, 0x00 });
+			EXPECT_EQ(0x07, memoryController_->Read(0x0300)) << dispatcher;
+			EXPECT_EQ(0x00, memoryController_->Read(0x0301)) << dispatcher;
+			EXPECT_EQ(0x07, memoryController_->Read(0x0310)) << dispatcher;
+			run({ 0x00 });
+			EXPECT_EQ(0x00, memoryController_->Read(0x0300)) << dispatcher;
+			EXPECT_EQ(0x00, memoryController_->Read(0x0310)) << dispatcher;
+			EXPECT_EQ(0x00, memoryController_->Read(0x0115)) << dispatcher;
+
+#ifdef ENABLE_COVERAGE
+			EXPECT_EQ(0, machine->GetCoverage()[(0x0111 >> 1) ^ 0x0106]) << dispatcher;
+#endif
+
+			EXPECT_EQ(cycles, run({ 0x01, 0x02, 0x03, 0x00 })) << dispatcher;
+			EXPECT_EQ(0x03, memoryController_->Read(0x0310)) << dispatcher;
+		}
+	}
+
+	TEST_F(MachineTest, SnapshotRestoreAfterSave)
+	{
+		// Requests a binary save on a write to port 0x01, powers off on a write to port 0xFF
+		struct SaveIoController final : public IController
+		{
+			IScheduler* scheduler{};
+
+			uint8_t Read([[maybe_unused]] uint16_t port) final { return 0x00; }
+
+			void Write(uint16_t port, [[maybe_unused]] uint8_t value) final
+			{
+				if ((port & 0xFF) == 0x01 || (port & 0xFF) == 0xFF)
+				{
+					scheduler->ScheduleCycles(0, (port & 0xFF) == 0x01 ? ISR::Save : ISR::Quit);
+				}
+			}
+
+			ISR ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles) final { return ISR::NoInterrupt; }
+			std::array<uint8_t, 16> Uuid() const final { return { 0x3C, 0x1F, 0x8A, 0x52, 0x6E, 0x94, 0x4B, 0x0D, 0xA7, 0x33, 0xC8, 0x15, 0x7E, 0x62, 0xD9, 0x04 }; }
+
+			bool Schedule(IScheduler* s) final
+			{
+				scheduler = s;
+				return true;
+			}
+		};
+
+		// Writes to a ram page and patches its own code before the save, then writes to another ram page
+		const std::vector<uint8_t> program
+		{
+			0x3E, 0x55,			// 0x0100 MVI A, 0x55
+			0x32, 0x00, 0x03,	// 0x0102 STA 0x0300
+			0x3E, 0x77,			// 0x0105 MVI A, 0x77
+			0x32, 0x01, 0x01,	// 0x0107 STA 0x0101
+			0xD3, 0x01,			// 0x010A OUT 0x01
+			0x32, 0x00, 0x04,	// 0x010C STA 0x0400
+			0xD3, 0xFF			// 0x010F OUT 0xFF
+		};
+
+		for (auto dispatcher : { "switch", "cached", "jit" })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" } }).dump().c_str());
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(std::make_shared<SaveIoController>());
+			int saves = 0;
+			machine->OnSave([&saves](std::span<const uint8_t>) { saves++; });
+			memoryController_->Clear();
+
+			for (size_t i = 0; i < program.size(); i++)
+			{
+				memoryController_->Write(0x0100 + i, program[i]);
+			}
+
+			machine->RunFor(0, 0x0100);
+			machine->Snapshot();
+
+			for (int run = 1; run <= 2; run++)
+			{
+				bool quit = false;
+				machine->RunFor(1000, 0x0100, &quit);
+				EXPECT_TRUE(quit) << dispatcher;
+				EXPECT_EQ(run, saves) << dispatcher;
+				EXPECT_EQ(0x55, memoryController_->Read(0x0300)) << dispatcher;
+				EXPECT_EQ(0x77, memoryController_->Read(0x0400)) << dispatcher;
+
+				// The pages written to before the save are rewound along with those written to after it
+				machine->Restore();
+				EXPECT_EQ(0x00, memoryController_->Read(0x0300)) << dispatcher;
+				EXPECT_EQ(0x00, memoryController_->Read(0x0400)) << dispatcher;
+				EXPECT_EQ(0x55, memoryController_->Read(0x0101)) << dispatcher;
+			}
+		}
+	}
+
+	TEST_F(MachineTest, Trace)
+	{
+		const std::vector<uint8_t> program
+		{
+			0x31, 0x00, 0x02,	// 0x0100 LXI SP, 0x0200
+			0x21, 0x00, 0x03,	// 0x0103 LXI H, 0x0300
+			0x3E, 0x42,			// 0x0106 MVI A, 0x42
+			0x77,				// 0x0108 MOV M, A
+			0x32, 0x10, 0x03,	// 0x0109 STA 0x0310
+			0x22, 0x20, 0x03,	// 0x010C SHLD 0x0320
+			0xE5,				// 0x010F PUSH H
+			0xCD, 0x16, 0x01,	// 0x0110 CALL 0x0116
+			0xD3, 0xFF,			// 0x0113 OUT 0xFF
+			0x00,				// 0x0115 NOP
+			0xC9				// 0x0116 RET
+		};
+
+		auto path = (std::filesystem::temp_directory_path() / "MachineTest.trace").string();
+
+		for (auto dispatcher : { "switch", "cached" })
+		{
+			std::filesystem::remove(path);
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", 1000000 }, { "isrFreq", 1 } }).dump().c_str());
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(std::make_shared<ScriptedIoController>());
+			memoryController_->Clear();
+
+			for (size_t i = 0; i < program.size(); i++)
+			{
+				memoryController_->Write(0x0100 + i, program[i]);
+			}
+
+			// Tracing is disabled by default
+			bool quit = false;
+			auto cycles = machine->RunFor(1000000, 0x0100, &quit);
+			EXPECT_TRUE(quit) << dispatcher;
+			EXPECT_FALSE(std::filesystem::exists(path)) << dispatcher;
+
+			machine->SetOptions(nlohmann::json({ { "trace", path } }).dump().c_str());
+			quit = false;
+			EXPECT_EQ(cycles, machine->RunFor(1000000, 0x0100, &quit)) << dispatcher;
+			EXPECT_TRUE(quit) << dispatcher;
+
+			std::ifstream fin(path, std::ios::binary);
+			ASSERT_TRUE(fin.is_open()) << dispatcher;
+			char magic[4]{};
+			uint16_t header[2]{};
+			fin.read(magic, sizeof(magic));
+			fin.read(reinterpret_cast<char*>(header), sizeof(header));
+			EXPECT_EQ(0, memcmp(magic, "MEMT", sizeof(magic))) << dispatcher;
+			EXPECT_EQ(1, header[0]) << dispatcher;
+			EXPECT_EQ(sizeof(TraceRecord), header[1]) << dispatcher;
+
+			std::vector<TraceRecord> records;
+			TraceRecord record{};
+
+			while (fin.read(reinterpret_cast<char*>(&record), sizeof(record)))
+			{
+				records.push_back(record);
+			}
+
+			ASSERT_EQ(10, records.size()) << dispatcher;
+
+			const std::array<uint16_t, 10> pcs{ 0x0100, 0x0103, 0x0106, 0x0108, 0x0109, 0x010C, 0x010F, 0x0110, 0x0116, 0x0113 };
+
+			for (size_t i = 0; i < pcs.size(); i++)
+			{
+				EXPECT_EQ(pcs[i], records[i].pc) << dispatcher;
+				EXPECT_EQ(memoryController_->Read(pcs[i]), records[i].opcode) << dispatcher;
+			}
+
+			// The cycles and registers are those before the instruction executed
+			EXPECT_EQ(0, records[0].cycles) << dispatcher;
+			EXPECT_EQ(10, records[1].cycles) << dispatcher;
+			EXPECT_EQ(0x0200, records[1].sp) << dispatcher;
+			EXPECT_EQ(0x03, records[2].h) << dispatcher;
+			EXPECT_EQ(0x42, records[3].a) << dispatcher;
+			EXPECT_EQ(0x10, records[4].operand[0]) << dispatcher;
+			EXPECT_EQ(0x03, records[4].operand[1]) << dispatcher;
+
+			auto expectWrites = [&](const TraceRecord& r, std::vector<std::pair<uint16_t, uint8_t>> writes)
+			{
+				ASSERT_EQ(writes.size(), r.writes) << dispatcher;
+
+				for (size_t i = 0; i < writes.size(); i++)
+				{
+					EXPECT_EQ(writes[i].first, r.addresses[i]) << dispatcher;
+					EXPECT_EQ(writes[i].second, r.values[i]) << dispatcher;
+				}
+			};
+
+			expectWrites(records[2], {});
+			expectWrites(records[3], { { 0x0300, 0x42 } });
+			expectWrites(records[4], { { 0x0310, 0x42 } });
+			expectWrites(records[5], { { 0x0320, 0x00 }, { 0x0321, 0x03 } });
+			expectWrites(records[6], { { 0x01FF, 0x03 }, { 0x01FE, 0x00 } });
+			expectWrites(records[7], { { 0x01FD, 0x01 }, { 0x01FC, 0x13 } });
+			expectWrites(records[9], {});
+
+			fin.close();
+			std::filesystem::remove(path);
+			machine->SetOptions(R"({"trace":""})");
+		}
+
+		// The trace file can't be opened
+		auto machine = MakeMachine(R"({"trace":"/nonexistent/MachineTest.trace"})");
+		machine->SetMemoryController(memoryController_);
+		machine->SetIoController(std::make_shared<ScriptedIoController>());
+		EXPECT_THROW(machine->RunFor(1000, 0x0100), std::runtime_error);
+
+		// Only the switch and cached dispatchers write a trace record for each instruction
+		for (auto dispatcher : { "threaded", "jit", "aot" })
+		{
+			EXPECT_THROW(MakeMachine(nlohmann::json({ { "dispatcher", dispatcher }, { "trace", path } }).dump().c_str()), std::invalid_argument) << dispatcher;
+			machine = MakeMachine(nlohmann::json({ { "dispatcher", dispatcher } }).dump().c_str());
+			EXPECT_THROW(machine->SetOptions(nlohmann::json({ { "trace", path } }).dump().c_str()), std::invalid_argument) << dispatcher;
+		}
+	}
+
+	TEST_F(MachineTest, Profile)
+	{
+		const std::vector<std::pair<uint16_t, std::vector<uint8_t>>> program
+		{
+			{ 0x0100, { 0x31, 0x00, 0x02 } },	// LXI SP, 0x0200
+			{ 0x0103, { 0xCD, 0x10, 0x01 } },	// CALL 0x0110
+			{ 0x0106, { 0xD3, 0xFF } },			// OUT 0xFF
+			{ 0x0110, { 0x06, 0x64 } },			// outer: MVI B, 100
+			{ 0x0112, { 0xCD, 0x20, 0x01 } },	// CALL 0x0120
+			{ 0x0115, { 0x05 } },				// DCR B
+			{ 0x0116, { 0xC2, 0x12, 0x01 } },	// JNZ 0x0112
+			{ 0x0119, { 0xC9 } },				// RET
+			{ 0x0120, { 0x0E, 0x32 } },			// inner: MVI C, 50
+			{ 0x0122, { 0x0D } },				// DCR C
+			{ 0x0123, { 0xC2, 0x22, 0x01 } },	// JNZ 0x0122
+			{ 0x0126, { 0xC9 } }				// RET
+		};
+
+		auto path = (std::filesystem::temp_directory_path() / "MachineTest.folded").string();
+		auto symbols = (std::filesystem::temp_directory_path() / "MachineTest.sym").string();
+		std::ofstream(symbols) << "; MachineTest symbols\n0100 start\n0x0110 outer:\ninner equ 0120h\n";
+
+		for (auto dispatcher : { "switch", "jit" })
+		{
+			auto machine = MakeMachine(nlohmann::json({ { "cpu", "i8080" }, { "dispatcher", dispatcher }, { "clock", "virtual" }, { "clockResolution", 1000000 }, { "isrFreq", 1 },
+				{ "profile", path }, { "profileInterval", 100 }, { "profileSymbols", symbols } }).dump().c_str());
+			machine->SetMemoryController(memoryController_);
+			machine->SetIoController(std::make_shared<ScriptedIoController>());
+			memoryController_->Clear();
+
+			for (const auto& [addr, code] : program)
+			{
+				for (size_t i = 0; i < code.size(); i++)
+				{
+					memoryController_->Write(addr + i, code[i]);
+				}
+			}
+
+			bool quit = false;
+			auto cycles = machine->RunFor(1000000, 0x0100, &quit);
+			EXPECT_TRUE(quit) << dispatcher;
+
+			std::ifstream stacks(path);
+			ASSERT_TRUE(stacks.is_open()) << dispatcher;
+			std::string line;
+			int64_t samples = 0;
+			int64_t innerSamples = 0;
+
+			while (std::getline(stacks, line))
+			{
+				auto count = std::stoll(line.substr(line.rfind(' ') + 1));
+				samples += count;
+
+				if (line.starts_with("start;outer;inner;inner+0x") == true)
+				{
+					innerSamples += count;
+				}
+			}
+
+			// One sample every 100 cycles, nearly all of them in the inner loop
+			EXPECT_EQ(cycles / 100, samples) << dispatcher;
+			EXPECT_GT(innerSamples, samples * 9 / 10) << dispatcher;
+
+			// The hottest pc is in the inner loop
+			std::ifstream pcs(path + ".pcs");
+			ASSERT_TRUE(std::getline(pcs, line)) << dispatcher;
+			EXPECT_NE(std::string::npos, line.find("inner+0x")) << dispatcher;
+		}
+
+		EXPECT_THROW(MakeMachine(R"({"profileInterval":0})"), std::invalid_argument);
+
+		// A malformed symbol file
+		std::ofstream(symbols) << "start\n";
+		auto machine = MakeMachine(nlohmann::json({ { "profile", path }, { "profileSymbols", symbols } }).dump().c_str());
+		machine->SetMemoryController(memoryController_);
+		machine->SetIoController(std::make_shared<ScriptedIoController>());
+		EXPECT_THROW(machine->RunFor(1000, 0x0100), std::invalid_argument);
+
+		std::filesystem::remove(path);
+		std::filesystem::remove(path + ".pcs");
+		std::filesystem::remove(symbols);
+	}
+
 	#include "8080Test.cpp"
 } // namespace MachEmu::Tests
 
@@ -109,6 +109,20 @@ namespace MachEmu
 				@remark				The only way a machine can exit is when an ISR::Quit interrupt is generated.
 			*/
 			ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) override;
+
+			/**	Base IO next interrupt deadline
+
+				@param	currTime	The time in nanoseconds of the machine clock.
+
+				@param	cycles		The total number of cycles that have elapsed.
+
+				@return				currTime when a power off, save or load signal is pending, 0 (unknown) when
+									a save is due on a cycle count which hasn't elapsed, otherwise
+									std::numeric_limits<uint64_t>::max() as no interrupt is scheduled.
+
+				@see				IController::NextInterrupt()
+			*/
+			uint64_t NextInterrupt(uint64_t currTime, uint64_t cycles) const override;
 		public:
 			/** Save state after N cycles
 
@@ -116,6 +116,19 @@ namespace MachEmu
 		*/
 		void Write(uint16_t address, uint8_t value) final;
 
+		/** Direct memory access
+
+			Exposes the memory of this controller to the cpu.
+
+			@param		pageAccess	The access rights for each 256 byte page of memory.
+
+			@return					A pointer to the start of the 64K memory.
+
+			@remark					All pages are left as PageAccess::ReadWrite as this
+									controller has no memory mapped devices.
+		*/
+		uint8_t* Memory(std::array<PageAccess, 256>& pageAccess) final;
+
 		/** Memory IO interrupt handler
 		 
 			Checks the memory controller to see if any interrupts are pending.
@@ -129,6 +142,12 @@ namespace MachEmu
 			@remark				This controller never generates any interrupts.
 		*/
 		ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final;
+
+		/** Clone the memory controller
+
+			@return				A memory controller with a copy of this controller's memory.
+		*/
+		std::shared_ptr<IController> Clone() const final;
 	};
 } // namespace MachEmu
 
@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SCRIPTEDIOCONTROLLER_H
+#define SCRIPTEDIOCONTROLLER_H
+
+#include <cstdint>
+#include <span>
+
+#include "Controller/IController.h"
+
+namespace MachEmu
+{
+	/** Scripted IO controller
+
+		An io controller which feeds a fixed input stream to the cpu, one byte
+		per read of port 0, used to drive guest programs from a fuzzing harness.
+		The machine powers off when the input is exhausted or when port 0xFF is
+		written to, writing to port 0xFE flags a guest fault before powering off.
+
+		@remark		The controller schedules its power off (see IController::Schedule)
+					so the machine quits at the io instruction which requested it.
+	*/
+	class ScriptedIoController final : public IController
+	{
+	private:
+		/** input_
+
+			The input stream, it is not copied and must outlive the run.
+		*/
+		std::span<const uint8_t> input_;
+
+		/** position_
+
+			The index of the next byte of input_ to be read.
+		*/
+		//cppcheck-suppress unusedStructMember
+		size_t position_{};
+
+		/** faulted_
+
+			Set when the guest writes to port 0xFE.
+		*/
+		//cppcheck-suppress unusedStructMember
+		bool faulted_{};
+
+		/** scheduler_
+
+			The machine interrupt scheduler used to power off.
+		*/
+		IScheduler* scheduler_{};
+
+		/** Power off
+
+			Schedule an ISR::Quit interrupt which is due immediately.
+		*/
+		void PowerOff();
+	public:
+		/** Set the input
+
+			Rewind the controller to the start of a new input stream.
+
+			@param	input	The bytes returned by the reads of port 0, in order.
+		*/
+		void SetInput(std::span<const uint8_t> input);
+
+		/** Guest fault
+
+			@return			True when the guest has written to port 0xFE since the last SetInput.
+		*/
+		bool Faulted() const;
+
+		/**	Read from a device
+
+			@param	port	Port 0 returns the next byte of input, the other ports return 0.
+
+			@return			The next byte of input or 0 when the input is exhausted,
+							in which case the machine is powered off.
+
+			@see			IController::Read()
+		*/
+		uint8_t Read(uint16_t port) final;
+
+		/** Write to a device
+
+			@param	port	0xFF powers off the machine, 0xFE flags a fault and powers off the machine,
+							writes to the other ports are discarded.
+
+			@param	value	Unused.
+
+			@see			IController::Write()
+		*/
+		void Write(uint16_t port, uint8_t value) final;
+
+		/** Interrupt handler
+
+			@return			ISR::NoInterrupt, the power off is scheduled.
+
+			@see			IController::ServiceInterrupts()
+		*/
+		ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final;
+
+		/** Interrupt scheduling
+
+			@param	scheduler	The machine interrupt scheduler.
+
+			@return				True, the controller schedules its power off.
+
+			@see				IController::Schedule()
+		*/
+		bool Schedule(IScheduler* scheduler) final;
+	};
+} // namespace MachEmu
+
+#endif // SCRIPTEDIOCONTROLLER_H
@@ -113,6 +113,27 @@ namespace MachEmu
 			@see IContoller::ServiceInterrupts()
 		*/
 		ISR ServiceInterrupts(uint64_t currTime, uint64_t cycles) final;
+
+		/** Next interrupt deadline
+
+			The time at which the next ISR::One interrupt will be triggered.
+
+			@param	currTime	The time in nanoseconds of the machine clock.
+
+			@param	cycles		The total number of cycles that have elapsed.
+
+			@return				One second after the last ISR::One interrupt, or the deadline
+								of the base io controller when it is earlier.
+
+			@see IContoller::NextInterrupt()
+		*/
+		uint64_t NextInterrupt(uint64_t currTime, uint64_t cycles) const final;
+
+		/** Clone the io controller
+
+			@return				An io controller with the same pending signals and device data.
+		*/
+		std::shared_ptr<IController> Clone() const final;
 	};
 } // namespace MachEmu
 
@@ -21,6 +21,8 @@ SOFTWARE.
 */
 
 
+#include <limits>
+
 #include "Base/Base.h"
 #include "TestControllers/BaseIoController.h"
 
@@ -60,4 +62,20 @@ namespace MachEmu
 		
 		return isr;
 	}
+
+	uint64_t BaseIoController::NextInterrupt(uint64_t currTime, uint64_t cycles) const
+	{
+		if (powerOff_ == true || save_ == true || load_ == true)
+		{
+			return currTime;
+		}
+
+		// The save cycle count must be seen by ServiceInterrupts, don't let the machine skip it
+		if (saveCycleCount_ >= 0 && cycles <= static_cast<uint64_t>(saveCycleCount_))
+		{
+			return 0;
+		}
+
+		return std::numeric_limits<uint64_t>::max();
+	}
 } // namespace MachEmu
\ No newline at end of file
@@ -81,6 +81,11 @@ namespace MachEmu
 		memory_[addr] = data;
 	}
 
+	uint8_t* MemoryController::Memory([[maybe_unused]] std::array<PageAccess, 256>& pageAccess)
+	{
+		return memory_.data();
+	}
+
 	void MemoryController::Clear()
 	{
 		memory_.assign(memory_.size(), 0);
@@ -91,4 +96,9 @@ namespace MachEmu
 		// this controller never issues any interrupts
 		return ISR::NoInterrupt;
 	}
+
+	std::shared_ptr<IController> MemoryController::Clone() const
+	{
+		return std::make_shared<MemoryController>(*this);
+	}
 } // namespace MachEmu
\ No newline at end of file
@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Base/Base.h"
+#include "TestControllers/ScriptedIoController.h"
+
+namespace MachEmu
+{
+	void ScriptedIoController::PowerOff()
+	{
+		if (scheduler_ != nullptr)
+		{
+			scheduler_->ScheduleCycles(0, ISR::Quit);
+		}
+	}
+
+	void ScriptedIoController::SetInput(std::span<const uint8_t> input)
+	{
+		input_ = input;
+		position_ = 0;
+		faulted_ = false;
+	}
+
+	bool ScriptedIoController::Faulted() const
+	{
+		return faulted_;
+	}
+
+	uint8_t ScriptedIoController::Read(uint16_t port)
+	{
+		if ((port & 0xFF) != 0x00)
+		{
+			return 0x00;
+		}
+
+		if (position_ == input_.size())
+		{
+			PowerOff();
+			return 0x00;
+		}
+
+		return input_[position_++];
+	}
+
+	void ScriptedIoController::Write(uint16_t port, [[maybe_unused]] uint8_t value)
+	{
+		switch (port & 0xFF)
+		{
+			case 0xFE:
+			{
+				faulted_ = true;
+				PowerOff();
+				break;
+			}
+			case 0xFF:
+			{
+				PowerOff();
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	ISR ScriptedIoController::ServiceInterrupts([[maybe_unused]] uint64_t currTime, [[maybe_unused]] uint64_t cycles)
+	{
+		return ISR::NoInterrupt;
+	}
+
+	bool ScriptedIoController::Schedule(IScheduler* scheduler)
+	{
+		scheduler_ = scheduler;
+		return true;
+	}
+} // namespace MachEmu
@@ -20,6 +20,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+
 #include "Base/Base.h"
 #include "TestControllers/TestIoController.h"
 
@@ -79,7 +81,7 @@ namespace MachEmu
 			//Fire interrupt rst 1 every second, the cpu will only acknowledge
 			//the interrupt if the test programs have interrupts enabled,
 			//otherwise it will be ignored.
-			auto t = currTime - lastTime_;
+			auto t = static_cast<int64_t>(currTime - lastTime_);
 
 			if (t >= 0)
 			{
@@ -99,4 +101,16 @@ namespace MachEmu
 
 		return isr;
 	}
+
+	uint64_t TestIoController::NextInterrupt(uint64_t currTime, uint64_t cycles) const
+	{
+		//A stale lastTime_ is reset by the next call to ServiceInterrupts
+		auto deadline = lastTime_ <= currTime ? lastTime_ + 1000000001 : currTime;
+		return std::min(deadline, BaseIoController::NextInterrupt(currTime, cycles));
+	}
+
+	std::shared_ptr<IController> TestIoController::Clone() const
+	{
+		return std::make_shared<TestIoController>(*this);
+	}
 } // namespace MachEmu
\ No newline at end of file
@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2021-2024 Nicolas Beddows <nicolas.beddows@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Cpu/8080Opcodes.h"
+#include "Cpu/TraceBuffer.h"
+
+namespace
+{
+	using MachEmu::TraceRecord;
+
+	// The operand, when the opcode has one, is appended to the mnemonic
+	constexpr std::array<const char*, 256> mnemonics
+	{
+		"NOP", "LXI B,", "STAX B", "INX B", "INR B", "DCR B", "MVI B,", "RLC",
+		"???", "DAD B", "LDAX B", "DCX B", "INR C", "DCR C", "MVI C,", "RRC",
+		"???", "LXI D,", "STAX D", "INX D", "INR D", "DCR D", "MVI D,", "RAL",
+		"???", "DAD D", "LDAX D", "DCX D", "INR E", "DCR E", "MVI E,", "RAR",
+		"???", "LXI H,", "SHLD ", "INX H", "INR H", "DCR H", "MVI H,", "DAA",
+		"???", "DAD H", "LHLD ", "DCX H", "INR L", "DCR L", "MVI L,", "CMA",
+		"???", "LXI SP,", "STA ", "INX SP", "INR M", "DCR M", "MVI M,", "STC",
+		"???", "DAD SP", "LDA ", "DCX SP", "INR A", "DCR A", "MVI A,", "CMC",
+		"MOV B,B", "MOV B,C", "MOV B,D", "MOV B,E", "MOV B,H", "MOV B,L", "MOV B,M", "MOV B,A",
+		"MOV C,B", "MOV C,C", "MOV C,D", "MOV C,E", "MOV C,H", "MOV C,L", "MOV C,M", "MOV C,A",
+		"MOV D,B", "MOV D,C", "MOV D,D", "MOV D,E", "MOV D,H", "MOV D,L", "MOV D,M", "MOV D,A",
+		"MOV E,B", "MOV E,C", "MOV E,D", "MOV E,E", "MOV E,H", "MOV E,L", "MOV E,M", "MOV E,A",
+		"MOV H,B", "MOV H,C", "MOV H,D", "MOV H,E", "MOV H,H", "MOV H,L", "MOV H,M", "MOV H,A",
+		"MOV L,B", "MOV L,C", "MOV L,D", "MOV L,E", "MOV L,H", "MOV L,L", "MOV L,M", "MOV L,A",
+		"MOV M,B", "MOV M,C", "MOV M,D", "MOV M,E", "MOV M,H", "MOV M,L", "HLT", "MOV M,A",
+		"MOV A,B", "MOV A,C", "MOV A,D", "MOV A,E", "MOV A,H", "MOV A,L", "MOV A,M", "MOV A,A",
+		"ADD B", "ADD C", "ADD D", "ADD E", "ADD H", "ADD L", "ADD M", "ADD A",
+		"ADC B", "ADC C", "ADC D", "ADC E", "ADC H", "ADC L", "ADC M", "ADC A",
+		"SUB B", "SUB C", "SUB D", "SUB E", "SUB H", "SUB L", "SUB M", "SUB A",
+		"SBB B", "SBB C", "SBB D", "SBB E", "SBB H", "SBB L", "SBB M", "SBB A",
+		"ANA B", "ANA C", "ANA D", "ANA E", "ANA H", "ANA L", "ANA M", "ANA A",
+		"XRA B", "XRA C", "XRA D", "XRA E", "XRA H", "XRA L", "XRA M", "XRA A",
+		"ORA B", "ORA C", "ORA D", "ORA E", "ORA H", "ORA L", "ORA M", "ORA A",
+		"CMP B", "CMP C", "CMP D", "CMP E", "CMP H", "CMP L", "CMP M", "CMP A",
+		"RNZ", "POP B", "JNZ ", "JMP ", "CNZ ", "PUSH B", "ADI ", "RST 0",
+		"RZ", "RET", "JZ ", "???", "CZ ", "CALL ", "ACI ", "RST 1",
+		"RNC", "POP D", "JNC ", "OUT ", "CNC ", "PUSH D", "SUI ", "RST 2",
+		"RC", "???", "JC ", "IN ", "CC ", "???", "SBI ", "RST 3",
+		"RPO", "POP H", "JPO ", "XTHL", "CPO ", "PUSH H", "ANI ", "RST 4",
+		"RPE", "PCHL", "JPE ", "XCHG", "CPE ", "???", "XRI ", "RST 5",
+		"RP", "POP PSW", "JP ", "DI", "CP ", "PUSH PSW", "ORI ", "RST 6",
+		"RM", "SPHL", "JM ", "EI", "CM ", "???", "CPI ", "RST 7"
+	};
+
+	std::string Disassemble(const TraceRecord& record)
+	{
+		char buf[32];
+
+		if ((record.flags & TraceRecord::interrupt) != 0)
+		{
+			snprintf(buf, sizeof(buf), "INT %s", mnemonics[record.opcode]);
+		}
+		else if ((record.flags & TraceRecord::unmapped) != 0 && MachEmu::Opcodes8080::length[record.opcode] > 1)
+		{
+			snprintf(buf, sizeof(buf), "%s?", mnemonics[record.opcode]);
+		}
+		else if (MachEmu::Opcodes8080::length[record.opcode] == 3)
+		{
+			snprintf(buf, sizeof(buf), "%s%04XH", mnemonics[record.opcode], (record.operand[1] << 8) | record.operand[0]);
+		}
+		else if (MachEmu::Opcodes8080::length[record.opcode] == 2)
+		{
+			snprintf(buf, sizeof(buf), "%s%02XH", mnemonics[record.opcode], record.operand[0]);
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), "%s", mnemonics[record.opcode]);
+		}
+
+		return buf;
+	}
+
+	void PrintText(const TraceRecord& r)
+	{
+		printf("%12" PRIu64 " %04X %02X %-14s A=%02X BC=%02X%02X DE=%02X%02X HL=%02X%02X SP=%04X F=%02X",
+			r.cycles, r.pc, r.opcode, Disassemble(r).c_str(), r.a, r.b, r.c, r.d, r.e, r.h, r.l, r.sp, r.status);
+
+		for (int i = 0; i < r.writes; i++)
+		{
+			printf(" [%04X]=%02X", r.addresses[i], r.values[i]);
+		}
+
+		printf("\n");
+	}
+
+	void PrintJson(const TraceRecord& r)
+	{
+		printf(R"({"cycles":%)" PRIu64 R"(,"pc":%u,"opcode":%u,"instruction":"%s","interrupt":%s,"a":%u,"b":%u,"c":%u,"d":%u,"e":%u,"h":%u,"l":%u,"sp":%u,"status":%u,"writes":[)",
+			r.cycles, r.pc, r.opcode, Disassemble(r).c_str(), (r.flags & TraceRecord::interrupt) != 0 ? "true" : "false",
+			r.a, r.b, r.c, r.d, r.e, r.h, r.l, r.sp, r.status);
+
+		for (int i = 0; i < r.writes; i++)
+		{
+			printf(R"(%s{"address":%u,"value":%u})", i > 0 ? "," : "", r.addresses[i], r.values[i]);
+		}
+
+		printf("]}\n");
+	}
+} // namespace
+
+// TraceDecoder <trace file> [--json]
+//
+// Print the instruction trace written by a machine run with the trace option, one instruction per line,
+// the registers are those before the instruction executed and the writes are the memory it changed.
+int main(int argc, char** argv)
+{
+	if (argc < 2 || (argc == 3 && strcmp(argv[2], "--json") != 0) || argc > 3)
+	{
+		fprintf(stderr, "usage: %s <trace file> [--json]\n", argv[0]);
+		return 1;
+	}
+
+	try
+	{
+		std::ifstream fin(argv[1], std::ios::binary);
+
+		if (fin.is_open() == false)
+		{
+			throw std::runtime_error(std::string("Failed to open ") + argv[1]);
+		}
+
+		char magic[4]{};
+		uint16_t header[2]{};
+		fin.read(magic, sizeof(magic));
+		fin.read(reinterpret_cast<char*>(header), sizeof(header));
+
+		if (fin.good() == false || memcmp(magic, "MEMT", sizeof(magic)) != 0)
+		{
+			throw std::runtime_error(std::string(argv[1]) + " is not a trace file");
+		}
+
+		if (header[0] != 1 || header[1] != sizeof(TraceRecord))
+		{
+			throw std::runtime_error(std::string("Unsupported trace file version ") + std::to_string(header[0]));
+		}
+
+		auto print = argc == 3 ? PrintJson : PrintText;
+		std::vector<TraceRecord> records(4096);
+
+		while (fin.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TraceRecord)) || fin.gcount() > 0)
+		{
+			auto count = fin.gcount() / sizeof(TraceRecord);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				print(records[i]);
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s: %s\n", argv[0], e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -68,6 +68,35 @@ namespace MachEmu::Utils
 	*/
 	std::vector<uint8_t> TxtToBin(const std::string& decoder, const std::string& decompressor, uint32_t dstSize, const std::string& txt);
 
+	/** Binary compression
+
+		@param	compressor				The name of the compression library to use, currently, the only supported compressor is "zlib".
+										Passing "none" as the compressor will copy the binary data WITHOUT compression.
+		@param	src						The binary data to compress.
+		@param	srcLen					The length in bytes of the binary data.
+		@param	dst						The vector the (compressed) binary data is appended to.
+
+		@throws	std::invalid_argument	Unsupported compressor parameter.
+
+		@throws	std::runtime_error		The binary data failed to compress.
+	*/
+	void Compress(const std::string& compressor, const uint8_t* src, uint32_t srcLen, std::vector<uint8_t>& dst);
+
+	/** Binary decompression
+
+		@param	decompressor			The name of the decompression library to use, currently, the only supported decompressor is "zlib".
+										Passing "none" as the decompressor will copy the binary data WITHOUT decompression.
+		@param	src						The compressed binary data.
+		@param	srcLen					The length in bytes of the compressed binary data.
+		@param	dst						The destination of the decompressed binary data.
+		@param	dstLen					The length in bytes of the uncompressed binary data, the data must decompress to exactly this size.
+
+		@throws	std::invalid_argument	Unsupported decompressor parameter.
+
+		@throws	std::runtime_error		The binary data failed to decompress.
+	*/
+	void Decompress(const std::string& decompressor, const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen);
+
 	/** MD5 hash
 	
 		Currently used for ROM hashing, but may have other uses moving forward.
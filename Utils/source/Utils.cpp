@@ -20,6 +20,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
 #include <bit>
 #include <libbase64.h>
 #include <md5.h>
@@ -50,27 +51,9 @@ namespace MachEmu::Utils
 
 		if (compressor != "none")
 		{
-#ifdef ENABLE_ZLIB
-			if (compressor == "zlib")
-			{
-				std::vector<uint8_t> dst(compressBound(binLen));
-				uLongf len = dst.size();
-
-				// do the compression - zlib
-				auto err = compress(dst.data(), &len, bin, binLen);
-
-				if (err != Z_OK)
-				{
-					throw std::runtime_error("Failed to compress binary data");
-				}
-
-				return encode(std::bit_cast<const char*>(dst.data()), len);
-			}
-			else
-#endif
-			{
-				throw std::invalid_argument("Invalid compressor parameter");
-			}
+			std::vector<uint8_t> dst;
+			Compress(compressor, bin, binLen, dst);
+			return encode(std::bit_cast<const char*>(dst.data()), dst.size());
 		}
 		else
 		{
@@ -93,34 +76,75 @@ namespace MachEmu::Utils
 
 		if (decompressor != "none")
 		{
-			std::vector<uint8_t> dst;
+			std::vector<uint8_t> dst(dstSize);
+			Decompress(decompressor, bin.data(), bin.size(), dst.data(), dstSize);
+			return dst;
+		}
+		else
+		{
+			return bin;
+		}
+	}
 
+	void Compress(const std::string& compressor, const uint8_t* src, uint32_t srcLen, std::vector<uint8_t>& dst)
+	{
+		auto offset = dst.size();
+
+		if (compressor == "none")
+		{
+			dst.insert(dst.end(), src, src + srcLen);
+			return;
+		}
 #ifdef ENABLE_ZLIB
-			if (decompressor == "zlib")
-			{
-				dst.resize(dstSize);
-				uLongf size = dstSize;
-				auto err = uncompress(dst.data(), &size, bin.data(), bin.size());
+		else if (compressor == "zlib")
+		{
+			uLongf len = compressBound(srcLen);
+			dst.resize(offset + len);
 
-				if (err != Z_OK)
-				{
-					throw std::runtime_error("Failed to decompress binary data");
-				}
+			// do the compression - zlib
+			auto err = compress(dst.data() + offset, &len, src, srcLen);
 
-				dst.resize(size);
+			if (err != Z_OK)
+			{
+				throw std::runtime_error("Failed to compress binary data");
 			}
-			else
+
+			dst.resize(offset + len);
+			return;
+		}
 #endif
+
+		throw std::invalid_argument("Invalid compressor parameter");
+	}
+
+	void Decompress(const std::string& decompressor, const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen)
+	{
+		if (decompressor == "none")
+		{
+			if (srcLen != dstLen)
 			{
-				throw std::invalid_argument("Invalid compressor parameter");
+				throw std::runtime_error("Failed to decompress binary data");
 			}
 
-			return dst;
+			std::copy_n(src, srcLen, dst);
+			return;
 		}
-		else
+#ifdef ENABLE_ZLIB
+		else if (decompressor == "zlib")
 		{
-			return bin;
+			uLongf size = dstLen;
+			auto err = uncompress(dst, &size, src, srcLen);
+
+			if (err != Z_OK || size != dstLen)
+			{
+				throw std::runtime_error("Failed to decompress binary data");
+			}
+
+			return;
 		}
+#endif
+
+		throw std::invalid_argument("Invalid compressor parameter");
 	}
 
 	std::array<uint8_t, 16> Md5(uint8_t* input, uint32_t len)
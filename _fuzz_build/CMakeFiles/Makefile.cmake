@@ -0,0 +1,117 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/miniconda/share/cmake/nlohmann_json/nlohmann_jsonConfig.cmake"
+  "/root/miniconda/share/cmake/nlohmann_json/nlohmann_jsonConfigVersion.cmake"
+  "/root/miniconda/share/cmake/nlohmann_json/nlohmann_jsonTargets.cmake"
+  "/root/repo/Base/CMakeLists.txt"
+  "/root/repo/CMakeLists.txt"
+  "/root/repo/Controller/CMakeLists.txt"
+  "/root/repo/Cpu/CMakeLists.txt"
+  "/root/repo/CpuClock/CMakeLists.txt"
+  "/root/repo/Machine/CMakeLists.txt"
+  "/root/repo/Opt/CMakeLists.txt"
+  "/root/repo/Recompiler/CMakeLists.txt"
+  "/root/repo/Sdk/CMakeLists.txt"
+  "/root/repo/SystemBus/CMakeLists.txt"
+  "/root/repo/Tests/CMakeLists.txt"
+  "/root/repo/Tests/Fuzz/CMakeLists.txt"
+  "/root/repo/Tests/MachineTest/CMakeLists.txt"
+  "/root/repo/Tests/TestControllers/CMakeLists.txt"
+  "/root/repo/TraceDecoder/CMakeLists.txt"
+  "/root/repo/Utils/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/tmp/shim/lib/cmake/base64/base64Config.cmake"
+  "/tmp/shim/lib/cmake/hash-library/hash-libraryConfig.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GMockTargets-none.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GMockTargets.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GTestConfig.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GTestConfigVersion.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GTestTargets-none.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/GTest/GTestTargets.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindDependencyMacro.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindGTest.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/FindZLIB.cmake"
+  "/usr/share/cmake-3.25/Modules/GoogleTest.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Base/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Controller/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Cpu/Cpu/recompiled/RecompiledBlocks.inc"
+  "Cpu/CpuTest/recompiled/RecompiledBlocks.inc"
+  "Cpu/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "CpuClock/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Machine/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Opt/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Recompiler/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Sdk/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "SystemBus/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Tests/MachineTest/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Tests/TestControllers/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Tests/Fuzz/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "TraceDecoder/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Utils/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "Base/CMakeFiles/Base.dir/DependInfo.cmake"
+  "Controller/CMakeFiles/Controller.dir/DependInfo.cmake"
+  "Cpu/CMakeFiles/Cpu.dir/DependInfo.cmake"
+  "Cpu/CMakeFiles/CpuTest.dir/DependInfo.cmake"
+  "CpuClock/CMakeFiles/CpuClock.dir/DependInfo.cmake"
+  "Machine/CMakeFiles/mach_emu.dir/DependInfo.cmake"
+  "Machine/CMakeFiles/mach_emuTest.dir/DependInfo.cmake"
+  "Opt/CMakeFiles/Opt.dir/DependInfo.cmake"
+  "Recompiler/CMakeFiles/Recompiler.dir/DependInfo.cmake"
+  "Sdk/CMakeFiles/Sdk.dir/DependInfo.cmake"
+  "SystemBus/CMakeFiles/SystemBus.dir/DependInfo.cmake"
+  "Tests/MachineTest/CMakeFiles/MachineTest.dir/DependInfo.cmake"
+  "Tests/TestControllers/CMakeFiles/TestControllers.dir/DependInfo.cmake"
+  "Tests/Fuzz/CMakeFiles/Fuzz.dir/DependInfo.cmake"
+  "TraceDecoder/CMakeFiles/TraceDecoder.dir/DependInfo.cmake"
+  "Utils/CMakeFiles/Utils.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Cpu/source/8080.cpp" "Cpu/CMakeFiles/Cpu.dir/source/8080.cpp.o" "gcc" "Cpu/CMakeFiles/Cpu.dir/source/8080.cpp.o.d"
+  "/root/repo/Cpu/source/CodeBuffer.cpp" "Cpu/CMakeFiles/Cpu.dir/source/CodeBuffer.cpp.o" "gcc" "Cpu/CMakeFiles/Cpu.dir/source/CodeBuffer.cpp.o.d"
+  "/root/repo/Cpu/source/CpuFactory.cpp" "Cpu/CMakeFiles/Cpu.dir/source/CpuFactory.cpp.o" "gcc" "Cpu/CMakeFiles/Cpu.dir/source/CpuFactory.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
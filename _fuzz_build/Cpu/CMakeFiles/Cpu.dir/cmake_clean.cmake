@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libCpu.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libCpu.pdb"
+  "CMakeFiles/Cpu.dir/source/8080.cpp.o"
+  "CMakeFiles/Cpu.dir/source/8080.cpp.o.d"
+  "CMakeFiles/Cpu.dir/source/CodeBuffer.cpp.o"
+  "CMakeFiles/Cpu.dir/source/CodeBuffer.cpp.o.d"
+  "CMakeFiles/Cpu.dir/source/CpuFactory.cpp.o"
+  "CMakeFiles/Cpu.dir/source/CpuFactory.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Cpu.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
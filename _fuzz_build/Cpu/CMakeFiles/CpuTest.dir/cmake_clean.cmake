@@ -0,0 +1,18 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libCpuTest.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libCpuTest.pdb"
+  "CMakeFiles/CpuTest.dir/source/8080.cpp.o"
+  "CMakeFiles/CpuTest.dir/source/8080.cpp.o.d"
+  "CMakeFiles/CpuTest.dir/source/CodeBuffer.cpp.o"
+  "CMakeFiles/CpuTest.dir/source/CodeBuffer.cpp.o.d"
+  "CMakeFiles/CpuTest.dir/source/CpuFactory.cpp.o"
+  "CMakeFiles/CpuTest.dir/source/CpuFactory.cpp.o.d"
+  "CpuTest/recompiled/8080PRE.inc"
+  "CpuTest/recompiled/CPUTEST.inc"
+  "CpuTest/recompiled/TST8080.inc"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CpuTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
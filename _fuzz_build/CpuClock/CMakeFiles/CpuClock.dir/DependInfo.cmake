@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/CpuClock/source/CpuClock.cpp" "CpuClock/CMakeFiles/CpuClock.dir/source/CpuClock.cpp.o" "gcc" "CpuClock/CMakeFiles/CpuClock.dir/source/CpuClock.cpp.o.d"
+  "/root/repo/CpuClock/source/CpuClockFactory.cpp" "CpuClock/CMakeFiles/CpuClock.dir/source/CpuClockFactory.cpp.o" "gcc" "CpuClock/CMakeFiles/CpuClock.dir/source/CpuClockFactory.cpp.o.d"
+  "/root/repo/CpuClock/source/VirtualCpuClock.cpp" "CpuClock/CMakeFiles/CpuClock.dir/source/VirtualCpuClock.cpp.o" "gcc" "CpuClock/CMakeFiles/CpuClock.dir/source/VirtualCpuClock.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libCpuClock.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libCpuClock.pdb"
+  "CMakeFiles/CpuClock.dir/source/CpuClock.cpp.o"
+  "CMakeFiles/CpuClock.dir/source/CpuClock.cpp.o.d"
+  "CMakeFiles/CpuClock.dir/source/CpuClockFactory.cpp.o"
+  "CMakeFiles/CpuClock.dir/source/CpuClockFactory.cpp.o.d"
+  "CMakeFiles/CpuClock.dir/source/VirtualCpuClock.cpp.o"
+  "CMakeFiles/CpuClock.dir/source/VirtualCpuClock.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CpuClock.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
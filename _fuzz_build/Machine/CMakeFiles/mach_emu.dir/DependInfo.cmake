@@ -0,0 +1,35 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Machine/source/Machine.cpp" "Machine/CMakeFiles/mach_emu.dir/source/Machine.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/Machine.cpp.o.d"
+  "/root/repo/Machine/source/MachineFactory.cpp" "Machine/CMakeFiles/mach_emu.dir/source/MachineFactory.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/MachineFactory.cpp.o.d"
+  "/root/repo/Machine/source/MachineFarm.cpp" "Machine/CMakeFiles/mach_emu.dir/source/MachineFarm.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/MachineFarm.cpp.o.d"
+  "/root/repo/Machine/source/Profiler.cpp" "Machine/CMakeFiles/mach_emu.dir/source/Profiler.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/Profiler.cpp.o.d"
+  "/root/repo/Machine/source/Recorder.cpp" "Machine/CMakeFiles/mach_emu.dir/source/Recorder.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/Recorder.cpp.o.d"
+  "/root/repo/Machine/source/Scheduler.cpp" "Machine/CMakeFiles/mach_emu.dir/source/Scheduler.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/Scheduler.cpp.o.d"
+  "/root/repo/Machine/source/Tracer.cpp" "Machine/CMakeFiles/mach_emu.dir/source/Tracer.cpp.o" "gcc" "Machine/CMakeFiles/mach_emu.dir/source/Tracer.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/artifacts/Release/fuzz/bin/libmach_emu.so" "/root/repo/artifacts/Release/fuzz/bin/libmach_emu.so.1.6.2"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_fuzz_build/Cpu/CMakeFiles/Cpu.dir/DependInfo.cmake"
+  "/root/repo/_fuzz_build/CpuClock/CMakeFiles/CpuClock.dir/DependInfo.cmake"
+  "/root/repo/_fuzz_build/Opt/CMakeFiles/Opt.dir/DependInfo.cmake"
+  "/root/repo/_fuzz_build/Utils/CMakeFiles/Utils.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
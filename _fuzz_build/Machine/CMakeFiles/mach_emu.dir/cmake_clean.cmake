@@ -0,0 +1,24 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/bin/libmach_emu.pdb"
+  "/root/repo/artifacts/Release/fuzz/bin/libmach_emu.so"
+  "/root/repo/artifacts/Release/fuzz/bin/libmach_emu.so.1.6.2"
+  "CMakeFiles/mach_emu.dir/source/Machine.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/Machine.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/MachineFactory.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/MachineFactory.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/MachineFarm.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/MachineFarm.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/Profiler.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/Profiler.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/Recorder.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/Recorder.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/Scheduler.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/Scheduler.cpp.o.d"
+  "CMakeFiles/mach_emu.dir/source/Tracer.cpp.o"
+  "CMakeFiles/mach_emu.dir/source/Tracer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mach_emu.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libOpt.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libOpt.pdb"
+  "CMakeFiles/Opt.dir/source/Opt.cpp.o"
+  "CMakeFiles/Opt.dir/source/Opt.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Opt.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
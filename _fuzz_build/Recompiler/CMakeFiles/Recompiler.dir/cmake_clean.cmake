@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/bin/Recompiler"
+  "/root/repo/artifacts/Release/fuzz/bin/Recompiler.pdb"
+  "CMakeFiles/Recompiler.dir/source/Recompiler.cpp.o"
+  "CMakeFiles/Recompiler.dir/source/Recompiler.cpp.o.d"
+  "CMakeFiles/Recompiler.dir/source/main.cpp.o"
+  "CMakeFiles/Recompiler.dir/source/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Recompiler.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
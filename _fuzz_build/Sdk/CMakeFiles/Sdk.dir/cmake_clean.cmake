@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Sdk"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/Sdk.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+#!/bin/bash
+export gtest_filter="--gtest_filter=*"
+
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        --gtest_filter)
+            export gtest_filter="$1=$2"
+            shift
+            ;;
+        
+        *)
+            echo Invalid option: $1
+            echo ./run-machine-tests [--gtest_filter \$gtest_filter][--python_filter \${python_filter}
+            exit
+            ;;
+    esac
+    shift
+done
+echo Adding `pwd`/bin and `pwd`/tests to LD_LIBRARY_PATH
+export LD_LIBRARY_PATH=`pwd`/bin:`pwd`/tests:${LD_LIBRARY_PATH}
+echo Running C++ unit tests
+tests/MachineTest "${gtest_filter}" tests/Programs/
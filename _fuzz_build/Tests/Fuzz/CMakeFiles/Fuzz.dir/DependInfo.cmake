@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Tests/Fuzz/source/Fuzz.cpp" "Tests/Fuzz/CMakeFiles/Fuzz.dir/source/Fuzz.cpp.o" "gcc" "Tests/Fuzz/CMakeFiles/Fuzz.dir/source/Fuzz.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_fuzz_build/Machine/CMakeFiles/mach_emu.dir/DependInfo.cmake"
+  "/root/repo/_fuzz_build/Tests/TestControllers/CMakeFiles/TestControllers.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
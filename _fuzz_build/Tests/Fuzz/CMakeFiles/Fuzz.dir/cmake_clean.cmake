@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/bin/Fuzz"
+  "/root/repo/artifacts/Release/fuzz/bin/Fuzz.pdb"
+  "CMakeFiles/Fuzz.dir/source/Fuzz.cpp.o"
+  "CMakeFiles/Fuzz.dir/source/Fuzz.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Fuzz.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Tests/MachineTest/source/MachineTest.cpp" "Tests/MachineTest/CMakeFiles/MachineTest.dir/source/MachineTest.cpp.o" "gcc" "Tests/MachineTest/CMakeFiles/MachineTest.dir/source/MachineTest.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_fuzz_build/Machine/CMakeFiles/mach_emuTest.dir/DependInfo.cmake"
+  "/root/repo/_fuzz_build/Tests/TestControllers/CMakeFiles/TestControllers.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/bin/MachineTest"
+  "/root/repo/artifacts/Release/fuzz/bin/MachineTest.pdb"
+  "CMakeFiles/MachineTest.dir/source/MachineTest.cpp.o"
+  "CMakeFiles/MachineTest.dir/source/MachineTest.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/MachineTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
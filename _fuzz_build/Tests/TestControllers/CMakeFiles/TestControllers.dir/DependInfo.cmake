@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Tests/TestControllers/source/BaseIoController.cpp" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/BaseIoController.cpp.o" "gcc" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/BaseIoController.cpp.o.d"
+  "/root/repo/Tests/TestControllers/source/CpmIoController.cpp" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/CpmIoController.cpp.o" "gcc" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/CpmIoController.cpp.o.d"
+  "/root/repo/Tests/TestControllers/source/MemoryController.cpp" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/MemoryController.cpp.o" "gcc" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/MemoryController.cpp.o.d"
+  "/root/repo/Tests/TestControllers/source/ScriptedIoController.cpp" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/ScriptedIoController.cpp.o" "gcc" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/ScriptedIoController.cpp.o.d"
+  "/root/repo/Tests/TestControllers/source/TestIoController.cpp" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/TestIoController.cpp.o" "gcc" "Tests/TestControllers/CMakeFiles/TestControllers.dir/source/TestIoController.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libTestControllers.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libTestControllers.pdb"
+  "CMakeFiles/TestControllers.dir/source/BaseIoController.cpp.o"
+  "CMakeFiles/TestControllers.dir/source/BaseIoController.cpp.o.d"
+  "CMakeFiles/TestControllers.dir/source/CpmIoController.cpp.o"
+  "CMakeFiles/TestControllers.dir/source/CpmIoController.cpp.o.d"
+  "CMakeFiles/TestControllers.dir/source/MemoryController.cpp.o"
+  "CMakeFiles/TestControllers.dir/source/MemoryController.cpp.o.d"
+  "CMakeFiles/TestControllers.dir/source/ScriptedIoController.cpp.o"
+  "CMakeFiles/TestControllers.dir/source/ScriptedIoController.cpp.o.d"
+  "CMakeFiles/TestControllers.dir/source/TestIoController.cpp.o"
+  "CMakeFiles/TestControllers.dir/source/TestIoController.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TestControllers.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
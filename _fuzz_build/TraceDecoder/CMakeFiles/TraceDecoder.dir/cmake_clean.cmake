@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/bin/TraceDecoder"
+  "/root/repo/artifacts/Release/fuzz/bin/TraceDecoder.pdb"
+  "CMakeFiles/TraceDecoder.dir/source/main.cpp.o"
+  "CMakeFiles/TraceDecoder.dir/source/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TraceDecoder.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/artifacts/Release/fuzz/lib/libUtils.a"
+  "/root/repo/artifacts/Release/fuzz/lib/libUtils.pdb"
+  "CMakeFiles/Utils.dir/source/Utils.cpp.o"
+  "CMakeFiles/Utils.dir/source/Utils.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Utils.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
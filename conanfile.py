@@ -18,8 +18,8 @@ class MachEmuRecipe(ConanFile):
 
     # Binary configuration
     settings = "os", "compiler", "build_type", "arch"
-    options = {"shared": [True, False], "fPIC": [True, False], "with_i8080_test_suites": [True, False], "with_python": [True, False], "with_zlib": [True, False]}
-    default_options = {"gtest*:build_gmock": False, "zlib*:shared": True, "shared": True, "fPIC": True, "with_i8080_test_suites": False, "with_python": False, "with_zlib": True}
+    options = {"shared": [True, False], "fPIC": [True, False], "with_benchmarks": [True, False], "with_fuzzer": [True, False], "with_i8080_test_suites": [True, False], "with_perf_counters": [True, False], "with_python": [True, False], "with_zlib": [True, False]}
+    default_options = {"gtest*:build_gmock": False, "zlib*:shared": True, "shared": True, "fPIC": True, "with_benchmarks": False, "with_fuzzer": False, "with_i8080_test_suites": False, "with_perf_counters": False, "with_python": False, "with_zlib": True}
 
     # Sources are located in the same place as this recipe, copy them to the recipe
     exports_sources = "CMakeLists.txt",\
@@ -48,7 +48,11 @@ class MachEmuRecipe(ConanFile):
         "Sdk/CMakeLists.txt",\
         "SystemBus/CMakeLists.txt",\
         "SystemBus/include/*",\
+        "Tests/Benchmarks/CMakeLists.txt",\
+        "Tests/Benchmarks/source/*",\
         "Tests/CMakeLists.txt",\
+        "Tests/Fuzz/CMakeLists.txt",\
+        "Tests/Fuzz/source/*",\
         "Tests/MachineTest/CMakeLists.txt",\
         "Tests/MachineTest/pythonTestDeps.cmake",\
         "Tests/MachineTest/source/*",\
@@ -58,6 +62,8 @@ class MachEmuRecipe(ConanFile):
         "Tests/TestControllersPy/CMakeLists.txt",\
         "Tests/TestControllersPy/source/*",\
         "Tests/TestControllers/source/*",\
+        "TraceDecoder/CMakeLists.txt",\
+        "TraceDecoder/source/*",\
         "Utils/CMakeLists.txt",\
         "Utils/include/*",\
         "Utils/source/*"
@@ -74,6 +80,8 @@ class MachEmuRecipe(ConanFile):
     def build_requirements(self):
         if not self.conf.get("tools.build:skip_test", default=False):
             self.test_requires("gtest/1.14.0")
+            if self.options.with_benchmarks:
+                self.test_requires("benchmark/1.8.4")
 
     def config_options(self):
         if self.settings.os == "Windows":
@@ -90,6 +98,9 @@ class MachEmuRecipe(ConanFile):
         deps = CMakeDeps(self)
         deps.generate()
         tc = CMakeToolchain(self)
+        tc.cache_variables["enableBenchmarks"] = self.options.with_benchmarks
+        tc.cache_variables["enableFuzzer"] = self.options.with_fuzzer
+        tc.cache_variables["enablePerfCounters"] = self.options.with_perf_counters
         tc.cache_variables["enablePythonModule"] = self.options.with_python
         tc.cache_variables["enableZlib"] = self.options.with_zlib
         tc.variables["buildArch"] = self.settings.arch